@@ -18,6 +18,7 @@
  */
 
 #include "gydp_app.h"
+#include "gydp_stats.h"
 #include <gtk/gtk.h>
 
 struct _GydpAppClass {
@@ -97,14 +98,22 @@ static void gydp_app_finalize(GObject *object) {
 GObject *gydp_app_new(int *argc, char ***argv) {
 	GydpApp *app;
 
+	/* initialize threads (dictionaries are loaded in background) */
+	if( !g_thread_supported() )
+		g_thread_init(NULL);
+
 	/* initialize glib */
 	g_type_init();
 
+	/* measure operations if requested by environment */
+	gydp_stats_init();
+
 	/* initialize application object */
 	app = g_object_new(GYDP_TYPE_APP, NULL);
 
-	/* initialize GUI */
-	gtk_init(argc, argv);
+	/* initialize GUI (not used without arguments) */
+	if( argc != NULL )
+		gtk_init(argc, argv);
 
 	return G_OBJECT(app);
 }
@@ -36,6 +36,8 @@ typedef struct _GydpAppClass GydpAppClass;
 #define GYDP_APP_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj),  GYDP_TYPE_APP, GydpAppClass))
 
 GType      gydp_app_get_type  () G_GNUC_CONST;
+
+/* GUI is initialized only if arguments are given */
 GObject   *gydp_app_new       (int *argc, char ***argv);
 
 /* get global singleton object */
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2008 Michał Kurgan <michal.kurgan@moloh.net>
+ *
+ * This file is part of gydpdict.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gydpdict.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gydp_arena.h"
+#include <string.h>
+
+struct _GydpArena {
+	GSList *chunks;  /* allocated chunks (current chunk first) */
+	gchar *pos;      /* free space in current chunk */
+	gsize left;      /* size of free space in current chunk */
+	gsize chunk;     /* size of single chunk */
+	gsize size;      /* total size of allocated chunks */
+};
+
+GydpArena *gydp_arena_new(gsize chunk) {
+	GydpArena *self = g_slice_new0(GydpArena);
+
+	/* use default chunk size if not specified */
+	self->chunk = chunk? chunk: GYDP_ARENA_CHUNK;
+
+	return self;
+}
+
+void gydp_arena_free(GydpArena *self) {
+	if( self != NULL ) {
+		/* free all chunks at once */
+		g_slist_foreach(self->chunks, (GFunc)g_free, NULL);
+		g_slist_free(self->chunks);
+
+		g_slice_free(GydpArena, self);
+	}
+}
+
+gchar *gydp_arena_alloc(GydpArena *self, gsize size) {
+	gchar *data;
+
+	/* large blocks get separate chunk, current chunk stays in use */
+	if( size > self->chunk / 4 && size > self->left ) {
+		data = g_malloc(size);
+		self->size += size;
+
+		if( self->chunks == NULL )
+			self->chunks = g_slist_prepend(self->chunks, data);
+		else
+			self->chunks->next = g_slist_prepend(self->chunks->next, data);
+
+		return data;
+	}
+
+	/* start new chunk if current one is exhausted */
+	if( size > self->left ) {
+		self->pos = g_malloc(self->chunk);
+		self->left = self->chunk;
+		self->size += self->chunk;
+		self->chunks = g_slist_prepend(self->chunks, self->pos);
+	}
+
+	/* allocate from current chunk, consecutive allocations are adjacent */
+	data = self->pos;
+	self->pos += size;
+	self->left -= size;
+
+	return data;
+}
+
+const gchar *gydp_arena_insert(GydpArena *self, const gchar *str, gssize len) {
+	/* calculate length if needed */
+	if( len < 0 )
+		len = strlen(str);
+
+	/* copy string with terminator */
+	gchar *data = gydp_arena_alloc(self, len + 1);
+	memcpy(data, str, len);
+	data[len] = '\0';
+
+	return data;
+}
+
+void gydp_arena_shrink(GydpArena *self, gchar *data, gsize size, gsize used) {
+	g_return_if_fail(used <= size);
+
+	/* only last allocation from current chunk can give back its tail */
+	if( data + size == self->pos ) {
+		self->pos -= size - used;
+		self->left += size - used;
+	}
+}
+
+gsize gydp_arena_size(GydpArena *self) {
+	return self->size;
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2008 Michał Kurgan <michal.kurgan@moloh.net>
+ *
+ * This file is part of gydpdict.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gydpdict.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GYDP_ARENA_H__
+#define __GYDP_ARENA_H__
+
+#include "gydp_global.h"
+
+G_BEGIN_DECLS
+
+/* default size of single arena chunk */
+#define GYDP_ARENA_CHUNK 65536
+
+typedef struct _GydpArena GydpArena;
+
+GydpArena   *gydp_arena_new   (gsize chunk);
+void         gydp_arena_free  (GydpArena *self);
+
+/* allocate memory (released only with whole arena) */
+gchar       *gydp_arena_alloc (GydpArena *self, gsize size);
+const gchar *gydp_arena_insert(GydpArena *self, const gchar *str, gssize len);
+
+/* return unused tail of last allocation to arena */
+void         gydp_arena_shrink(GydpArena *self, gchar *data, gsize size, gsize used);
+
+/* total memory held by arena */
+gsize        gydp_arena_size  (GydpArena *self);
+
+G_END_DECLS
+
+#endif /* __GYDP_ARENA_H__ */
@@ -0,0 +1,573 @@
+/*
+ * Copyright (C) 2008 Michał Kurgan <michal.kurgan@moloh.net>
+ *
+ * This file is part of gydpdict.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gydpdict.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "gydp_global.h"
+#include "gydp_dict.h"
+#include "gydp_dict_sap.h"
+#include "gydp_dict_ydp.h"
+#include "gydp_util.h"
+#include "gydp_conf.h"
+#include "gydp_app.h"
+#include "gydp_convert.h"
+
+#include <glib/gstdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* default number of timed runs of load and convert */
+#define GYDP_BENCH_RUNS 5
+
+/* default number of timed find and render operations */
+#define GYDP_BENCH_QUERIES 20000
+
+/* timed operations of single kind */
+typedef struct GydpBench {
+	GArray *times;        /* seconds of every operation (gdouble) */
+	gsize allocs;         /* allocations made by operations */
+	gsize bytes;          /* bytes requested by operations */
+	gsize volume;         /* bytes processed by operations (throughput) */
+
+	/* running operation */
+	gsize allocs_start;
+	gsize bytes_start;
+} GydpBench;
+
+/* raw definition of entry given by engine */
+typedef struct GydpBenchRaw {
+	gchar *word;          /* converted word */
+	const gchar *text;    /* definition data (mapped) */
+	gsize length;         /* definition length */
+} GydpBenchRaw;
+
+/* conversion function of engine */
+typedef gboolean (*GydpBenchConvert)(const gchar *word, const gchar *text, gsize len, GydpText *output);
+
+/* command line options */
+static gchar **gydp_bench_paths = NULL;
+static gchar *gydp_bench_engine = NULL;
+static gint gydp_bench_runs = GYDP_BENCH_RUNS;
+static gint gydp_bench_queries = GYDP_BENCH_QUERIES;
+static gint gydp_bench_seed = 1;
+static gboolean gydp_bench_compact = FALSE;
+
+static GOptionEntry gydp_bench_options[] = {
+	{ "path", 'p', 0, G_OPTION_ARG_FILENAME_ARRAY, &gydp_bench_paths,
+		"Directory with dictionary files (repeatable, bundled dictionaries by default)", "DIR" },
+	{ "engine", 'e', 0, G_OPTION_ARG_STRING, &gydp_bench_engine,
+		"Benchmark only this engine (sap, ydp)", "ENGINE" },
+	{ "runs", 'r', 0, G_OPTION_ARG_INT, &gydp_bench_runs,
+		"Timed runs of load and conversion", "N" },
+	{ "queries", 'q', 0, G_OPTION_ARG_INT, &gydp_bench_queries,
+		"Timed find and render operations", "N" },
+	{ "seed", 's', 0, G_OPTION_ARG_INT, &gydp_bench_seed,
+		"Seed of query mix", "N" },
+	{ "compact", 'c', 0, G_OPTION_ARG_NONE, &gydp_bench_compact,
+		"Load SAP dictionaries in compact mode", NULL },
+	{ NULL, 0, 0, 0, NULL, NULL, NULL }
+};
+
+/* allocation counters (operations are timed in main thread only) */
+static gsize gydp_bench_allocs = 0;
+static gsize gydp_bench_bytes = 0;
+static GTimer *gydp_bench_timer = NULL;
+
+/* allocations are counted by allocator of GNU C library replaced in this
+ * binary (dynamic linking resolves calls of GLib to it too), they can not
+ * be counted with other libraries */
+#ifdef __GLIBC__
+#define GYDP_BENCH_ALLOCS TRUE
+
+extern void *__libc_malloc (size_t size);
+extern void *__libc_calloc (size_t count, size_t size);
+extern void *__libc_realloc(void *mem, size_t size);
+#else
+#define GYDP_BENCH_ALLOCS FALSE
+#endif
+
+/* private functions */
+static void      gydp_bench_init   () __attribute__ ((constructor (101)));
+
+static GydpBench *gydp_bench_new   ();
+static void      gydp_bench_begin  (GydpBench *self);
+static void      gydp_bench_end    (GydpBench *self, gsize volume);
+static void      gydp_bench_report (GydpBench *self, const gchar *name);
+static gint      gydp_bench_compare(gconstpointer a, gconstpointer b);
+
+static void      gydp_bench_dict    (GydpEngine engine, GydpLang lang, gchar **paths, const gchar *cache);
+static void      gydp_bench_load    (GydpDict *dict, gchar **paths, GydpLang lang, const gchar *cache);
+static void      gydp_bench_find    (GydpDict *dict, GRand *rand);
+static void      gydp_bench_text    (GydpDict *dict, GRand *rand);
+static void      gydp_bench_convert (GydpDict *dict);
+static gboolean  gydp_bench_raw     (GydpDict *dict, guint n, GydpBenchRaw *entry);
+static gchar    *gydp_bench_query   (GydpDict *dict, GRand *rand);
+static void      gydp_bench_remove  (const gchar *path);
+
+/* external private conversion functions */
+gboolean  gydp_convert_sap_text(const gchar *word, const gchar *text, gsize len, GydpText *output);
+gboolean  gydp_convert_ydp_text(const gchar *word, const gchar *text, gsize len, GydpText *output);
+
+/** gydp_bench_init
+ * slices are allocated by malloc (set before slice allocator is
+ * initialized), so they are counted too
+ */
+static void gydp_bench_init() {
+	g_setenv("G_SLICE", "always-malloc", TRUE);
+}
+
+#ifdef __GLIBC__
+/* memory is released by free of C library, aligned allocations are not counted */
+void *malloc(size_t size) {
+	++gydp_bench_allocs;
+	gydp_bench_bytes += size;
+	return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+	++gydp_bench_allocs;
+	gydp_bench_bytes += count * size;
+	return __libc_calloc(count, size);
+}
+
+void *realloc(void *mem, size_t size) {
+	++gydp_bench_allocs;
+	gydp_bench_bytes += size;
+	return __libc_realloc(mem, size);
+}
+#endif
+
+int main(int argc, char *argv[]) {
+	GOptionContext *context = g_option_context_new("- time dictionary load, search and render");
+	GError *error = NULL;
+
+	g_option_context_add_main_entries(context, gydp_bench_options, NULL);
+	if( !g_option_context_parse(context, &argc, &argv, &error) ) {
+		g_printerr("%s\n", error->message);
+		g_error_free(error);
+		g_option_context_free(context);
+		return EXIT_FAILURE;
+	}
+	g_option_context_free(context);
+
+	/* configuration and index caches are kept apart from user ones, in
+	 * new private directory */
+	gchar *root = g_dir_make_tmp("gydp-bench-XXXXXX", &error);
+	if( root == NULL ) {
+		g_printerr("Unable to create scratch directory: %s\n", error->message);
+		g_error_free(error);
+		return EXIT_FAILURE;
+	}
+
+	gchar *config_dir = g_build_filename(root, "config", NULL);
+	gchar *cache_dir = g_build_filename(root, "cache", NULL);
+	g_setenv("XDG_CONFIG_HOME", config_dir, TRUE);
+	g_setenv("XDG_CACHE_HOME", cache_dir, TRUE);
+	g_mkdir(config_dir, 0700);
+	g_free(config_dir);
+
+	GObject *app = gydp_app_new(NULL, NULL);
+	GydpConf *config = gydp_conf_new();
+	g_object_set_data_full(app, GYDP_APP_CONF, config, (GDestroyNotify)gydp_conf_free);
+
+	/* whole dictionary is loaded, every rendered definition is kept */
+	const gchar *sap = gydp_engine_value_to_nick(GYDP_ENGINE_SAP);
+	gydp_conf_set_integer(config, sap, "pages", 0);
+	gydp_conf_set_integer(config, sap, "compact", gydp_bench_compact);
+	gydp_conf_set_integer(config, "general", "texts", G_MAXINT / 1024);
+
+	/* bundled dictionaries by default */
+	gchar *bundled[] = { GYDP_SOURCE_DICT, NULL };
+	gchar **paths = gydp_bench_paths? gydp_bench_paths: bundled;
+
+	gydp_bench_timer = g_timer_new();
+	if( !GYDP_BENCH_ALLOCS )
+		g_print("Allocations are not counted (GNU C library is required).\n");
+	gydp_bench_runs = MAX(gydp_bench_runs, 1);
+	gydp_bench_queries = MAX(gydp_bench_queries, 1);
+
+	/* every engine and language found in paths */
+	static const GydpEngine engines[] = { GYDP_ENGINE_SAP, GYDP_ENGINE_YDP };
+	static const GydpLang langs[] = { GYDP_LANG_ENG_TO_POL, GYDP_LANG_ENG_FROM_POL };
+
+	for(guint i = 0; i < G_N_ELEMENTS(engines); ++i) {
+		if( gydp_bench_engine && strcmp(gydp_bench_engine, gydp_engine_value_to_nick(engines[i])) )
+			continue;
+
+		for(guint j = 0; j < G_N_ELEMENTS(langs); ++j)
+			gydp_bench_dict(engines[i], langs[j], paths, cache_dir);
+	}
+
+	/* free data */
+	g_timer_destroy(gydp_bench_timer);
+	g_object_unref(app);
+	g_strfreev(gydp_bench_paths);
+	g_free(gydp_bench_engine);
+
+	gydp_bench_remove(root);
+	g_free(cache_dir);
+	g_free(root);
+
+	return EXIT_SUCCESS;
+}
+
+static GydpBench *gydp_bench_new() {
+	GydpBench *self = g_slice_new0(GydpBench);
+	self->times = g_array_new(FALSE, FALSE, sizeof(gdouble));
+	return self;
+}
+
+static void gydp_bench_begin(GydpBench *self) {
+	self->allocs_start = gydp_bench_allocs;
+	self->bytes_start = gydp_bench_bytes;
+	g_timer_start(gydp_bench_timer);
+}
+
+static void gydp_bench_end(GydpBench *self, gsize volume) {
+	const gdouble time = g_timer_elapsed(gydp_bench_timer, NULL);
+
+	self->allocs += gydp_bench_allocs - self->allocs_start;
+	self->bytes += gydp_bench_bytes - self->bytes_start;
+	self->volume += volume;
+	g_array_append_val(self->times, time);
+}
+
+/** gydp_bench_report
+ * print percentiles of operation time (microseconds), mean is exact
+ * even for operations below timer resolution, throughput is printed
+ * for operations which processed some bytes, bench is freed
+ */
+static void gydp_bench_report(GydpBench *self, const gchar *name) {
+	const guint count = self->times->len;
+	gdouble *time = (gdouble *)self->times->data;
+	gdouble total = 0;
+
+	if( count == 0 ) {
+		g_print("  %-16s no operations\n", name);
+	} else {
+		for(guint i = 0; i < count; ++i)
+			total += time[i];
+		g_array_sort(self->times, gydp_bench_compare);
+
+		g_print("  %-16s %7u ops  mean %10.1f  p50 %10.1f  p90 %10.1f  p99 %10.1f  max %10.1f us",
+				name, count, 1e6 * total / count,
+				1e6 * time[count / 2], 1e6 * time[count * 9 / 10], 1e6 * time[count * 99 / 100],
+				1e6 * time[count - 1]);
+
+		if( GYDP_BENCH_ALLOCS )
+			g_print("  %8.1f allocs %10.1f B/op", (gdouble)self->allocs / count, (gdouble)self->bytes / count);
+
+		if( self->volume && total > 0 )
+			g_print("  %8.1f MB/s", self->volume / total / 1e6);
+		g_print("\n");
+	}
+
+	g_array_free(self->times, TRUE);
+	g_slice_free(GydpBench, self);
+}
+
+static gint gydp_bench_compare(gconstpointer a, gconstpointer b) {
+	const gdouble x = *(const gdouble *)a, y = *(const gdouble *)b;
+	return x < y? -1: x > y;
+}
+
+static void gydp_bench_dict(GydpEngine engine, GydpLang lang, gchar **paths, const gchar *cache) {
+	GydpDict *dict = GYDP_DICT(gydp_engine_new(engine));
+	GRand *rand = g_rand_new_with_seed(gydp_bench_seed);
+
+	/* first load builds index cache and warms file cache */
+	if( !gydp_dict_load(dict, paths, lang) ) {
+		g_print("%s, %s: skipped (dictionary not found)\n",
+				gydp_engine_value_to_nick(engine), gydp_lang_value_to_nick(lang));
+	} else {
+		g_print("%s, %s: %u words\n", gydp_engine_value_to_nick(engine),
+				gydp_lang_value_to_nick(lang), gydp_dict_size(dict));
+
+		gydp_bench_load(dict, paths, lang, cache);
+		gydp_bench_find(dict, rand);
+		gydp_bench_text(dict, rand);
+		gydp_bench_convert(dict);
+	}
+
+	g_rand_free(rand);
+	g_object_unref(dict);
+}
+
+/** gydp_bench_load
+ * time load from dictionary files (index cache is removed before every
+ * run) and load from index cache, dictionary stays loaded
+ */
+static void gydp_bench_load(GydpDict *dict, gchar **paths, GydpLang lang, const gchar *cache) {
+	GydpBench *parse = gydp_bench_new(), *cached = gydp_bench_new();
+
+	for(gint i = 0; i < gydp_bench_runs; ++i) {
+		gydp_bench_remove(cache);
+
+		gydp_bench_begin(parse);
+		gydp_dict_load(dict, paths, lang);
+		gydp_bench_end(parse, 0);
+	}
+
+	for(gint i = 0; i < gydp_bench_runs; ++i) {
+		gydp_bench_begin(cached);
+		gydp_dict_load(dict, paths, lang);
+		gydp_bench_end(cached, 0);
+	}
+
+	gydp_bench_report(parse, "load (parse)");
+	gydp_bench_report(cached, "load (cache)");
+}
+
+/** gydp_bench_find
+ * time search of query mix, every query is searched as typed (each
+ * prefix in turn) and at once
+ */
+static void gydp_bench_find(GydpDict *dict, GRand *rand) {
+	GydpBench *typed = gydp_bench_new(), *whole = gydp_bench_new();
+	GPtrArray *queries = g_ptr_array_new();
+
+	/* queries are prepared before timing */
+	for(gint i = 0; i < gydp_bench_queries; ++i)
+		g_ptr_array_add(queries, gydp_bench_query(dict, rand));
+
+	for(guint i = 0; i < queries->len; ++i) {
+		const gchar *query = g_ptr_array_index(queries, i);
+
+		gydp_bench_begin(whole);
+		gydp_dict_find(dict, query);
+		gydp_bench_end(whole, 0);
+	}
+
+	for(guint i = 0; i < queries->len; ++i) {
+		const gchar *query = g_ptr_array_index(queries, i);
+		gchar *prefix = g_strdup(query);
+
+		for(const gchar *end = query; *end; ) {
+			end = g_utf8_next_char(end);
+			memcpy(prefix, query, end - query);
+			prefix[end - query] = '\0';
+
+			gydp_bench_begin(typed);
+			gydp_dict_find(dict, prefix);
+			gydp_bench_end(typed, 0);
+		}
+
+		g_free(prefix);
+	}
+
+	g_ptr_array_foreach(queries, (GFunc)g_free, NULL);
+	g_ptr_array_free(queries, TRUE);
+
+	gydp_bench_report(whole, "find");
+	gydp_bench_report(typed, "find (typed)");
+}
+
+/** gydp_bench_query
+ * query mix: existing headwords (40%), their prefixes (25%), headwords
+ * with one character substituted or removed (20%) and random letters
+ * (15%), everything is folded to lower case like typed words
+ */
+static gchar *gydp_bench_query(GydpDict *dict, GRand *rand) {
+	const guint kind = g_rand_int_range(rand, 0, 100);
+	const guint size = gydp_dict_size(dict);
+
+	/* random letters */
+	if( kind >= 85 || size == 0 ) {
+		const gint length = g_rand_int_range(rand, 1, 12);
+		gchar *query = g_malloc(length + 1);
+
+		for(gint i = 0; i < length; ++i)
+			query[i] = 'a' + g_rand_int_range(rand, 0, 26);
+		query[length] = '\0';
+
+		return query;
+	}
+
+	gchar *query = g_utf8_strdown(gydp_dict_word(dict, g_rand_int_range(rand, 0, size)), -1);
+	const glong length = g_utf8_strlen(query, -1);
+
+	if( kind < 40 || length < 2 )
+		return query;
+
+	/* cut or change character at random position */
+	gchar *pos = g_utf8_offset_to_pointer(query, g_rand_int_range(rand, 1, length));
+	if( kind < 65 )
+		*pos = '\0';
+	else if( kind < 75 )
+		memmove(pos, g_utf8_next_char(pos), strlen(g_utf8_next_char(pos)) + 1);
+	else if( g_utf8_next_char(pos) == pos + 1 )
+		*pos = 'a' + g_rand_int_range(rand, 0, 26);
+
+	return query;
+}
+
+/** gydp_bench_text
+ * time rendering of random entries with empty definitions cache (engine
+ * renders every definition) and again with all of them cached
+ */
+static void gydp_bench_text(GydpDict *dict, GRand *rand) {
+	GydpBench *cold = gydp_bench_new(), *warm = gydp_bench_new();
+	const guint size = gydp_dict_size(dict);
+	const guint count = MIN((guint)gydp_bench_queries, size);
+	GArray *entries = g_array_sized_new(FALSE, FALSE, sizeof(guint), count);
+	GydpText *text = gydp_text_new();
+
+	for(guint i = 0; i < count; ++i) {
+		const guint n = g_rand_int_range(rand, 0, size);
+		g_array_append_val(entries, n);
+	}
+
+	gydp_dict_text_flush(dict);
+	for(guint i = 0; i < count; ++i) {
+		gydp_bench_begin(cold);
+		gydp_dict_text(dict, g_array_index(entries, guint, i), text);
+		gydp_bench_end(cold, text->text->len);
+	}
+
+	for(guint i = 0; i < count; ++i) {
+		gydp_bench_begin(warm);
+		gydp_dict_text(dict, g_array_index(entries, guint, i), text);
+		gydp_bench_end(warm, text->text->len);
+	}
+
+	gydp_text_free(text);
+	g_array_free(entries, TRUE);
+
+	gydp_bench_report(cold, "text (cold)");
+	gydp_bench_report(warm, "text (warm)");
+}
+
+/** gydp_bench_convert
+ * time parsers of engine on raw definitions of all entries (given by
+ * engine before conversion) and transcoding of whole definitions file
+ */
+static void gydp_bench_convert(GydpDict *dict) {
+	const gchar *const *sources = gydp_dict_sources(dict);
+	GydpBenchConvert convert = NULL;
+	GydpCodepage codepage = GYDP_CODEPAGE_ISO88592;
+	GMappedFile *file = NULL;
+
+	switch( dict->engine ) {
+	case GYDP_ENGINE_SAP:
+		convert = gydp_convert_sap_text;
+		codepage = GYDP_CODEPAGE_ISO88592;
+		break;
+	case GYDP_ENGINE_YDP:
+		convert = gydp_convert_ydp_text;
+		codepage = GYDP_CODEPAGE_CP1250;
+		break;
+	default:
+		g_return_if_reached();
+	}
+
+	/* definitions are collected before timing (words are copied) */
+	const guint size = gydp_dict_size(dict);
+	GArray *raw = g_array_sized_new(FALSE, FALSE, sizeof(GydpBenchRaw), size);
+
+	for(guint n = 0; n < size; ++n) {
+		GydpBenchRaw entry;
+
+		if( gydp_bench_raw(dict, n, &entry) )
+			g_array_append_val(raw, entry);
+	}
+
+	GydpBench *parse = gydp_bench_new();
+	GydpText *text = gydp_text_new();
+
+	for(guint i = 0; i < raw->len; ++i) {
+		GydpBenchRaw *entry = &g_array_index(raw, GydpBenchRaw, i);
+
+		gydp_bench_begin(parse);
+		convert(entry->word, entry->text, entry->length, text);
+		gydp_bench_end(parse, entry->length);
+	}
+
+	gydp_bench_report(parse, "convert (parse)");
+
+	/* definitions file is first source of both engines */
+	if( sources && sources[0] && (file = g_mapped_file_new(sources[0], FALSE, NULL)) ) {
+		GydpBench *transcode = gydp_bench_new();
+		const gchar *data = g_mapped_file_get_contents(file);
+		const gsize length = g_mapped_file_get_length(file);
+		gchar *buffer = g_malloc(GYDP_CONVERT_MAX * length + 1);
+
+		for(gint i = 0; i < gydp_bench_runs; ++i) {
+			gydp_bench_begin(transcode);
+			gydp_convert_buffer(codepage, data, length, buffer);
+			gydp_bench_end(transcode, length);
+		}
+
+		gydp_bench_report(transcode, "convert (file)");
+
+		g_free(buffer);
+		g_mapped_file_free(file);
+	}
+
+	for(guint i = 0; i < raw->len; ++i)
+		g_free(g_array_index(raw, GydpBenchRaw, i).word);
+	g_array_free(raw, TRUE);
+	gydp_text_free(text);
+}
+
+/** gydp_bench_raw
+ * raw definition of entry given by its engine (word is copied)
+ */
+static gboolean gydp_bench_raw(GydpDict *dict, guint n, GydpBenchRaw *entry) {
+	const gchar *word = NULL;
+	gboolean result = FALSE;
+
+	switch( dict->engine ) {
+	case GYDP_ENGINE_SAP:
+		result = gydp_dict_sap_raw(GYDP_DICT_SAP(dict), n, &word, &entry->text, &entry->length);
+		break;
+	case GYDP_ENGINE_YDP:
+		result = gydp_dict_ydp_raw(GYDP_DICT_YDP(dict), n, &word, &entry->text, &entry->length);
+		break;
+	default:
+		break;
+	}
+
+	if( result )
+		entry->word = g_strdup(word);
+
+	return result;
+}
+
+/** gydp_bench_remove
+ * remove directory with all its content, symbolic links are removed
+ * and never followed
+ */
+static void gydp_bench_remove(const gchar *path) {
+	GDir *dir = g_dir_open(path, 0, NULL);
+	const gchar *name;
+
+	if( dir == NULL )
+		return;
+
+	while( (name = g_dir_read_name(dir)) != NULL ) {
+		gchar *child = g_build_filename(path, name, NULL);
+
+		if( !g_file_test(child, G_FILE_TEST_IS_SYMLINK) && g_file_test(child, G_FILE_TEST_IS_DIR) )
+			gydp_bench_remove(child);
+		else
+			g_unlink(child);
+
+		g_free(child);
+	}
+
+	g_dir_close(dir);
+	g_rmdir(path);
+}
@@ -0,0 +1,256 @@
+/*
+ * Copyright (C) 2008 Michał Kurgan <michal.kurgan@moloh.net>
+ *
+ * This file is part of gydpdict.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gydpdict.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gydp_cache.h"
+#include "gydp_util.h"
+
+#include <glib/gstdio.h>
+#include <string.h>
+
+/* cache file identification (native byte order) */
+#define GYDP_CACHE_MAGIC 0x47594458
+
+typedef struct GydpCacheHeader {
+	guint32 magic;     /* GYDP_CACHE_MAGIC */
+	guint32 version;   /* GYDP_CACHE_VERSION */
+	guint32 sources;   /* number of source stamps */
+	guint32 sections;  /* number of sections */
+} GydpCacheHeader;
+
+typedef struct GydpCacheStamp {
+	guint64 size;      /* source file size */
+	gint64 mtime;      /* source modification time */
+} GydpCacheStamp;
+
+typedef struct GydpCacheEntry {
+	guint64 offset;    /* section offset in file (aligned) */
+	guint64 size;      /* section size */
+} GydpCacheEntry;
+
+struct _GydpCache {
+	gchar *path;                 /* cache file location */
+	GydpCacheStamp *stamp;       /* stamps of source files */
+	guint sources;               /* number of source files */
+	gboolean valid;              /* all sources were found */
+
+	GMappedFile *file;           /* mapped cache file */
+	gconstpointer data[GYDP_CACHE_SECTIONS];
+	gsize size[GYDP_CACHE_SECTIONS];
+};
+
+/* private functions */
+static gsize gydp_cache_align(gsize size);
+static void  gydp_cache_unmap(GydpCache *self);
+
+GydpCache *gydp_cache_new(const gchar *name, const gchar *const *sources) {
+	GydpCache *self = g_slice_new0(GydpCache);
+	GString *key = g_string_new(name);
+	struct stat info;
+
+	/* allocate stamps */
+	self->sources = g_strv_length((gchar **)sources);
+	self->stamp = g_new0(GydpCacheStamp, self->sources);
+	self->valid = TRUE;
+
+	/* cache is identified by name and source paths, validated by stamps */
+	for(guint i = 0; i < self->sources; ++i) {
+		g_string_append_c(key, '\n');
+		g_string_append(key, sources[i]);
+
+		if( g_stat(sources[i], &info) != 0 ) {
+			self->valid = FALSE;
+			continue;
+		}
+
+		self->stamp[i].size = info.st_size;
+		self->stamp[i].mtime = info.st_mtime;
+	}
+
+	/* create cache file path */
+	gchar *dir = gydp_cache_dir();
+	gchar *sum = g_compute_checksum_for_string(G_CHECKSUM_MD5, key->str, key->len);
+	gchar *filename = g_strconcat(sum, ".idx", NULL);
+	self->path = g_build_filename(dir, filename, NULL);
+
+	/* free temporary data */
+	g_string_free(key, TRUE);
+	g_free(filename);
+	g_free(sum);
+	g_free(dir);
+
+	return self;
+}
+
+void gydp_cache_free(GydpCache *self) {
+	if( self != NULL ) {
+		if( self->file )
+			g_mapped_file_free(self->file);
+
+		g_free(self->stamp);
+		g_free(self->path);
+
+		g_slice_free(GydpCache, self);
+	}
+}
+
+/** gydp_cache_load
+ * map cache file and validate its structure, sections are available
+ * directly from mapping afterwards (no data is copied)
+ */
+gboolean gydp_cache_load(GydpCache *self) {
+	gboolean if_ok = FALSE;
+
+	/* sources changed or missing */
+	if( !self->valid )
+		return FALSE;
+
+	/* release previous mapping */
+	gydp_cache_unmap(self);
+
+	/* missing cache is not an error */
+	if( (self->file = g_mapped_file_new(self->path, FALSE, NULL)) == NULL )
+		return FALSE;
+
+	const gchar *data = g_mapped_file_get_contents(self->file);
+	const gsize size = g_mapped_file_get_length(self->file);
+	const gsize stamps = self->sources * sizeof(GydpCacheStamp);
+	const gsize entries = GYDP_CACHE_SECTIONS * sizeof(GydpCacheEntry);
+
+	while( TRUE ) {
+		const GydpCacheHeader *header = (const GydpCacheHeader *)data;
+
+		/* validate header */
+		if( size < sizeof(GydpCacheHeader) + stamps + entries ||
+				header->magic != GYDP_CACHE_MAGIC ||
+				header->version != GYDP_CACHE_VERSION ||
+				header->sources != self->sources ||
+				header->sections != GYDP_CACHE_SECTIONS )
+			break;
+
+		/* validate source files */
+		if( memcmp(data + sizeof(GydpCacheHeader), self->stamp, stamps) != 0 )
+			break;
+
+		/* validate and extract sections */
+		const GydpCacheEntry *entry = (const GydpCacheEntry *)(data + sizeof(GydpCacheHeader) + stamps);
+		guint i;
+		for(i = 0; i < GYDP_CACHE_SECTIONS; ++i) {
+			if( entry[i].offset % 8 || entry[i].offset > size ||
+					entry[i].size > size - entry[i].offset )
+				break;
+
+			self->data[i] = data + entry[i].offset;
+			self->size[i] = entry[i].size;
+		}
+
+		/* check if all sections are correct */
+		if( i < GYDP_CACHE_SECTIONS )
+			break;
+
+		/* confirm successful read */
+		if_ok = TRUE;
+		break;
+	}
+
+	/* outdated or broken cache */
+	if( !if_ok )
+		gydp_cache_unmap(self);
+
+	return if_ok;
+}
+
+gboolean gydp_cache_save(GydpCache *self) {
+	GydpCacheHeader header = { GYDP_CACHE_MAGIC, GYDP_CACHE_VERSION,
+		self->sources, GYDP_CACHE_SECTIONS };
+	GydpCacheEntry entry[GYDP_CACHE_SECTIONS];
+	GError *error = NULL;
+	gsize offset;
+
+	/* do not save cache of missing sources */
+	if( !self->valid )
+		return FALSE;
+
+	/* layout sections after header */
+	offset = gydp_cache_align(sizeof(GydpCacheHeader) +
+			self->sources * sizeof(GydpCacheStamp) + sizeof(entry));
+	for(guint i = 0; i < GYDP_CACHE_SECTIONS; ++i) {
+		entry[i].offset = offset;
+		entry[i].size = self->size[i];
+		offset = gydp_cache_align(offset + self->size[i]);
+	}
+
+	/* build file contents */
+	GString *data = g_string_sized_new(offset);
+	g_string_append_len(data, (const gchar *)&header, sizeof(header));
+	g_string_append_len(data, (const gchar *)self->stamp, self->sources * sizeof(GydpCacheStamp));
+	g_string_append_len(data, (const gchar *)entry, sizeof(entry));
+	for(guint i = 0; i < GYDP_CACHE_SECTIONS; ++i) {
+		while( data->len < entry[i].offset )
+			g_string_append_c(data, '\0');
+		g_string_append_len(data, self->data[i], self->size[i]);
+	}
+
+	/* create cache directory and replace file atomically */
+	gchar *dir = g_path_get_dirname(self->path);
+	if( g_mkdir_with_parents(dir, 0755) != 0 ||
+			!g_file_set_contents(self->path, data->str, data->len, &error) ) {
+		g_printerr("Error saving index cache '%s'.\n", self->path);
+		g_clear_error(&error);
+		self->valid = FALSE;
+	}
+
+	/* free temporary data */
+	g_string_free(data, TRUE);
+	g_free(dir);
+
+	return self->valid;
+}
+
+gconstpointer gydp_cache_get(GydpCache *self, GydpCacheSection section, gsize *size) {
+	g_return_val_if_fail(section < GYDP_CACHE_SECTIONS, NULL);
+
+	if( size )
+		*size = self->size[section];
+	return self->data[section];
+}
+
+void gydp_cache_set(GydpCache *self, GydpCacheSection section, gconstpointer data, gsize size) {
+	g_return_if_fail(section < GYDP_CACHE_SECTIONS);
+
+	/* cache is rebuilt, loaded sections are no longer valid */
+	gydp_cache_unmap(self);
+
+	self->data[section] = data;
+	self->size[section] = size;
+}
+
+static gsize gydp_cache_align(gsize size) {
+	return (size + 7) & ~(gsize)7;
+}
+
+static void gydp_cache_unmap(GydpCache *self) {
+	if( self->file == NULL )
+		return;
+
+	g_mapped_file_free(self->file);
+	self->file = NULL;
+
+	memset(self->data, 0, sizeof(self->data));
+	memset(self->size, 0, sizeof(self->size));
+}
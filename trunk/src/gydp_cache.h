@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2008 Michał Kurgan <michal.kurgan@moloh.net>
+ *
+ * This file is part of gydpdict.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gydpdict.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GYDP_CACHE_H__
+#define __GYDP_CACHE_H__
+
+#include "gydp_global.h"
+
+G_BEGIN_DECLS
+
+/* bump when layout of any section changes */
+#define GYDP_CACHE_VERSION 3
+
+typedef struct _GydpCache GydpCache;
+
+typedef enum {
+	GYDP_CACHE_WORDS,       /* engine word table */
+	GYDP_CACHE_STRINGS,     /* converted words (utf8, terminated) */
+	GYDP_CACHE_KEYS_DATA,   /* folded search keys */
+	GYDP_CACHE_KEYS_KEY,    /* key offsets */
+	GYDP_CACHE_KEYS_ORDER,  /* sorted key order */
+	GYDP_CACHE_TEXT_TERMS,  /* full-text terms (sorted, terminated) */
+	GYDP_CACHE_TEXT_TERM,   /* term offsets */
+	GYDP_CACHE_TEXT_START,  /* first posting of every term (and end) */
+	GYDP_CACHE_TEXT_POSTINGS, /* entry and term frequency pairs */
+	GYDP_CACHE_COMPACT_WORDS,      /* front coded words */
+	GYDP_CACHE_COMPACT_BLOCKS,     /* block offsets of words */
+	GYDP_CACHE_COMPACT_KEYS,       /* front coded folded words (sorted) */
+	GYDP_CACHE_COMPACT_KEY_BLOCKS, /* block offsets of folded words */
+	GYDP_CACHE_COMPACT_ORDER,      /* entry of every folded word */
+	GYDP_CACHE_COMPACT_TEXTS,      /* definition offset and length pairs */
+	GYDP_CACHE_SECTIONS,
+} GydpCacheSection;
+
+/* cache of index built from source files (NULL terminated list) */
+GydpCache    *gydp_cache_new (const gchar *name, const gchar *const *sources);
+void          gydp_cache_free(GydpCache *self);
+
+/* map cache file, fails if missing or outdated */
+gboolean      gydp_cache_load(GydpCache *self);
+gboolean      gydp_cache_save(GydpCache *self);
+
+/* section data (set data has to stay valid until save) */
+gconstpointer gydp_cache_get (GydpCache *self, GydpCacheSection section, gsize *size);
+void          gydp_cache_set (GydpCache *self, GydpCacheSection section, gconstpointer data, gsize size);
+
+G_END_DECLS
+
+#endif /* __GYDP_CACHE_H__ */
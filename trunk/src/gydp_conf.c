@@ -79,6 +79,16 @@ gboolean gydp_conf_load(GydpConf *self) {
 			g_key_file_set_string(cfg, sap, "lang", gydp_lang_value_to_name(GYDP_LANG_ENG_FROM_POL));
 			load_default = TRUE;
 		}
+		if( !g_key_file_has_key(cfg, sap, "pages", NULL) ) {
+			/* page cache size, zero disables lazy loading */
+			g_key_file_set_integer(cfg, sap, "pages", 0);
+			load_default = TRUE;
+		}
+		if( !g_key_file_has_key(cfg, sap, "compact", NULL) ) {
+			/* front coded words, non zero saves memory of resident dictionary */
+			g_key_file_set_integer(cfg, sap, "compact", 0);
+			load_default = TRUE;
+		}
 	}
 
 	{ /* engine YDP */
@@ -93,6 +103,44 @@ gboolean gydp_conf_load(GydpConf *self) {
 		}
 	}
 
+	{ /* merged engines */
+		const gchar *merge = gydp_engine_value_to_nick(GYDP_ENGINE_MERGE);
+		if( !g_key_file_has_key(cfg, merge, "lang", NULL) ) {
+			g_key_file_set_string(cfg, merge, "lang", gydp_lang_value_to_name(GYDP_LANG_ENG_FROM_POL));
+			load_default = TRUE;
+		}
+	}
+
+	/* rendered definitions cache size (KiB), zero disables cache */
+	if( !g_key_file_has_key(cfg, "general", "texts", NULL) ) {
+		g_key_file_set_integer(cfg, "general", "texts", 1024);
+		load_default = TRUE;
+	}
+
+	/* loaded dictionaries kept for switching (KiB), zero keeps only current one */
+	if( !g_key_file_has_key(cfg, "general", "resident", NULL) ) {
+		g_key_file_set_integer(cfg, "general", "resident", 65536);
+		load_default = TRUE;
+	}
+
+	/* neighbouring definitions rendered while idle (on each side) */
+	if( !g_key_file_has_key(cfg, "general", "prefetch", NULL) ) {
+		g_key_file_set_integer(cfg, "general", "prefetch", 2);
+		load_default = TRUE;
+	}
+
+	/* lookup daemon, commands of clients are answered by pool of workers */
+	if( !g_key_file_has_key(cfg, "serve", "workers", NULL) ) {
+		g_key_file_set_integer(cfg, "serve", "workers", 8);
+		load_default = TRUE;
+	}
+
+	/* lookup daemon, idle clients are disconnected (seconds) */
+	if( !g_key_file_has_key(cfg, "serve", "timeout", NULL) ) {
+		g_key_file_set_integer(cfg, "serve", "timeout", 600);
+		load_default = TRUE;
+	}
+
 	/* window geometry */
 	if( !g_key_file_has_key(cfg, "window", "geometry", NULL) ) {
 		g_key_file_set_string(cfg, "window", "geometry", "220x150");
@@ -24,6 +24,8 @@
 
 G_BEGIN_DECLS
 
+/* configuration is not thread safe, it is used only in main thread
+ * (dictionary loaders get their settings with gydp_dict_configure) */
 typedef struct _GydpConf GydpConf;
 
 GydpConf *gydp_conf_new       ();
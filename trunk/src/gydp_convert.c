@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2008 Michał Kurgan <michal.kurgan@moloh.net>
+ *
+ * This file is part of gydpdict.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gydpdict.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gydp_convert.h"
+#include <string.h>
+
+/* precomputed conversion of every byte */
+typedef struct GydpConvertTable {
+	guint8 length[256];                  /* utf8 length of converted byte */
+	gchar bytes[256][GYDP_CONVERT_MAX];  /* utf8 sequence of converted byte */
+} GydpConvertTable;
+
+/* private functions */
+static const GydpConvertTable *gydp_convert_table(GydpCodepage codepage);
+static void                    gydp_convert_table_fill(GydpConvertTable *table,
+                                                       const gchar **convert, gsize size);
+
+/* iso-8859-2 conversion table */
+static const gchar *gydp_convert_iso88592[128] = {
+	"?", "?", "?", "?", "?", "?", "?", "?",
+	"?", "?", "?", "?", "?", "?", "?", "?",
+	"?", "?", "?", "?", "?", "?", "?", "?",
+	"?", "?", "?", "?", "?", "?", "?", "?",
+	" ", "Ą", "˘", "Ł", "¤", "Ľ", "Ś", "§",
+	"¨", "Š", "Ş", "Ť", "Ź", "­", "Ž", "Ż",
+	"°", "ą", "˛", "ł", "´", "ľ", "ś", "ˇ",
+	"¸", "š", "ş", "ť", "ź", "˝", "ž", "ż",
+	"Ŕ", "Á", "Â", "Ă", "Ä", "Ĺ", "Ć", "Ç",
+	"Č", "É", "Ę", "Ë", "Ě", "Í", "Î", "Ď",
+	"Đ", "Ń", "Ň", "Ó", "Ô", "Ő", "Ö", "×",
+	"Ř", "Ů", "Ú", "Ű", "Ü", "Ý", "Ţ", "ß",
+	"ŕ", "á", "â", "ă", "ä", "ĺ", "ć", "ç",
+	"č", "é", "ę", "ë", "ě", "í", "î", "ď",
+	"đ", "ń", "ň", "ó", "ô", "ő", "ö", "÷",
+	"ř", "ů", "ú", "ű", "ü", "ý", "ţ", "˙",
+};
+
+/* cp1250 conversion table (with changes/fixes) */
+static const gchar *gydp_convert_cp1250[128] = {
+	"€", "?", "‚", "?", "„", "…", "†", "ci", /* ‡ -> ci */
+	"?", "‰", "Š", "‹", "Ś", "Ť", "Ž", "Ż",  /* Ź -> Ż */
+	"?", "‘", "’", "“", "”", "•", "–", "—",
+	"?", "™", "š", "›", "ś", "ť", "ž", "ź",
+	" ", "ˇ", "˘", "Ł", "¤", "Ą", "¦", "§",
+	"¨", "©", "Ş", "«", "¬", "­", "®", "Ż",
+	"°", "±", "˛", "ł", "´", "µ", "¶", "·",
+	"¸", "ą", "ş", "»", "Ľ", "˝", "ľ", "ż",
+	"Ŕ", "Á", "Â", "Ă", "Ä", "Ĺ", "Ć", "Ç",
+	"Č", "É", "Ę", "Ë", "Ě", "Í", "Î", "Ď",
+	"Đ", "Ń", "Ň", "Ó", "Ô", "Ő", "Ö", "×",
+	"Ř", "Ů", "Ú", "Ű", "Ü", "Ý", "Ţ", "ß",
+	"à", "á", "â", "ă", "ä", "ĺ", "ć", "ç",  /* ŕ -> à */
+	"č", "é", "ę", "ë", "ě", "í", "î", "ï",  /* č -> e, ď -> ï */
+	"đ", "ń", "ň", "ó", "ô", "ő", "ö", "÷",
+	"ř", "ů", "ú", "ű", "ü", "ý", "ţ", "˙",
+};
+
+/* phonetic conversion table (other characters are copied) */
+static const gchar *gydp_convert_phonetic[32] = {
+	"?", "?", "ɔ", "ʒ", "?", "ʃ", "ɛ", "ʌ",
+	"ə", "θ", "ɪ", "ɑ", "?", "ː", "ˈ", "?",
+	"ŋ", "?", "?", "?", "?", "?", "?", "ð",
+	"æ", "?", "?", "?", "?", "?", "?", "?",
+};
+
+static GydpConvertTable gydp_convert_tables[GYDP_CODEPAGES];
+
+static const GydpConvertTable *gydp_convert_table(GydpCodepage codepage) {
+	static volatile gsize initialized = 0;
+
+	/* tables are built once, loader threads may race for them */
+	if( g_once_init_enter(&initialized) ) {
+		gydp_convert_table_fill(&gydp_convert_tables[GYDP_CODEPAGE_ISO88592],
+				gydp_convert_iso88592, G_N_ELEMENTS(gydp_convert_iso88592));
+		gydp_convert_table_fill(&gydp_convert_tables[GYDP_CODEPAGE_CP1250],
+				gydp_convert_cp1250, G_N_ELEMENTS(gydp_convert_cp1250));
+		gydp_convert_table_fill(&gydp_convert_tables[GYDP_CODEPAGE_PHONETIC],
+				gydp_convert_phonetic, G_N_ELEMENTS(gydp_convert_phonetic));
+		g_once_init_leave(&initialized, 1);
+	}
+
+	return &gydp_convert_tables[codepage];
+}
+
+static void gydp_convert_table_fill(GydpConvertTable *table, const gchar **convert, gsize size) {
+	for(gsize c = 0; c < 256; ++c) {
+		/* ascii and characters past conversion table are copied */
+		if( c < 128 || c >= 128 + size ) {
+			table->length[c] = 1;
+			table->bytes[c][0] = c;
+		} else {
+			const gsize length = strlen(convert[c - 128]);
+
+			g_assert(length > 0 && length <= GYDP_CONVERT_MAX);
+			table->length[c] = length;
+			memcpy(table->bytes[c], convert[c - 128], length);
+		}
+	}
+}
+
+gsize gydp_convert_length(GydpCodepage codepage, const gchar *text, gsize len) {
+	const GydpConvertTable *table = gydp_convert_table(codepage);
+	const guchar *pos = (const guchar *)text;
+	gsize length = 0;
+
+	for(gsize i = 0; i < len; ++i)
+		length += table->length[pos[i]];
+
+	return length;
+}
+
+gchar *gydp_convert_buffer(GydpCodepage codepage, const gchar *text, gsize len, gchar *buffer) {
+	const GydpConvertTable *table = gydp_convert_table(codepage);
+	const guchar *pos = (const guchar *)text;
+	const guchar *end = pos + len;
+
+	while( pos < end ) {
+		/* copy ascii runs word at a time */
+		while( end - pos >= 8 ) {
+			guint64 chunk;
+
+			memcpy(&chunk, pos, 8);
+			if( chunk & G_GUINT64_CONSTANT(0x8080808080808080) )
+				break;
+
+			memcpy(buffer, &chunk, 8);
+			buffer += 8;
+			pos += 8;
+		}
+
+		/* convert word containing other characters (or text tail) through table */
+		const guchar *next = end - pos > 8? pos + 8: end;
+
+		while( pos < next ) {
+			const guchar c = *(pos++);
+
+			/* fixed size copy, buffer has room for worst case */
+			memcpy(buffer, table->bytes[c], GYDP_CONVERT_MAX);
+			buffer += table->length[c];
+		}
+	}
+
+	return buffer;
+}
+
+void gydp_convert_append(GydpCodepage codepage, GString *string, const gchar *text, gsize len) {
+	const gsize offset = string->len;
+
+	/* reserve worst case size, then cut to converted length */
+	g_string_set_size(string, offset + GYDP_CONVERT_MAX * len);
+	gchar *end = gydp_convert_buffer(codepage, text, len, string->str + offset);
+	g_string_truncate(string, end - string->str);
+}
+
+const gchar *gydp_convert_arena(GydpCodepage codepage, GydpArena *arena, const gchar *text, gsize len) {
+	const gsize size = GYDP_CONVERT_MAX * len + 1;
+
+	/* reserve worst case size, unused tail is returned to arena */
+	gchar *data = gydp_arena_alloc(arena, size);
+	gchar *end = gydp_convert_buffer(codepage, text, len, data);
+	*(end++) = '\0';
+	gydp_arena_shrink(arena, data, size, end - data);
+
+	return data;
+}
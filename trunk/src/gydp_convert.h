@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2008 Michał Kurgan <michal.kurgan@moloh.net>
+ *
+ * This file is part of gydpdict.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gydpdict.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GYDP_CONVERT_H__
+#define __GYDP_CONVERT_H__
+
+#include "gydp_global.h"
+#include "gydp_arena.h"
+
+G_BEGIN_DECLS
+
+/* maximal length of single converted character (utf8) */
+#define GYDP_CONVERT_MAX 3
+
+typedef enum {
+	GYDP_CODEPAGE_ISO88592, /* SAP dictionaries */
+	GYDP_CODEPAGE_CP1250,   /* YDP dictionaries */
+	GYDP_CODEPAGE_PHONETIC, /* YDP phonetic font */
+	GYDP_CODEPAGES,
+} GydpCodepage;
+
+/* length of converted text (without terminator) */
+gsize        gydp_convert_length(GydpCodepage codepage, const gchar *text, gsize len);
+
+/* convert text into buffer of GYDP_CONVERT_MAX * len bytes, returns end of output */
+gchar       *gydp_convert_buffer(GydpCodepage codepage, const gchar *text, gsize len, gchar *buffer);
+
+/* convert text and append it to string */
+void         gydp_convert_append(GydpCodepage codepage, GString *string, const gchar *text, gsize len);
+
+/* convert text into arena (terminated) */
+const gchar *gydp_convert_arena (GydpCodepage codepage, GydpArena *arena, const gchar *text, gsize len);
+
+G_END_DECLS
+
+#endif /* __GYDP_CONVERT_H__ */
@@ -18,107 +18,42 @@
  */
 
 #include "gydp_global.h"
-#include <gtk/gtktextbuffer.h>
-#include <string.h>
-
-typedef enum GydpSAPStyle {
-	GYDP_SAP_NONE    = 0,
-	GYDP_SAP_BOLD    = 1 << 0,
-	GYDP_SAP_ITALIC  = 1 << 1,
-	GYDP_SAP_SUPER   = 1 << 2,
-	GYDP_SAP_RED     = 1 << 3,
-	GYDP_SAP_GREEN   = 1 << 4,
-	GYDP_SAP_BLUE    = 1 << 5,
-} GydpSAPStyle;
+#include "gydp_convert.h"
+#include "gydp_text.h"
+#include "gydp_stats.h"
 
 typedef struct GydpSAPContext {
 	const gchar *word;     /* word to translate */
 	const gchar *sap;      /* translation text to convert */
 	gsize len;             /* length of translation text */
-	GtkTextBuffer *widget; /* output buffer */
-	GString *text;         /* raw text without control characters (utf8) */
+	GydpText *output;      /* rendered text */
+	gsize start;           /* start of uncommited text in output */
 } GydpSAPContext;
 
 /* structure management functions */
-static GydpSAPContext *gydp_sap_context_new (const gchar *word, const gchar *text, gsize len, GtkTextBuffer *widget);
+static GydpSAPContext *gydp_sap_context_new (const gchar *word, const gchar *text, gsize len, GydpText *output);
 static void            gydp_sap_context_free(GydpSAPContext *self);
 
 /* processing functions */
-static void gydp_sap_parse        (GydpSAPContext *context);
-static void gydp_sap_parse_type   (GydpSAPContext *context, gsize pos);
-static void gydp_sap_append_text  (GydpSAPContext *context, const gchar *text);  /* append utf8 text */
-static void gydp_sap_append_text_c(GydpSAPContext *context, gchar character);    /* append native character */
-static void gydp_sap_commit_text  (GydpSAPContext *context, GydpSAPStyle style);
+static gboolean gydp_sap_special      (gchar character);
+static void     gydp_sap_parse        (GydpSAPContext *context);
+static void     gydp_sap_parse_type   (GydpSAPContext *context, gsize pos);
+static void     gydp_sap_append_text  (GydpSAPContext *context, const gchar *text);            /* append utf8 text */
+static void     gydp_sap_append_text_n(GydpSAPContext *context, const gchar *text, gsize len); /* append native text */
+static void     gydp_sap_commit_text  (GydpSAPContext *context, GydpStyle style);
 
 /* internal conversion functions */
-gchar    *gydp_convert_sap       (const gchar *text);
-gboolean  gydp_convert_sap_widget(const gchar *word, const gchar *text, gsize len, GtkTextBuffer *widget);
-
-static const gchar *gydp_sap_encoding_iso88592[128] = {
-	"?", "?", "?", "?", "?", "?", "?", "?",
-	"?", "?", "?", "?", "?", "?", "?", "?",
-	"?", "?", "?", "?", "?", "?", "?", "?",
-	"?", "?", "?", "?", "?", "?", "?", "?",
-	" ", "Ą", "˘", "Ł", "¤", "Ľ", "Ś", "§",
-	"¨", "Š", "Ş", "Ť", "Ź", "­", "Ž", "Ż",
-	"°", "ą", "˛", "ł", "´", "ľ", "ś", "ˇ",
-	"¸", "š", "ş", "ť", "ź", "˝", "ž", "ż",
-	"Ŕ", "Á", "Â", "Ă", "Ä", "Ĺ", "Ć", "Ç",
-	"Č", "É", "Ę", "Ë", "Ě", "Í", "Î", "Ď",
-	"Đ", "Ń", "Ň", "Ó", "Ô", "Ő", "Ö", "×",
-	"Ř", "Ů", "Ú", "Ű", "Ü", "Ý", "Ţ", "ß",
-	"ŕ", "á", "â", "ă", "ä", "ĺ", "ć", "ç",
-	"č", "é", "ę", "ë", "ě", "í", "î", "ď",
-	"đ", "ń", "ň", "ó", "ô", "ő", "ö", "÷",
-	"ř", "ů", "ú", "ű", "ü", "ý", "ţ", "˙",
-};
-
-gchar *gydp_convert_sap(const gchar *text) {
-	const gchar **convert = gydp_sap_encoding_iso88592;
-	gchar *buffer;
-	gsize len = 0;
-
-	/* obtain required length for buffer */
-	for(const guchar *pos = (const guchar *)text; *pos; ++pos) {
-		if( *pos < 128 )
-			len += 1;
-		else
-			len += strlen(gydp_sap_encoding_iso88592[*pos - 128]);
-	}
-
-	/* allocate buffer  */
-	buffer = g_malloc(len + 1);
-
-	/* convert characters */
-	for(gchar *pos = buffer; TRUE; ) {
-		const guchar c = *(text++);
-
-		if( c < 128 )
-			*(pos++) = c;
-		else {
-			switch( strlen(convert[c - 128]) ) {
-			case 1: *(pos++) = *convert[c - 128]; break;
-			case 2: memcpy(pos, convert[c - 128], 2); pos += 2; break;
-			case 3: memcpy(pos, convert[c - 128], 3); pos += 3; break;
-			default: g_free(buffer); g_return_val_if_reached(NULL); break;
-			}
-		}
+gboolean  gydp_convert_sap_text(const gchar *word, const gchar *text, gsize len, GydpText *output);
 
-		/* check for terminator */
-		if( !c )
-			break;
-	}
-
-	return buffer;
-}
-
-gboolean gydp_convert_sap_widget(const gchar *word, const gchar *text, gsize len, GtkTextBuffer *widget) {
+gboolean gydp_convert_sap_text(const gchar *word, const gchar *text, gsize len, GydpText *output) {
 
 	/* allocate and initialize context */
-	GydpSAPContext *context = gydp_sap_context_new(word, text, len, widget);
+	GydpSAPContext *context = gydp_sap_context_new(word, text, len, output);
 
 	/* parse data in context */
+	const gdouble start = gydp_stats_begin();
 	gydp_sap_parse(context);
+	gydp_stats_end(GYDP_STATS_CONVERT_PARSE, start);
 
 	/* free context */
 	gydp_sap_context_free(context);
@@ -126,7 +61,7 @@ gboolean gydp_convert_sap_widget(const gchar *word, const gchar *text, gsize len
 	return TRUE;
 }
 
-GydpSAPContext *gydp_sap_context_new(const gchar *word, const gchar *text, gsize len, GtkTextBuffer *widget) {
+GydpSAPContext *gydp_sap_context_new(const gchar *word, const gchar *text, gsize len, GydpText *output) {
 	/* allocate context */
 	GydpSAPContext *self = g_malloc(sizeof(GydpSAPContext));
 
@@ -134,36 +69,43 @@ GydpSAPContext *gydp_sap_context_new(const gchar *word, const gchar *text, gsize
 	self->word = word;
 	self->sap = text;
 	self->len = len;
-	self->widget = widget;
+	self->output = output;
 
 	/* initalize context state */
-	self->text = g_string_sized_new(128);
+	gydp_text_clear(output);
+	self->start = 0;
 
 	return self;
 }
 
 void gydp_sap_context_free(GydpSAPContext *self) {
 	if( self != NULL ) {
-		/* free strings */
-		g_string_free(self->text, TRUE);
-
 		/* free self */
 		g_free(self);
 	}
 }
 
+static gboolean gydp_sap_special(gchar character) {
+	/* characters handled by parser */
+	switch( character ) {
+	case ')': case '{': case '}': case '-': case '*': case '$': case '#':
+		return TRUE;
+	default:
+		return FALSE;
+	}
+}
+
 static void gydp_sap_parse(GydpSAPContext *context) {
 	for(gsize i = 0; i < context->len; ++i) {
 		switch( context->sap[i] ) {
 		case ')':
-			gydp_sap_append_text_c(context, context->sap[i]);
-			gydp_sap_append_text_c(context, ' ');
+			gydp_sap_append_text(context, ") ");
 			break;
 		case '{':
-			gydp_sap_commit_text(context, GYDP_SAP_NONE);
+			gydp_sap_commit_text(context, GYDP_STYLE_NONE);
 			break;
 		case '}':
-			gydp_sap_commit_text(context, GYDP_SAP_BOLD);
+			gydp_sap_commit_text(context, GYDP_STYLE_BOLD);
 			gydp_sap_append_text(context, " - ");
 			break;
 		case '-':
@@ -176,19 +118,26 @@ static void gydp_sap_parse(GydpSAPContext *context) {
 			gydp_sap_append_text(context, "\n • ");
 			break;
 		case '#':
-			gydp_sap_commit_text(context, GYDP_SAP_NONE);
+			gydp_sap_commit_text(context, GYDP_STYLE_NONE);
 			gydp_sap_parse_type(context, i);
-			gydp_sap_commit_text(context, GYDP_SAP_ITALIC | GYDP_SAP_BLUE);
+			gydp_sap_commit_text(context, GYDP_STYLE_ITALIC | GYDP_STYLE_COLOR_BLUE);
 			i += 2; /* adjust position, (type specification length) */
 			break;
-		default:
-			gydp_sap_append_text_c(context, context->sap[i]);
+		default: { /* other characters, converted as whole run */
+			gsize end = i + 1;
+
+			while( end < context->len && !gydp_sap_special(context->sap[end]) )
+				++end;
+
+			gydp_sap_append_text_n(context, context->sap + i, end - i);
+			i = end - 1;
 			break;
 		}
+		}
 	}
 
 	/* commit pending text */
-	gydp_sap_commit_text(context, GYDP_SAP_NONE);
+	gydp_sap_commit_text(context, GYDP_STYLE_NONE);
 }
 
 static void gydp_sap_parse_type(GydpSAPContext *context, gsize pos) {
@@ -250,81 +199,24 @@ static void gydp_sap_parse_type(GydpSAPContext *context, gsize pos) {
 				gydp_sap_append_text(context, type[i].type);
 			}
 
-		gydp_sap_append_text_c(context, ' ');
+		gydp_sap_append_text(context, " ");
 	}
 }
 
 static void gydp_sap_append_text(GydpSAPContext *context, const gchar *text) {
-	g_string_append(context->text, text);
+	g_string_append(context->output->text, text);
 }
 
-static void gydp_sap_append_text_c(GydpSAPContext *context, gchar character) {
-	if( character >= 0 )
-		g_string_append_c(context->text, character);
-	else {
-		const gchar **convert = gydp_sap_encoding_iso88592;
-		const gsize i = (guchar)character - 128;
-
-		switch( strlen(convert[i]) ) {
-		case 1: g_string_append_c(context->text, *convert[i]); break;
-		case 2: g_string_append_len(context->text, convert[i], 2); break;
-		case 3: g_string_append_len(context->text, convert[i], 3); break;
-		default: g_return_if_reached(); break;
-		}
-	}
+static void gydp_sap_append_text_n(GydpSAPContext *context, const gchar *text, gsize len) {
+	gydp_convert_append(GYDP_CODEPAGE_ISO88592, context->output->text, text, len);
 }
 
-static void gydp_sap_commit_text(GydpSAPContext *context, GydpSAPStyle style) {
-	GtkTextIter begin, end;
-	GtkTextMark *mark;
-
-	/* skip if no text present in context */
-	if( !context->text->len )
-		return;
-
-	if( style ) {
-		/* get insert position and set mark */
-		gtk_text_buffer_get_end_iter(context->widget, &end);
-		mark = gtk_text_buffer_create_mark(context->widget, NULL, &end, TRUE);
-
-		/* insert text */
-		gtk_text_buffer_insert(context->widget, &end, context->text->str, -1);
-
-		/* extract begin iter and delete mark */
-		gtk_text_buffer_get_iter_at_mark(context->widget, &begin, mark);
-		gtk_text_buffer_delete_mark(context->widget, mark);
-
-		/*
-		 * apply styles
-		 */
+static void gydp_sap_commit_text(GydpSAPContext *context, GydpStyle style) {
+	const gdouble start = gydp_stats_begin();
 
-		if( style & GYDP_SAP_BOLD )
-			gtk_text_buffer_apply_tag_by_name(context->widget,
-					GYDP_TAG_BOLD, &begin, &end);
+	/* style pending text, it is already in output */
+	gydp_text_style(context->output, context->start, style);
+	context->start = context->output->text->len;
 
-		if( style & GYDP_SAP_ITALIC )
-			gtk_text_buffer_apply_tag_by_name(context->widget,
-					GYDP_TAG_ITALIC, &begin, &end);
-
-		if( style & GYDP_SAP_RED )
-			gtk_text_buffer_apply_tag_by_name(context->widget,
-					GYDP_TAG_COLOR_RED, &begin, &end);
-
-		if( style & GYDP_SAP_GREEN )
-			gtk_text_buffer_apply_tag_by_name(context->widget,
-					GYDP_TAG_COLOR_GREEN, &begin, &end);
-
-		if( style & GYDP_SAP_BLUE )
-			gtk_text_buffer_apply_tag_by_name(context->widget,
-					GYDP_TAG_COLOR_BLUE, &begin, &end);
-
-	} else {
-		/* insert clean text at end of buffer */
-		gtk_text_buffer_get_end_iter(context->widget, &end);
-		gtk_text_buffer_insert(context->widget, &end, context->text->str, -1);
-	}
-
-	/* remove commited text */
-	g_string_truncate(context->text, 0);
+	gydp_stats_end(GYDP_STATS_CONVERT_COMMIT, start);
 }
-
@@ -18,7 +18,9 @@
  */
 
 #include "gydp_global.h"
-#include <gtk/gtktextbuffer.h>
+#include "gydp_convert.h"
+#include "gydp_text.h"
+#include "gydp_stats.h"
 #include <string.h>
 
 typedef enum GydpYDPAlign {
@@ -57,21 +59,22 @@ typedef struct GydpYDPState {
 typedef struct GydpYDPContext {
 	const gchar *word;     /* word to translate */
 	const gchar *rtf;      /* translation text to convert */
-	GtkTextBuffer *widget; /* output buffer */
+	const gchar *end;      /* end of translation text */
+	GydpText *output;      /* rendered text */
 	GSList *state;         /* control codes stack */
 	GString *control;      /* raw control code */
 	GString *text;         /* raw text without control codes */
-	GString *buffer;       /* static temporary buffer */
 } GydpYDPContext;
 
 /* structure management functions */
 GydpYDPState   *gydp_ydp_state_new    ();
 GydpYDPState   *gydp_ydp_state_clone  (GydpYDPState *self);
 void            gydp_ydp_state_free   (GydpYDPState *self);
-GydpYDPContext *gydp_ydp_context_new  (const gchar *word, const gchar *text, GtkTextBuffer *widget);
+GydpYDPContext *gydp_ydp_context_new  (const gchar *word, const gchar *text, gsize len, GydpText *output);
 void            gydp_ydp_context_free (GydpYDPContext *self);
 
 /* processing functions */
+static gchar    gydp_ydp_char         (GydpYDPContext *context, const gchar *pos);
 static void     gydp_ydp_parse        (GydpYDPContext *context);
 static void     gydp_ydp_parse_control(GydpYDPContext *context);
 static void     gydp_ydp_push_state   (GydpYDPContext *context);
@@ -80,97 +83,17 @@ static void     gydp_ydp_pop_state    (GydpYDPContext *context);
 static void     gydp_ydp_commit_text  (GydpYDPContext *context);
 
 /* internal conversion functions */
-gchar    *gydp_convert_ydp       (const gchar *text);
-void      gydp_convert_ydp_buffer(const gchar *text, gboolean phonetic, gchar *buffer);
-gboolean  gydp_convert_ydp_widget(const gchar *word, const gchar *text, GtkTextBuffer *widget);
-
-/* phonetic conversion table */
-static const gchar *gydp_ydp_encoding_phonetic[32] = {
-	"?", "?", "ɔ", "ʒ", "?", "ʃ", "ɛ", "ʌ",
-	"ə", "θ", "ɪ", "ɑ", "?", "ː", "ˈ", "?",
-	"ŋ", "?", "?", "?", "?", "?", "?", "ð",
-	"æ", "?", "?", "?", "?", "?", "?", "?",
-};
-
-/* cp1250 conversion table (with changes/fixes) */
-static const gchar *gydp_ydp_encoding_cp1250[128] = {
-	"€", "?", "‚", "?", "„", "…", "†", "ci", /* ‡ -> ci */
-	"?", "‰", "Š", "‹", "Ś", "Ť", "Ž", "Ż",  /* Ź -> Ż */
-	"?", "‘", "’", "“", "”", "•", "–", "—",
-	"?", "™", "š", "›", "ś", "ť", "ž", "ź",
-	" ", "ˇ", "˘", "Ł", "¤", "Ą", "¦", "§",
-	"¨", "©", "Ş", "«", "¬", "­", "®", "Ż",
-	"°", "±", "˛", "ł", "´", "µ", "¶", "·",
-	"¸", "ą", "ş", "»", "Ľ", "˝", "ľ", "ż",
-	"Ŕ", "Á", "Â", "Ă", "Ä", "Ĺ", "Ć", "Ç",
-	"Č", "É", "Ę", "Ë", "Ě", "Í", "Î", "Ď",
-	"Đ", "Ń", "Ň", "Ó", "Ô", "Ő", "Ö", "×",
-	"Ř", "Ů", "Ú", "Ű", "Ü", "Ý", "Ţ", "ß",
-	"à", "á", "â", "ă", "ä", "ĺ", "ć", "ç",  /* ŕ -> à */
-	"č", "é", "ę", "ë", "ě", "í", "î", "ï",  /* č -> e, ď -> ï */
-	"đ", "ń", "ň", "ó", "ô", "ő", "ö", "÷",
-	"ř", "ů", "ú", "ű", "ü", "ý", "ţ", "˙",
-};
-
-gchar *gydp_convert_ydp(const gchar *text) {
-	gchar *buffer;
-	gsize len = 0;
-
-	/* obtain required length for buffer */
-	for(const guchar *pos = (const guchar *)text; *pos; ++pos) {
-		if( *pos < 128 )
-			len += 1;
-		else
-			len += strlen(gydp_ydp_encoding_cp1250[*pos - 128]);
-	}
-
-	/* convert text */
-	buffer = g_malloc(len + 1);
-	gydp_convert_ydp_buffer(text, FALSE, buffer);
-	return buffer;
-}
-
-void gydp_convert_ydp_buffer(const gchar *text, gboolean phonetic, gchar *buffer) {
-	const gchar **convert;
-	gsize size;
-
-	/* extract current encoding table */
-	if( phonetic ) {
-		convert = gydp_ydp_encoding_phonetic;
-		size = 128 + G_N_ELEMENTS(gydp_ydp_encoding_phonetic);
-	} else {
-		convert = gydp_ydp_encoding_cp1250;
-		size = 128 + G_N_ELEMENTS(gydp_ydp_encoding_cp1250);
-	}
-
-	/* convert characters */
-	while( TRUE ) {
-		const guchar c = *(text++);
-
-		if( c < 128 || c >= size )
-			*(buffer++) = c;
-		else {
-			switch( strlen(convert[c - 128]) ) {
-			case 1: *(buffer++) = *convert[c - 128]; break;
-			case 2: memcpy(buffer, convert[c - 128], 2); buffer += 2; break;
-			case 3: memcpy(buffer, convert[c - 128], 3); buffer += 3; break;
-			default: g_return_if_reached(); break;
-			}
-		}
-
-		/* check for terminator */
-		if( !c )
-			break;
-	}
-}
+gboolean  gydp_convert_ydp_text(const gchar *word, const gchar *text, gsize len, GydpText *output);
 
-gboolean gydp_convert_ydp_widget(const gchar *word, const gchar *text, GtkTextBuffer *widget) {
+gboolean gydp_convert_ydp_text(const gchar *word, const gchar *text, gsize len, GydpText *output) {
 
 	/* allocate and initialize context */
-	GydpYDPContext *context = gydp_ydp_context_new(word, text, widget);
+	GydpYDPContext *context = gydp_ydp_context_new(word, text, len, output);
 
 	/* parse data in context */
+	const gdouble start = gydp_stats_begin();
 	gydp_ydp_parse(context);
+	gydp_stats_end(GYDP_STATS_CONVERT_PARSE, start);
 
 	/* free context */
 	gydp_ydp_context_free(context);
@@ -202,20 +125,21 @@ void gydp_ydp_state_free(GydpYDPState *self) {
 	g_slice_free(GydpYDPState, self);
 }
 
-GydpYDPContext *gydp_ydp_context_new(const gchar *word, const gchar *text, GtkTextBuffer *widget) {
+GydpYDPContext *gydp_ydp_context_new(const gchar *word, const gchar *text, gsize len, GydpText *output) {
 	/* allocate context */
 	GydpYDPContext *self = g_malloc(sizeof(GydpYDPContext));
 
 	/* initialize input parameters */
 	self->word = word;
 	self->rtf = text;
-	self->widget = widget;
+	self->end = text + len;
+	self->output = output;
 
 	/* initalize context state */
 	self->state = g_slist_prepend(NULL, gydp_ydp_state_new());
 	self->control = g_string_sized_new(16);
 	self->text = g_string_sized_new(128);
-	self->buffer = g_string_sized_new(256);
+	gydp_text_clear(output);
 
 	return self;
 }
@@ -229,15 +153,19 @@ void gydp_ydp_context_free(GydpYDPContext *self) {
 		/* free strings */
 		g_string_free(self->control, TRUE);
 		g_string_free(self->text, TRUE);
-		g_string_free(self->buffer, TRUE);
 
 		/* free self */
 		g_free(self);
 	}
 }
 
+static gchar gydp_ydp_char(GydpYDPContext *context, const gchar *pos) {
+	/* text is not terminated, report terminator past its end */
+	return pos < context->end? *pos: '\0';
+}
+
 static void gydp_ydp_parse(GydpYDPContext *context) {
-	while( *context->rtf ) {
+	while( gydp_ydp_char(context, context->rtf) ) {
 		switch( *context->rtf ) {
 		case '{': /* begin group */
 			gydp_ydp_push_state(context);
@@ -254,11 +182,18 @@ static void gydp_ydp_parse(GydpYDPContext *context) {
 			g_string_append_c(context->text, 0x7e);      /* '~' */
 			context->rtf += 1;
 			break;
-		default:   /* other character */
-			g_string_append_c(context->text, *context->rtf);
-			context->rtf += 1;
+		default: { /* other characters, copied as whole run */
+			const gchar *pos = context->rtf + 1;
+
+			while( pos < context->end && *pos && *pos != '{' && *pos != '}' &&
+					*pos != '\\' && *pos != 0x7f )
+				++pos;
+
+			g_string_append_len(context->text, context->rtf, pos - context->rtf);
+			context->rtf = pos;
 			break;
 		}
+		}
 	};
 
 	/* commit pending global text */
@@ -273,7 +208,7 @@ static void gydp_ydp_parse_control(GydpYDPContext *context) {
 	g_string_truncate(context->control, 0);
 
 	/* check first character of control code */
-	switch( *rtf ) {
+	switch( gydp_ydp_char(context, rtf) ) {
 	case '\\': /* it was escaped character */
 	case '{':
 	case '}':
@@ -281,7 +216,7 @@ static void gydp_ydp_parse_control(GydpYDPContext *context) {
 		return;
 	default: /* read control code */
 		for(gboolean is_control = TRUE; is_control; ++rtf)
-			switch( *rtf ) {
+			switch( gydp_ydp_char(context, rtf) ) {
 			case ' ': ++rtf;                      /* omit, control code terminator */
 			case '{':                             /* control code terminator */
 			case '}':                             /* control code terminator */
@@ -431,103 +366,74 @@ static void gydp_ydp_pop_state(GydpYDPContext *context) {
 }
 
 static void gydp_ydp_commit_text(GydpYDPContext *context) {
-	GtkTextIter begin, end;
-	GtkTextMark *mark;
 	GydpYDPState *state;
+	guint32 style = GYDP_STYLE_NONE;
 
 	/* skip if no text present in context */
 	if( !context->text->len )
 		return;
 
+	const gdouble begin = gydp_stats_begin();
+
 	/* extract current code */
 	state = context->state->data;
 
 	/* convert text encoding (cp1250 or phonetic) */
-	gydp_convert_ydp_buffer(context->text->str, state->phonetic,
-			context->buffer->str);
-
-	/* get insert position and set mark */
-	gtk_text_buffer_get_end_iter(context->widget, &end);
-	mark = gtk_text_buffer_create_mark(context->widget, NULL, &end, TRUE);
-
-	/* insert text */
-	gtk_text_buffer_insert(context->widget, &end, context->buffer->str, -1);
+	const gsize start = context->output->text->len;
+	gydp_convert_append(state->phonetic? GYDP_CODEPAGE_PHONETIC: GYDP_CODEPAGE_CP1250,
+			context->output->text, context->text->str, context->text->len);
 
-	/* extract begin iter and delete mark */
-	gtk_text_buffer_get_iter_at_mark(context->widget, &begin, mark);
-	gtk_text_buffer_delete_mark(context->widget, mark);
+	/* phonetic font passes unknown characters, drop run if it is not valid */
+	if( state->phonetic && !g_utf8_validate(context->output->text->str + start,
+				context->output->text->len - start, NULL) )
+		g_string_truncate(context->output->text, start);
 
 	/*
-	 * apply styles
+	 * collect styles
 	 */
 
 	/* script */
 	switch( (GydpYDPScript)state->script ) {
-	case GYDP_YDP_SCRIPT_NORMAL:
-		gtk_text_buffer_apply_tag_by_name(context->widget,
-				GYDP_TAG_SCRIPT_NORMAL, &begin, &end);
-		break;
-	case GYDP_YDP_SCRIPT_SUPER:
-		gtk_text_buffer_apply_tag_by_name(context->widget,
-				GYDP_TAG_SCRIPT_SUPER, &begin, &end);
-		break;
-	case GYDP_YDP_SCRIPT_SUB:
-		gtk_text_buffer_apply_tag_by_name(context->widget,
-				GYDP_TAG_SCRIPT_SUB, &begin, &end);
-		break;
-	case GYDP_YDP_SCRIPT_NONE:
-		break;
+	case GYDP_YDP_SCRIPT_NORMAL: style |= GYDP_STYLE_SCRIPT_NORMAL; break;
+	case GYDP_YDP_SCRIPT_SUPER:  style |= GYDP_STYLE_SCRIPT_SUPER; break;
+	case GYDP_YDP_SCRIPT_SUB:    style |= GYDP_STYLE_SCRIPT_SUB; break;
+	case GYDP_YDP_SCRIPT_NONE:   break;
 	default:
 		g_return_if_reached();
 	}
 
 	/* bold */
 	if( state->bold )
-		gtk_text_buffer_apply_tag_by_name(context->widget,
-				GYDP_TAG_BOLD, &begin, &end);
+		style |= GYDP_STYLE_BOLD;
 
 	/* italic */
 	if( state->italic )
-		gtk_text_buffer_apply_tag_by_name(context->widget,
-				GYDP_TAG_ITALIC, &begin, &end);
+		style |= GYDP_STYLE_ITALIC;
 
 	/* align */
 	switch( (GydpYDPAlign)state->align ) {
-	case GYDP_YDP_ALIGN_CENTER:
-		gtk_text_buffer_apply_tag_by_name(context->widget,
-				GYDP_TAG_ALIGN_CENTER, &begin, &end);
-		break;
-	case GYDP_YDP_ALIGN_LEFT:
-		gtk_text_buffer_apply_tag_by_name(context->widget,
-				GYDP_TAG_ALIGN_LEFT, &begin, &end);
-		break;
-	case GYDP_YDP_ALIGN_NONE:
-		break;
+	case GYDP_YDP_ALIGN_CENTER: style |= GYDP_STYLE_ALIGN_CENTER; break;
+	case GYDP_YDP_ALIGN_LEFT:   style |= GYDP_STYLE_ALIGN_LEFT; break;
+	case GYDP_YDP_ALIGN_NONE:   break;
 	default:
 		g_return_if_reached();
 	}
 
 	/* color */
 	switch( (GydpYDPColor)state->color ) {
-	case GYDP_YDP_COLOR_RED:
-		gtk_text_buffer_apply_tag_by_name(context->widget,
-				GYDP_TAG_COLOR_RED, &begin, &end);
-		break;
-	case GYDP_YDP_COLOR_GREEN:
-		gtk_text_buffer_apply_tag_by_name(context->widget,
-				GYDP_TAG_COLOR_GREEN, &begin, &end);
-		break;
-	case GYDP_YDP_COLOR_BLUE:
-		gtk_text_buffer_apply_tag_by_name(context->widget,
-				GYDP_TAG_COLOR_BLUE, &begin, &end);
-		break;
-	case GYDP_YDP_COLOR_NONE:
-		break;
+	case GYDP_YDP_COLOR_RED:   style |= GYDP_STYLE_COLOR_RED; break;
+	case GYDP_YDP_COLOR_GREEN: style |= GYDP_STYLE_COLOR_GREEN; break;
+	case GYDP_YDP_COLOR_BLUE:  style |= GYDP_STYLE_COLOR_BLUE; break;
+	case GYDP_YDP_COLOR_NONE:  break;
 	default:
 		g_return_if_reached();
 	}
 
+	/* apply styles to converted run */
+	gydp_text_style(context->output, start, style);
+
 	/* remove commited text */
 	g_string_truncate(context->text, 0);
-}
 
+	gydp_stats_end(GYDP_STATS_CONVERT_COMMIT, begin);
+}
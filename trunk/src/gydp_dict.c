@@ -18,20 +18,145 @@
  */
 
 #include "gydp_dict.h"
+#include "gydp_index.h"
 #include "gydp_list_data.h"
 #include "gydp_conf.h"
 #include "gydp_app.h"
+#include "gydp_stats.h"
 
+#include <glib/gstdio.h>
 #include <string.h>
 
+/* entries compared by asynchronous search in one idle call */
+#define GYDP_DICT_FIND_SLICE 2048
+
+/* ranges remembered by incremental search */
+#define GYDP_DICT_NARROW_DEPTH 32
+
+/* keys starting with word (positions in sorted order) */
+typedef struct GydpDictRange {
+	gchar *word;      /* processed word */
+	guint lower;
+	guint upper;
+} GydpDictRange;
+
+/* state of linear search (resumable) */
+typedef struct GydpDictFind {
+	gchar *word;      /* processed word */
+	gint length;      /* processed word length */
+	guint n;          /* next entry to compare */
+	guint pos;        /* result */
+	gint prev;        /* common prefix length with previous entry */
+} GydpDictFind;
+
+typedef struct GydpDictSearch {
+	GydpDict *dict;
+	gchar *word;                /* word to find */
+	GydpDictFind find;          /* linear search (word is NULL until started) */
+	GCancellable *cancellable;
+	GydpDictFindFunc func;      /* result callback */
+	gpointer data;
+} GydpDictSearch;
+
+/* entry found by approximate search */
+typedef struct GydpDictMatch {
+	guint n;          /* entry */
+	gint distance;    /* edit distance to word */
+} GydpDictMatch;
+
+/* edit distance rows of approximate search (one per character of key) */
+typedef struct GydpDictFuzzy {
+	gunichar *word;   /* processed word */
+	glong length;     /* characters in word */
+	gint *rows;       /* distances of word prefixes to key prefix */
+	gsize *offset;    /* key prefix length (bytes) of every row */
+	GArray *matches;  /* best entries, closest first */
+	guint limit;      /* number of entries to find */
+	gint bound;       /* largest distance of next match */
+} GydpDictFuzzy;
+
+/* full-text index built in background */
+typedef struct GydpDictIndexBuild {
+	GydpDict *dict;             /* searched dictionary */
+	GydpDict *copy;             /* same dictionary loaded again (used only by builder) */
+	gchar **locations;          /* loader arguments of dictionary */
+	GydpLang lang;
+	guint entries;              /* number of entries to index */
+	GThread *thread;            /* builder thread */
+	GCancellable *cancellable;  /* builder cancellation */
+	GydpIndex *index;           /* result (NULL if failed or cancelled) */
+} GydpDictIndexBuild;
+
+typedef struct GydpDictText {
+	guint n;          /* entry */
+	GydpText *text;   /* rendered definition */
+} GydpDictText;
+
+struct _GydpDictKeys {
+	gchar *data;      /* folded keys (terminated, one after another) */
+	guint32 *key;     /* key offset in data for every entry */
+	guint32 *order;   /* entries sorted by folded key */
+	guint size;       /* number of entries */
+	gsize length;     /* size of data */
+	gboolean mapped;  /* data is owned by index cache or engine */
+	GydpWords *words; /* front coded keys in binary order (instead of data and key) */
+	GString *buffer;  /* key decoded from words */
+};
+
+/* parent class holder */
+static GObjectClass *gydp_dict_parent_class = NULL;
+
 /* private methods */
 static void gydp_dict_class_init          (GydpDictClass *klass);
 static void gydp_dict_list_data_iface_init(GydpListDataIface *iface);
+static void gydp_dict_dispose             (GObject *object);
+
+/* private loader functions */
+static gboolean     gydp_dict_load_stop  (GydpDict *dict);
+static gpointer     gydp_dict_load_thread(gpointer data);
+static gboolean     gydp_dict_load_notify(gpointer data);
+static gboolean     gydp_dict_load_finish(gpointer data);
+
+/* private rendered definitions cache functions */
+static gboolean     gydp_dict_text_lookup(GydpDict *dict, guint n, GydpText *text);
+static void         gydp_dict_text_insert(GydpDict *dict, guint n, GydpText *text);
+static void         gydp_dict_text_remove(GydpDict *dict, GList *link);
+static void         gydp_dict_prefetch_queue(GydpDict *dict, guint n, guint offset, guint size);
+static gboolean     gydp_dict_prefetch_idle (GydpDict *dict);
 
 /* private interface callbacks */
 static guint        gydp_dict_list_data_iface_get_items(GydpListData *list_data);
 static const gchar *gydp_dict_list_data_iface_get_item (GydpListData *list_data, guint n);
 
+/* private full-text search functions */
+static void         gydp_dict_index_clear (GydpDict *dict);
+static void         gydp_dict_index_start (GydpDict *dict);
+static gpointer     gydp_dict_index_thread(gpointer data);
+static gboolean     gydp_dict_index_finish(gpointer data);
+static void         gydp_dict_index_free  (GydpDictIndexBuild *build);
+
+/* private search functions */
+static void         gydp_dict_find_init(GydpDictFind *find, gchar *word);
+static gboolean     gydp_dict_find_scan(GydpDict *dict, GydpDictFind *find, guint count);
+static gboolean     gydp_dict_find_idle(GydpDictSearch *search);
+static void         gydp_dict_find_done(GydpDictSearch *search, gboolean result, guint n);
+
+/* private approximate search functions */
+static void         gydp_dict_fuzzy_init (GydpDictFuzzy *fuzzy, const gchar *word, guint distance, guint limit);
+static GArray      *gydp_dict_fuzzy_done (GydpDictFuzzy *fuzzy);
+static gint         gydp_dict_fuzzy_row  (GydpDictFuzzy *fuzzy, guint depth, gunichar c);
+static void         gydp_dict_fuzzy_match(GydpDictFuzzy *fuzzy, guint n, gint distance);
+
+/* private key functions */
+static gint         gydp_dict_keys_compare(gconstpointer a, gconstpointer b, gpointer data);
+static guint        gydp_dict_keys_prefix (const gchar *key, const gchar *word);
+static guint        gydp_dict_keys_lower  (GydpDictKeys *self, const gchar *word, guint lower, guint upper);
+static guint        gydp_dict_keys_upper  (GydpDictKeys *self, const gchar *word, gsize length,
+                                           guint lower, guint upper);
+static guint        gydp_dict_keys_nearest(GydpDictKeys *self, const gchar *word, guint lower);
+static guint        gydp_dict_keys_narrow (GydpDict *dict, GydpDictKeys *self, const gchar *word);
+static void         gydp_dict_keys_narrow_clear(GydpDict *dict);
+
 GType gydp_dict_get_type() {
 	static GType type = G_TYPE_INVALID;
 	if( G_UNLIKELY( type == G_TYPE_INVALID ) ) {
@@ -60,14 +185,24 @@ GType gydp_dict_get_type() {
 }
 
 static void gydp_dict_class_init(GydpDictClass *klass) {
+	/* determine parent class */
+	gydp_dict_parent_class = g_type_class_peek_parent(klass);
+
+	GObjectClass *gobject_klass = G_OBJECT_CLASS(klass);
+	gobject_klass->dispose = gydp_dict_dispose;
+
 	/* all methods are pure virtual */
 	klass->load = NULL;
 	klass->lang = NULL;
+	klass->configure = NULL;
 
 	klass->size = NULL;
 	klass->word = NULL;
 	klass->text = NULL;
 	klass->find = NULL;
+	klass->fuzzy = NULL;
+	klass->keys = NULL;
+	klass->memory = NULL;
 }
 
 static void gydp_dict_list_data_iface_init(GydpListDataIface *iface) {
@@ -75,14 +210,48 @@ static void gydp_dict_list_data_iface_init(GydpListDataIface *iface) {
 	iface->get_items = gydp_dict_list_data_iface_get_items;
 }
 
+static void gydp_dict_dispose(GObject *object) {
+	/* loader has to finish before engine releases its data */
+	gydp_dict_load_stop(GYDP_DICT(object));
+
+	/* release cached definitions */
+	GydpDict *dict = GYDP_DICT(object);
+	gydp_dict_text_flush(dict);
+	if( dict->texts != NULL ) {
+		g_hash_table_destroy(dict->texts);
+		g_queue_free(dict->texts_used);
+		dict->texts = NULL;
+		dict->texts_used = NULL;
+	}
+	if( dict->prefetch_queue != NULL ) {
+		g_array_free(dict->prefetch_queue, TRUE);
+		gydp_text_free(dict->prefetch_text);
+		dict->prefetch_queue = NULL;
+		dict->prefetch_text = NULL;
+	}
+
+	/* release full-text index */
+	gydp_dict_index_clear(dict);
+	g_strfreev(dict->locations);
+	dict->locations = NULL;
+
+	/* release incremental search ranges */
+	gydp_dict_keys_narrow_clear(dict);
+	if( dict->narrow != NULL ) {
+		g_array_free(dict->narrow, TRUE);
+		dict->narrow = NULL;
+	}
+
+	/* chain to parent dispose */
+	gydp_dict_parent_class->dispose(object);
+}
+
 static guint gydp_dict_list_data_iface_get_items(GydpListData *list_data) {
-	GydpDict *dict = GYDP_DICT(list_data);
-	return GYDP_DICT_GET_CLASS(dict)->size(dict);
+	return gydp_dict_size(GYDP_DICT(list_data));
 }
 
 static const gchar *gydp_dict_list_data_iface_get_item(GydpListData *list_data, guint n) {
-	GydpDict *dict = GYDP_DICT(list_data);
-	return GYDP_DICT_GET_CLASS(dict)->word(dict, n);
+	return gydp_dict_word(GYDP_DICT(list_data), n);
 }
 
 void gydp_dict_changed(GydpDict *dict) {
@@ -90,27 +259,571 @@ void gydp_dict_changed(GydpDict *dict) {
 }
 
 gboolean gydp_dict_load(GydpDict *dict, gchar **locations, GydpLang lang) {
-	return GYDP_DICT_GET_CLASS(dict)->load(dict, locations, lang);
+	gboolean result;
+
+	/* stop asynchronous load */
+	gydp_dict_load_cancel(dict);
+	gydp_dict_text_flush(dict);
+	gydp_dict_keys_narrow_clear(dict);
+	gydp_dict_index_clear(dict);
+	gydp_dict_configure(dict);
+
+	/* keep arguments for index builder (locations may be loader ones) */
+	gchar **copy = g_strdupv(locations);
+	g_strfreev(dict->locations);
+	dict->locations = copy;
+	dict->lang = lang;
+
+	/* load dictionary */
+	const gdouble start = gydp_stats_begin();
+	result = GYDP_DICT_GET_CLASS(dict)->load(dict, dict->locations, lang);
+	gydp_stats_end(GYDP_STATS_DICT_LOAD, start);
+
+	/* indicate that dictionary changed */
+	gydp_dict_changed(dict);
+
+	return result;
+}
+
+/** gydp_dict_load_async
+ * load dictionary in separate thread, engine publishes loaded words with
+ * gydp_dict_progress and "changed" is emitted in main loop for each chunk,
+ * words can be accessed only through public functions during load
+ */
+void gydp_dict_load_async(GydpDict *dict, gchar **locations, GydpLang lang,
+		GydpDictLoadFunc func, gpointer data) {
+	GError *error = NULL;
+
+	/* stop previous load */
+	gydp_dict_load_cancel(dict);
+	gydp_dict_text_flush(dict);
+	gydp_dict_keys_narrow_clear(dict);
+	gydp_dict_index_clear(dict);
+	gydp_dict_configure(dict);
+
+	/* prepare loader (locations may be previous loader ones) */
+	gchar **copy = g_strdupv(locations);
+	g_strfreev(dict->locations);
+	dict->locations = copy;
+	dict->lang = lang;
+	dict->func = func;
+	dict->data = data;
+	dict->cancellable = g_cancellable_new();
+	g_atomic_int_set(&dict->loaded, 0);
+	g_atomic_int_set(&dict->notify, 0);
+
+	/* start loader */
+	if( (dict->thread = g_thread_create(gydp_dict_load_thread, dict, TRUE, &error)) != NULL ) {
+		/* dictionary is empty until first words are published */
+		gydp_dict_changed(dict);
+		return;
+	}
+
+	g_printerr("Error starting dictionary loader: %s\n", error->message);
+	g_error_free(error);
+
+	/* fallback to synchronous load */
+	g_object_unref(dict->cancellable);
+	dict->cancellable = NULL;
+
+	const gboolean result = gydp_dict_load(dict, locations, lang);
+	if( func )
+		func(dict, result, data);
+}
+
+void gydp_dict_load_cancel(GydpDict *dict) {
+	/* indicate that dictionary changed (partial load is released) */
+	if( gydp_dict_load_stop(dict) )
+		gydp_dict_changed(dict);
+}
+
+gboolean gydp_dict_loading(GydpDict *dict) {
+	return dict->thread != NULL;
+}
+
+static gboolean gydp_dict_load_stop(GydpDict *dict) {
+	/* prefetch works on loaded words */
+	gydp_dict_prefetch_stop(dict);
+
+	if( dict->thread == NULL )
+		return FALSE;
+
+	/* wait for loader to stop */
+	g_cancellable_cancel(dict->cancellable);
+	g_thread_join(dict->thread);
+	dict->thread = NULL;
+
+	/* drop pending notifications */
+	while( g_source_remove_by_user_data(dict) )
+		;
+
+	/* free loader data */
+	g_object_unref(dict->cancellable);
+	dict->cancellable = NULL;
+
+	return TRUE;
+}
+
+/** gydp_dict_progress
+ * publish first words loaded by engine (called by loader thread), returns
+ * FALSE if load was cancelled
+ */
+gboolean gydp_dict_progress(GydpDict *dict, guint words) {
+	/* synchronous load */
+	if( dict->cancellable == NULL )
+		return TRUE;
+
+	/* publish words and notify main loop (once per pending notification) */
+	g_atomic_int_set(&dict->loaded, words);
+	if( g_atomic_int_compare_and_exchange(&dict->notify, 0, 1) )
+		g_idle_add(gydp_dict_load_notify, dict);
+
+	return !g_cancellable_is_cancelled(dict->cancellable);
+}
+
+void gydp_dict_set_sources(GydpDict *dict, const gchar *const *sources) {
+	g_strfreev(dict->sources);
+	dict->sources = g_strdupv((gchar **)sources);
+}
+
+const gchar *const *gydp_dict_sources(GydpDict *dict) {
+	return (const gchar *const *)dict->sources;
+}
+
+/** gydp_dict_memory
+ * mapped dictionary files are counted whole, search keys, full-text index
+ * and cached definitions by their size and rest by engine
+ */
+gsize gydp_dict_memory(GydpDict *dict) {
+	GydpDictClass *klass = GYDP_DICT_GET_CLASS(dict);
+	gsize result = dict->texts_size;
+	struct stat info;
+
+	for(gchar **source = dict->sources; source != NULL && *source != NULL; ++source)
+		if( g_stat(*source, &info) == 0 )
+			result += info.st_size;
+
+	if( klass->keys != NULL )
+		result += gydp_dict_keys_memory(klass->keys(dict));
+	if( klass->memory != NULL )
+		result += klass->memory(dict);
+	if( dict->index != NULL )
+		result += gydp_index_memory(dict->index);
+
+	return result;
+}
+
+gboolean gydp_dict_cancelled(GydpDict *dict) {
+	return dict->cancellable != NULL && g_cancellable_is_cancelled(dict->cancellable);
+}
+
+static gpointer gydp_dict_load_thread(gpointer data) {
+	GydpDict *dict = GYDP_DICT(data);
+
+	/* load dictionary and report in main loop */
+	const gdouble start = gydp_stats_begin();
+	dict->result = GYDP_DICT_GET_CLASS(dict)->load(dict, dict->locations, dict->lang);
+	gydp_stats_end(GYDP_STATS_DICT_LOAD, start);
+	g_idle_add(gydp_dict_load_finish, dict);
+
+	return NULL;
+}
+
+static gboolean gydp_dict_load_notify(gpointer data) {
+	GydpDict *dict = GYDP_DICT(data);
+
+	/* allow next notification before emitting */
+	g_atomic_int_set(&dict->notify, 0);
+	gydp_dict_changed(dict);
+
+	return FALSE;
+}
+
+static gboolean gydp_dict_load_finish(gpointer data) {
+	GydpDict *dict = GYDP_DICT(data);
+
+	/* loader already finished */
+	g_thread_join(dict->thread);
+	dict->thread = NULL;
+
+	/* free loader data */
+	g_object_unref(dict->cancellable);
+	dict->cancellable = NULL;
+
+	/* all words are available */
+	gydp_dict_changed(dict);
+	if( dict->func )
+		dict->func(dict, dict->result, dict->data);
+
+	return FALSE;
 }
 
 gboolean gydp_dict_lang(GydpDict *dict, GydpLang lang) {
 	return GYDP_DICT_GET_CLASS(dict)->lang(dict, lang);
 }
 
+void gydp_dict_configure(GydpDict *dict) {
+	GydpConf *config = g_object_get_data(G_OBJECT(gydp_app()), GYDP_APP_CONF);
+	GydpDictClass *klass = GYDP_DICT_GET_CLASS(dict);
+
+	/* rendered definitions cache size */
+	dict->texts_limit = MAX(gydp_conf_get_integer(config, "general", "texts"), 0) * 1024;
+
+	/* engine settings */
+	if( klass->configure )
+		klass->configure(dict);
+}
+
 guint gydp_dict_size(GydpDict *dict) {
-	return GYDP_DICT_GET_CLASS(dict)->size(dict);
+	const guint size = GYDP_DICT_GET_CLASS(dict)->size(dict);
+
+	/* only published words are available during load */
+	if( dict->thread != NULL )
+		return MIN(size, (guint)g_atomic_int_get(&dict->loaded));
+	return size;
 }
 
 const gchar *gydp_dict_word(GydpDict *dict, guint n) {
+	if( n >= gydp_dict_size(dict) )
+		return NULL;
 	return GYDP_DICT_GET_CLASS(dict)->word(dict, n);
 }
 
-gboolean gydp_dict_text(GydpDict *dict, guint n, GtkTextBuffer *buffer) {
-	return GYDP_DICT_GET_CLASS(dict)->text(dict, n, buffer);
+gboolean gydp_dict_text(GydpDict *dict, guint n, GydpText *text) {
+	if( n >= gydp_dict_size(dict) ) {
+		gydp_text_clear(text);
+		return FALSE;
+	}
+
+	const gdouble start = gydp_stats_begin();
+	gboolean result = TRUE;
+
+	/* recently rendered definition, otherwise rendered one is kept */
+	if( !gydp_dict_text_lookup(dict, n, text) &&
+			(result = GYDP_DICT_GET_CLASS(dict)->text(dict, n, text)) )
+		gydp_dict_text_insert(dict, n, text);
+
+	gydp_stats_end(GYDP_STATS_DICT_TEXT, start);
+	return result;
+}
+
+GArray *gydp_dict_search(GydpDict *dict, const gchar *query, guint limit) {
+	/* index reads all definitions */
+	if( gydp_dict_loading(dict) )
+		return NULL;
+
+	/* index is restored from cache, otherwise it is built in background */
+	if( dict->index == NULL && dict->index_build == NULL && !dict->index_failed &&
+			(dict->index = gydp_index_open(dict)) == NULL )
+		gydp_dict_index_start(dict);
+
+	if( gydp_dict_indexing(dict) )
+		return NULL;
+
+	/* nothing is found in dictionary that can not be indexed */
+	if( dict->index == NULL )
+		return g_array_new(FALSE, FALSE, sizeof(guint));
+
+	return gydp_index_query(dict->index, query, limit);
+}
+
+gboolean gydp_dict_indexing(GydpDict *dict) {
+	return dict->index_build != NULL;
+}
+
+/** gydp_dict_index_start
+ * builder renders definitions with its own instance of engine loaded from
+ * same locations, so it never touches data used by main loop (engines
+ * decode words and pages on demand), main loop is notified when it is done
+ */
+static void gydp_dict_index_start(GydpDict *dict) {
+	GydpDictIndexBuild *build;
+	GError *error = NULL;
+
+	/* dictionary is not loaded */
+	if( dict->language == GYDP_LANG_NONE ) {
+		dict->index_failed = TRUE;
+		return;
+	}
+
+	build = g_slice_new0(GydpDictIndexBuild);
+	build->dict = dict;
+	build->copy = g_object_new(G_OBJECT_TYPE(dict), NULL);
+	build->locations = g_strdupv(dict->locations);
+	build->lang = dict->language;
+	build->entries = gydp_dict_size(dict);
+	build->cancellable = g_cancellable_new();
+
+	/* settings are read here, engine load is cancelled with builder */
+	gydp_dict_configure(build->copy);
+	build->copy->cancellable = g_object_ref(build->cancellable);
+
+	if( (build->thread = g_thread_create(gydp_dict_index_thread, build, TRUE, &error)) != NULL ) {
+		dict->index_build = build;
+		return;
+	}
+
+	g_printerr("Error starting index builder: %s\n", error->message);
+	g_error_free(error);
+	gydp_dict_index_free(build);
+
+	/* fallback to synchronous build */
+	dict->index = gydp_index_new(dict, NULL);
+}
+
+static gpointer gydp_dict_index_thread(gpointer data) {
+	GydpDictIndexBuild *build = data;
+	GydpDict *copy = build->copy;
+
+	/* entries of both dictionaries have to match */
+	if( GYDP_DICT_GET_CLASS(copy)->load(copy, build->locations, build->lang) &&
+			GYDP_DICT_GET_CLASS(copy)->size(copy) == build->entries )
+		build->index = gydp_index_new(copy, build->cancellable);
+
+	g_idle_add(gydp_dict_index_finish, build);
+	return NULL;
+}
+
+static gboolean gydp_dict_index_finish(gpointer data) {
+	GydpDictIndexBuild *build = data;
+	GydpDict *dict = build->dict;
+
+	/* builder already finished */
+	g_thread_join(build->thread);
+
+	dict->index = build->index;
+	dict->index_failed = build->index == NULL;
+	dict->index_build = NULL;
+	build->index = NULL;
+	gydp_dict_index_free(build);
+
+	if( dict->index_failed )
+		g_printerr("Error building full-text index\n");
+
+	/* pending search is repeated */
+	gydp_dict_changed(dict);
+
+	return FALSE;
+}
+
+static void gydp_dict_index_free(GydpDictIndexBuild *build) {
+	/* drop load notifications of engine used by builder */
+	while( g_source_remove_by_user_data(build->copy) )
+		;
+
+	g_object_unref(build->copy->cancellable);
+	build->copy->cancellable = NULL;
+	g_object_unref(build->copy);
+	g_object_unref(build->cancellable);
+	g_strfreev(build->locations);
+	gydp_index_free(build->index);
+
+	g_slice_free(GydpDictIndexBuild, build);
+}
+
+static void gydp_dict_index_clear(GydpDict *dict) {
+	GydpDictIndexBuild *build = dict->index_build;
+
+	/* wait for builder to stop and drop its result */
+	if( build != NULL ) {
+		g_cancellable_cancel(build->cancellable);
+		g_thread_join(build->thread);
+		while( g_source_remove_by_user_data(build) )
+			;
+		gydp_dict_index_free(build);
+		dict->index_build = NULL;
+	}
+
+	gydp_index_free(dict->index);
+	dict->index = NULL;
+	dict->index_failed = FALSE;
+
+	g_strfreev(dict->sources);
+	dict->sources = NULL;
+}
+
+void gydp_dict_text_flush(GydpDict *dict) {
+	if( dict->texts == NULL )
+		return;
+
+	while( !g_queue_is_empty(dict->texts_used) )
+		gydp_dict_text_remove(dict, dict->texts_used->tail);
+}
+
+void gydp_dict_text_stats(GydpDict *dict, guint *hits, guint *misses, gsize *size) {
+	if( hits )
+		*hits = dict->texts_hits;
+	if( misses )
+		*misses = dict->texts_misses;
+	if( size )
+		*size = dict->texts_size;
+}
+
+/** gydp_dict_prefetch
+ * queue neighbours of entry (closest first, both sides) and render
+ * them into definitions cache one per low priority idle call, previous
+ * prefetch is replaced
+ */
+void gydp_dict_prefetch(GydpDict *dict, guint n, guint count, guint page) {
+	const guint size = gydp_dict_size(dict);
+
+	gydp_dict_prefetch_stop(dict);
+
+	/* nothing to keep rendered definitions in */
+	if( n >= size || dict->texts == NULL || dict->texts_limit == 0 )
+		return;
+
+	if( dict->prefetch_queue == NULL ) {
+		dict->prefetch_queue = g_array_new(FALSE, FALSE, sizeof(guint));
+		dict->prefetch_text = gydp_text_new();
+	}
+
+	g_array_set_size(dict->prefetch_queue, 0);
+	dict->prefetch_pos = 0;
+
+	/* closest neighbours first */
+	for(guint offset = 1; offset <= count; ++offset)
+		gydp_dict_prefetch_queue(dict, n, offset, size);
+
+	/* entries one page away */
+	if( page > count )
+		gydp_dict_prefetch_queue(dict, n, page, size);
+
+	if( dict->prefetch_queue->len )
+		dict->prefetch = g_idle_add_full(G_PRIORITY_LOW, (GSourceFunc)gydp_dict_prefetch_idle, dict, NULL);
+}
+
+static void gydp_dict_prefetch_queue(GydpDict *dict, guint n, guint offset, guint size) {
+	guint entry;
+
+	if( offset < size - n ) {
+		entry = n + offset;
+		g_array_append_val(dict->prefetch_queue, entry);
+	}
+	if( offset <= n ) {
+		entry = n - offset;
+		g_array_append_val(dict->prefetch_queue, entry);
+	}
+}
+
+void gydp_dict_prefetch_stop(GydpDict *dict) {
+	if( dict->prefetch ) {
+		g_source_remove(dict->prefetch);
+		dict->prefetch = 0;
+	}
+}
+
+static gboolean gydp_dict_prefetch_idle(GydpDict *dict) {
+	/* render first entry which is not cached yet */
+	while( dict->prefetch_pos < dict->prefetch_queue->len ) {
+		const guint n = g_array_index(dict->prefetch_queue, guint, dict->prefetch_pos++);
+
+		if( n >= gydp_dict_size(dict) ||
+				g_hash_table_lookup(dict->texts, GUINT_TO_POINTER(n)) != NULL )
+			continue;
+
+		if( GYDP_DICT_GET_CLASS(dict)->text(dict, n, dict->prefetch_text) )
+			gydp_dict_text_insert(dict, n, dict->prefetch_text);
+		break;
+	}
+
+	/* keep running until queue is done */
+	if( dict->prefetch_pos < dict->prefetch_queue->len )
+		return TRUE;
+
+	dict->prefetch = 0;
+	return FALSE;
+}
+
+static gboolean gydp_dict_text_lookup(GydpDict *dict, guint n, GydpText *text) {
+	GList *link;
+
+	/* cache is created with first lookup (limit is read by configure) */
+	if( dict->texts == NULL ) {
+		dict->texts = g_hash_table_new(g_direct_hash, g_direct_equal);
+		dict->texts_used = g_queue_new();
+	}
+
+	if( (link = g_hash_table_lookup(dict->texts, GUINT_TO_POINTER(n))) == NULL ) {
+		dict->texts_misses += 1;
+		return FALSE;
+	}
+
+	/* mark as recently used */
+	g_queue_unlink(dict->texts_used, link);
+	g_queue_push_head_link(dict->texts_used, link);
+
+	gydp_text_copy(text, ((GydpDictText *)link->data)->text);
+	dict->texts_hits += 1;
+
+	return TRUE;
+}
+
+static void gydp_dict_text_insert(GydpDict *dict, guint n, GydpText *text) {
+	/* definitions larger than whole cache are not kept */
+	if( gydp_text_size(text) > dict->texts_limit )
+		return;
+
+	GydpDictText *entry = g_slice_new(GydpDictText);
+	entry->n = n;
+	entry->text = gydp_text_new();
+	gydp_text_copy(entry->text, text);
+
+	/* evict least recently used definitions */
+	const gsize size = gydp_text_size(entry->text);
+	while( !g_queue_is_empty(dict->texts_used) && dict->texts_size + size > dict->texts_limit )
+		gydp_dict_text_remove(dict, dict->texts_used->tail);
+
+	g_queue_push_head(dict->texts_used, entry);
+	g_hash_table_insert(dict->texts, GUINT_TO_POINTER(n), dict->texts_used->head);
+	dict->texts_size += size;
+}
+
+static void gydp_dict_text_remove(GydpDict *dict, GList *link) {
+	GydpDictText *entry = link->data;
+
+	g_hash_table_remove(dict->texts, GUINT_TO_POINTER(entry->n));
+	g_queue_delete_link(dict->texts_used, link);
+	dict->texts_size -= gydp_text_size(entry->text);
+
+	gydp_text_free(entry->text);
+	g_slice_free(GydpDictText, entry);
 }
 
 guint gydp_dict_find(GydpDict *dict, const gchar *word) {
-	return GYDP_DICT_GET_CLASS(dict)->find(dict, word);
+	const gdouble start = gydp_stats_begin();
+	guint result;
+
+	/* only published words can be searched during load */
+	if( dict->thread != NULL )
+		result = gydp_dict_find_f(dict, word);
+	else
+		result = GYDP_DICT_GET_CLASS(dict)->find(dict, word);
+
+	gydp_stats_end(GYDP_STATS_DICT_FIND, start);
+	return result;
+}
+
+GArray *gydp_dict_fuzzy(GydpDict *dict, const gchar *word, guint distance, guint limit) {
+	/* keys are built when dictionary is loaded */
+	if( gydp_dict_loading(dict) )
+		return NULL;
+	return GYDP_DICT_GET_CLASS(dict)->fuzzy(dict, word, distance, limit);
+}
+
+/** gydp_dict_fuzzy_quick
+ * engines with own approximate search use their keys, default one
+ * compares all words of engines without keys
+ */
+gboolean gydp_dict_fuzzy_quick(GydpDict *dict) {
+	GydpDictClass *klass = GYDP_DICT_GET_CLASS(dict);
+
+	if( gydp_dict_loading(dict) )
+		return FALSE;
+	if( klass->fuzzy != gydp_dict_fuzzy_f )
+		return TRUE;
+
+	return klass->keys != NULL && klass->keys(dict) != NULL;
 }
 
 gchar *gydp_str_process(const gchar *str) {
@@ -143,52 +856,608 @@ gchar *gydp_str_process(const gchar *str) {
 
 guint gydp_dict_find_f(GydpDict *dict, const gchar *word) {
   GydpDictClass *klass = GYDP_DICT_GET_CLASS(dict);
-	gint length, i = 0, prev = 0;
-	guint pos = 0, size, n;
-	gchar *find;
+	GydpDictKeys *keys = klass->keys && dict->thread == NULL? klass->keys(dict): NULL;
+	GydpDictFind find;
+	guint pos;
 
   /* validate size */
-	if( (size = klass->size(dict)) == 0 )
+	if( gydp_dict_size(dict) == 0 )
 		return 0;
 
-	/* process word for comprison */
-	word = gydp_str_process(word);
-	length = strlen(word);
+	/* use precomputed keys if engine provides them */
+	if( keys != NULL ) {
+		gchar *processed = gydp_str_process(word);
+		pos = gydp_dict_keys_narrow(dict, keys, processed);
+		g_free(processed);
+		return pos;
+	}
+
+	/* compare all entries at once */
+	gydp_dict_find_init(&find, gydp_str_process(word));
+	gydp_dict_find_scan(dict, &find, G_MAXUINT);
+	g_free(find.word);
+
+	return find.pos;
+}
+
+/** gydp_dict_fuzzy_f
+ * approximate search over precomputed keys, engines without keys
+ * have all words compared
+ */
+GArray *gydp_dict_fuzzy_f(GydpDict *dict, const gchar *word, guint distance, guint limit) {
+	GydpDictClass *klass = GYDP_DICT_GET_CLASS(dict);
+	GydpDictKeys *keys = klass->keys? klass->keys(dict): NULL;
+	gchar *processed = gydp_str_process(word);
+	GydpDictFuzzy fuzzy;
+
+	/* use precomputed keys if engine provides them */
+	if( keys != NULL ) {
+		GArray *result = gydp_dict_keys_fuzzy(keys, processed, distance, limit);
+		g_free(processed);
+
+		/* sorted positions to entries */
+		for(guint i = 0; i < result->len; ++i)
+			g_array_index(result, guint, i) = gydp_dict_keys_entry(keys, g_array_index(result, guint, i));
+		return result;
+	}
+
+	gydp_dict_fuzzy_init(&fuzzy, processed, distance, limit);
+	g_free(processed);
+
+	const guint size = gydp_dict_size(dict);
+	for(guint n = 0; n < size && fuzzy.length && fuzzy.bound >= 0; ++n) {
+		gchar *key = gydp_str_process(klass->word(dict, n));
+		const gchar *pos = key;
+		guint depth = 0;
+
+		/* stop when no extension of key is close enough */
+		while( *pos && gydp_dict_fuzzy_row(&fuzzy, depth, g_utf8_get_char(pos)) <= fuzzy.bound ) {
+			pos = g_utf8_next_char(pos);
+			++depth;
+		}
+
+		if( *pos == '\0' )
+			gydp_dict_fuzzy_match(&fuzzy, n, fuzzy.rows[(depth + 1) * (fuzzy.length + 1) - 1]);
+
+		/* free temporary data */
+		g_free(key);
+	}
+
+	return gydp_dict_fuzzy_done(&fuzzy);
+}
+
+static void gydp_dict_fuzzy_init(GydpDictFuzzy *fuzzy, const gchar *word, guint distance, guint limit) {
+	fuzzy->word = g_utf8_to_ucs4_fast(word, -1, &fuzzy->length);
+	fuzzy->matches = g_array_sized_new(FALSE, FALSE, sizeof(GydpDictMatch), MIN(limit, 64));
+	fuzzy->limit = limit;
+	fuzzy->bound = limit? (gint)distance: -1;
+
+	/* rows of keys longer than word by more than distance are never used */
+	const gsize rows = fuzzy->length + distance + 2;
+	fuzzy->rows = g_new(gint, rows * (fuzzy->length + 1));
+	fuzzy->offset = g_new(gsize, rows);
+
+	/* distances to empty key prefix */
+	for(glong j = 0; j <= fuzzy->length; ++j)
+		fuzzy->rows[j] = j;
+	fuzzy->offset[0] = 0;
+}
+
+static GArray *gydp_dict_fuzzy_done(GydpDictFuzzy *fuzzy) {
+	GArray *result = g_array_sized_new(FALSE, FALSE, sizeof(guint), fuzzy->matches->len);
+
+	for(guint i = 0; i < fuzzy->matches->len; ++i)
+		g_array_append_val(result, g_array_index(fuzzy->matches, GydpDictMatch, i).n);
+
+	g_array_free(fuzzy->matches, TRUE);
+	g_free(fuzzy->offset);
+	g_free(fuzzy->rows);
+	g_free(fuzzy->word);
+
+	return result;
+}
+
+/** gydp_dict_fuzzy_row
+ * compute row after depth characters of key extended by c, returns
+ * smallest distance in row (lower bound for all keys with this prefix)
+ */
+static gint gydp_dict_fuzzy_row(GydpDictFuzzy *fuzzy, guint depth, gunichar c) {
+	gint *row = fuzzy->rows + depth * (fuzzy->length + 1);
+	gint *next = row + fuzzy->length + 1;
+	gint best;
+
+	best = next[0] = depth + 1;
+	for(glong j = 1; j <= fuzzy->length; ++j) {
+		gint value = row[j - 1] + (fuzzy->word[j - 1] != c);
+		value = MIN(value, row[j] + 1);
+		value = MIN(value, next[j - 1] + 1);
+
+		next[j] = value;
+		best = MIN(best, value);
+	}
+
+	return best;
+}
+
+/** gydp_dict_fuzzy_match
+ * keep limit closest entries, entries found earlier go first on equal
+ * distance, bound is lowered when list is full
+ */
+static void gydp_dict_fuzzy_match(GydpDictFuzzy *fuzzy, guint n, gint distance) {
+	GArray *matches = fuzzy->matches;
+	GydpDictMatch match = { n, distance };
+	guint i = matches->len;
+
+	if( distance > fuzzy->bound )
+		return;
+
+	while( i > 0 && g_array_index(matches, GydpDictMatch, i - 1).distance > distance )
+		--i;
+	g_array_insert_val(matches, i, match);
+
+	/* only closer entries can replace worst one */
+	if( matches->len >= fuzzy->limit ) {
+		g_array_set_size(matches, fuzzy->limit);
+		fuzzy->bound = g_array_index(matches, GydpDictMatch, fuzzy->limit - 1).distance - 1;
+	}
+}
+
+void gydp_dict_find_async(GydpDict *dict, const gchar *word, GCancellable *cancellable,
+		GydpDictFindFunc func, gpointer data) {
+	GydpDictSearch *search = g_slice_new0(GydpDictSearch);
+
+	search->dict = g_object_ref(dict);
+	search->word = g_strdup(word);
+	search->cancellable = cancellable? g_object_ref(cancellable): NULL;
+	search->func = func;
+	search->data = data;
+
+	/* pending events go first, searches superseded meanwhile are dropped */
+	g_idle_add_full(G_PRIORITY_DEFAULT_IDLE, (GSourceFunc)gydp_dict_find_idle, search, NULL);
+}
+
+static void gydp_dict_find_init(GydpDictFind *find, gchar *word) {
+	find->word = word;
+	find->length = strlen(word);
+	find->n = 0;
+	find->pos = 0;
+	find->prev = 0;
+}
+
+/** gydp_dict_find_scan
+ * linear search over at most count entries, returns TRUE when result is
+ * known, words published in meantime are included in next call
+ */
+static gboolean gydp_dict_find_scan(GydpDict *dict, GydpDictFind *find, guint count) {
+	GydpDictClass *klass = GYDP_DICT_GET_CLASS(dict);
+	const guint size = gydp_dict_size(dict);
+	gint i = 0;
 
 	/* check for string length */
-	if( length == 0 ) {
-		g_free((gchar *)word);
-		return pos;
+	if( find->length == 0 || size == 0 ) {
+		find->pos = 0;
+		return TRUE;
 	}
 
-	for(n = 0; n < size; ++n, prev = i) {
+	for(; find->n < size && count > 0; ++find->n, --count, find->prev = i) {
 		/* get word */
-		find = gydp_str_process(klass->word(dict, n));
+		gchar *key = gydp_str_process(klass->word(dict, find->n));
 
 		/* compare */
-		for(i = 0; i < length; ++i)
-			if( word[i] != find[i] )
+		for(i = 0; i < find->length; ++i)
+			if( find->word[i] != key[i] )
 				break;
 
 		/* free temporart data */
-		g_free(find);
+		g_free(key);
 
 		/* completely compatible item found */
-		if( i == length ) {
-			pos = n;
-			break;
+		if( i == find->length ) {
+			find->pos = find->n;
+			return TRUE;
 		}
 
 		/* previous item is more compatible */
-		if( i < prev ) {
-			pos = n - 1;
+		if( i < find->prev ) {
+			find->pos = find->n - 1;
+			return TRUE;
+		}
+	}
+
+	/* last entry is best one */
+	if( find->n >= size ) {
+		find->pos = size - 1;
+		return TRUE;
+	}
+
+	return FALSE;
+}
+
+static gboolean gydp_dict_find_idle(GydpDictSearch *search) {
+	GydpDict *dict = search->dict;
+
+	/* superseded search */
+	if( search->cancellable && g_cancellable_is_cancelled(search->cancellable) ) {
+		gydp_dict_find_done(search, FALSE, 0);
+		return FALSE;
+	}
+
+	if( search->find.word == NULL ) {
+		/* engine search is fast unless dictionary is loading */
+		if( !gydp_dict_loading(dict) ) {
+			gydp_dict_find_done(search, TRUE, gydp_dict_find(dict, search->word));
+			return FALSE;
+		}
+
+		gydp_dict_find_init(&search->find, gydp_str_process(search->word));
+	}
+
+	/* continue in next idle call */
+	if( !gydp_dict_find_scan(dict, &search->find, GYDP_DICT_FIND_SLICE) )
+		return TRUE;
+
+	gydp_dict_find_done(search, TRUE, search->find.pos);
+	return FALSE;
+}
+
+static void gydp_dict_find_done(GydpDictSearch *search, gboolean result, guint n) {
+	if( result && search->func )
+		search->func(search->dict, n, search->data);
+
+	g_object_unref(search->dict);
+	if( search->cancellable )
+		g_object_unref(search->cancellable);
+	g_free(search->find.word);
+	g_free(search->word);
+	g_slice_free(GydpDictSearch, search);
+}
+
+GydpDictKeys *gydp_dict_keys_new(GydpDict *dict) {
+	GydpDictClass *klass = GYDP_DICT_GET_CLASS(dict);
+	GydpDictKeys *self = g_slice_new(GydpDictKeys);
+
+	/* allocate data */
+	self->size = klass->size(dict);
+	self->key = g_malloc(self->size * sizeof(guint32));
+	self->order = g_malloc(self->size * sizeof(guint32));
+	self->mapped = FALSE;
+	self->words = NULL;
+	self->buffer = NULL;
+
+	/* process all words, keys are stored in single block */
+	GString *data = g_string_sized_new(self->size * 8);
+	for(guint n = 0; n < self->size; ++n) {
+		gchar *key = gydp_str_process(klass->word(dict, n));
+
+		/* append key with terminator */
+		self->key[n] = data->len;
+		g_string_append_len(data, key, strlen(key) + 1);
+		self->order[n] = n;
+
+		/* free temporary data */
+		g_free(key);
+	}
+	self->length = data->len;
+	self->data = g_string_free(data, FALSE);
+
+	/* sort entries by key (dictionary order is not binary order) */
+	g_qsort_with_data(self->order, self->size, sizeof(guint32),
+			gydp_dict_keys_compare, self);
+
+	return self;
+}
+
+/** gydp_dict_keys_wrap
+ * use front coded keys of engine in binary order and entry of every one,
+ * both stay owned by engine
+ */
+GydpDictKeys *gydp_dict_keys_wrap(GydpWords *words, const guint32 *order) {
+	GydpDictKeys *self = g_slice_new0(GydpDictKeys);
+
+	self->order = (guint32 *)order;
+	self->size = gydp_words_size(words);
+	self->mapped = TRUE;
+	self->words = words;
+	self->buffer = g_string_new(NULL);
+
+	return self;
+}
+
+void gydp_dict_keys_free(GydpDictKeys *self) {
+	if( self != NULL ) {
+		if( !self->mapped ) {
+			g_free(self->data);
+			g_free(self->key);
+			g_free(self->order);
+		}
+		if( self->buffer != NULL )
+			g_string_free(self->buffer, TRUE);
+
+		g_slice_free(GydpDictKeys, self);
+	}
+}
+
+/** gydp_dict_keys_find
+ * find best compatible entry for processed word, same as linear search:
+ *  * first entry with word as prefix
+ *  * otherwise last entry of entries sharing longest prefix with word
+ */
+guint gydp_dict_keys_find(GydpDictKeys *self, const gchar *word) {
+	const gsize length = strlen(word);
+
+	/* check for string length */
+	if( self->size == 0 || length == 0 )
+		return 0;
+
+	/* first key not less than word */
+	const guint lower = gydp_dict_keys_lower(self, word, 0, self->size);
+
+	/* completely compatible item found */
+	if( lower < self->size &&
+			!strncmp(gydp_dict_keys_key(self, lower, self->buffer), word, length) )
+		return self->order[lower];
+
+	return gydp_dict_keys_nearest(self, word, lower);
+}
+
+/** gydp_dict_keys_fuzzy
+ * find limit keys closest to processed word within edit distance,
+ * sorted keys are walked like a trie: rows of prefix shared with
+ * previous key are reused and keys of prefix too far from word are
+ * skipped at once
+ */
+GArray *gydp_dict_keys_fuzzy(GydpDictKeys *self, const gchar *word, guint distance, guint limit) {
+	GString *prev = g_string_new(NULL), *key = g_string_new(NULL);
+	GydpDictFuzzy fuzzy;
+	guint depth = 0;
+
+	gydp_dict_fuzzy_init(&fuzzy, word, distance, limit);
+
+	for(guint i = 0; i < self->size && fuzzy.length && fuzzy.bound >= 0;) {
+		const gchar *pos;
+
+		/* key is copied, searches decode other keys */
+		g_string_assign(key, gydp_dict_keys_key(self, i, self->buffer));
+
+		/* rows of shared prefix are still valid */
+		const gsize common = gydp_dict_keys_prefix(key->str, prev->str);
+		while( fuzzy.offset[depth] > common )
+			--depth;
+
+		/* extend prefix until key ends or is too far from word */
+		for(pos = key->str + fuzzy.offset[depth]; *pos; pos = g_utf8_next_char(pos)) {
+			if( gydp_dict_fuzzy_row(&fuzzy, depth, g_utf8_get_char(pos)) > fuzzy.bound )
+				break;
+			fuzzy.offset[++depth] = g_utf8_next_char(pos) - key->str;
+		}
+
+		if( *pos == '\0' ) {
+			gydp_dict_fuzzy_match(&fuzzy, i, fuzzy.rows[(depth + 1) * (fuzzy.length + 1) - 1]);
+			++i;
+		} else {
+			/* skip all keys sharing prefix which is too far */
+			const gsize length = g_utf8_next_char(pos) - key->str;
+			i = gydp_dict_keys_upper(self, key->str, length, i, self->size);
+		}
+
+		/* current key is previous one */
+		GString *swap = prev;
+		prev = key;
+		key = swap;
+	}
+
+	/* free temporary data */
+	g_string_free(prev, TRUE);
+	g_string_free(key, TRUE);
+
+	return gydp_dict_fuzzy_done(&fuzzy);
+}
+
+/** gydp_dict_keys_narrow
+ * same as gydp_dict_keys_find, but search starts from range of longest
+ * previous word which is prefix of word (kept on stack in dictionary),
+ * range of word is pushed so that typing narrows it further
+ */
+static guint gydp_dict_keys_narrow(GydpDict *dict, GydpDictKeys *self, const gchar *word) {
+	const gsize length = strlen(word);
+	GydpDictRange range = { NULL, 0, self->size };
+
+	if( dict->narrow == NULL )
+		dict->narrow = g_array_new(FALSE, FALSE, sizeof(GydpDictRange));
+
+	/* drop ranges of words which are not prefix of word (deleted characters) */
+	while( dict->narrow->len ) {
+		GydpDictRange *top = &g_array_index(dict->narrow, GydpDictRange, dict->narrow->len - 1);
+
+		if( g_str_has_prefix(word, top->word) ) {
+			range = *top;
 			break;
 		}
+
+		g_free(top->word);
+		g_array_set_size(dict->narrow, dict->narrow->len - 1);
+	}
+
+	/* check for string length */
+	if( self->size == 0 || length == 0 )
+		return 0;
+
+	/* keys with word as prefix are part of parent range, so are its bounds */
+	if( range.word == NULL || strcmp(range.word, word) ) {
+		range.lower = gydp_dict_keys_lower(self, word, range.lower, range.upper);
+		range.upper = gydp_dict_keys_upper(self, word, length, range.lower, range.upper);
+
+		/* remember range for next word */
+		if( dict->narrow->len < GYDP_DICT_NARROW_DEPTH ) {
+			range.word = g_strdup(word);
+			g_array_append_val(dict->narrow, range);
+		}
+	}
+
+	/* completely compatible item found */
+	if( range.lower < range.upper )
+		return self->order[range.lower];
+
+	return gydp_dict_keys_nearest(self, word, range.lower);
+}
+
+static void gydp_dict_keys_narrow_clear(GydpDict *dict) {
+	if( dict->narrow == NULL )
+		return;
+
+	for(guint i = 0; i < dict->narrow->len; ++i)
+		g_free(g_array_index(dict->narrow, GydpDictRange, i).word);
+	g_array_set_size(dict->narrow, 0);
+}
+
+guint gydp_dict_keys_size(GydpDictKeys *self) {
+	return self->size;
+}
+
+/** gydp_dict_keys_memory
+ * front coded keys and order of wrapped keys are owned by engine, but
+ * they are counted here as search keys of engine
+ */
+gsize gydp_dict_keys_memory(GydpDictKeys *self) {
+	if( self == NULL )
+		return 0;
+	if( self->words != NULL )
+		return gydp_words_memory(self->words) + self->size * sizeof(guint32);
+	return self->length + 2 * self->size * sizeof(guint32);
+}
+
+guint gydp_dict_keys_entry(GydpDictKeys *self, guint i) {
+	return self->order[i];
+}
+
+const gchar *gydp_dict_keys_key(GydpDictKeys *self, guint i, GString *buffer) {
+	if( self->words != NULL )
+		return gydp_words_copy(self->words, i, buffer);
+	return self->data + self->key[self->order[i]];
+}
+
+guint gydp_dict_keys_lower_bound(GydpDictKeys *self, const gchar *word) {
+	return gydp_dict_keys_lower(self, word, 0, self->size);
+}
+
+guint gydp_dict_keys_upper_bound(GydpDictKeys *self, const gchar *word, gsize length) {
+	return gydp_dict_keys_upper(self, word, length, 0, self->size);
+}
+
+void gydp_dict_keys_store(GydpDictKeys *self, GydpCache *cache) {
+	g_return_if_fail(self->words == NULL);
+
+	gydp_cache_set(cache, GYDP_CACHE_KEYS_DATA, self->data, self->length);
+	gydp_cache_set(cache, GYDP_CACHE_KEYS_KEY, self->key, self->size * sizeof(guint32));
+	gydp_cache_set(cache, GYDP_CACHE_KEYS_ORDER, self->order, self->size * sizeof(guint32));
+}
+
+/** gydp_dict_keys_restore
+ * use keys directly from loaded index cache, keys are validated
+ * so that broken cache can not cause reads outside of mapping
+ */
+GydpDictKeys *gydp_dict_keys_restore(GydpCache *cache, guint size) {
+	gsize length, key_size, order_size;
+	const gchar *data = gydp_cache_get(cache, GYDP_CACHE_KEYS_DATA, &length);
+	const guint32 *key = gydp_cache_get(cache, GYDP_CACHE_KEYS_KEY, &key_size);
+	const guint32 *order = gydp_cache_get(cache, GYDP_CACHE_KEYS_ORDER, &order_size);
+
+	/* validate sections */
+	if( key_size != size * sizeof(guint32) || order_size != size * sizeof(guint32) ||
+			(size > 0 && (length == 0 || data[length - 1] != '\0')) )
+		return NULL;
+
+	for(guint n = 0; n < size; ++n)
+		if( key[n] >= length || order[n] >= size )
+			return NULL;
+
+	/* keys are used in place */
+	GydpDictKeys *self = g_slice_new(GydpDictKeys);
+	self->data = (gchar *)data;
+	self->key = (guint32 *)key;
+	self->order = (guint32 *)order;
+	self->size = size;
+	self->length = length;
+	self->mapped = TRUE;
+	self->words = NULL;
+	self->buffer = NULL;
+
+	return self;
+}
+
+static gint gydp_dict_keys_compare(gconstpointer a, gconstpointer b, gpointer data) {
+	const GydpDictKeys *self = data;
+	const guint32 x = *(const guint32 *)a, y = *(const guint32 *)b;
+	const gint result = strcmp(self->data + self->key[x], self->data + self->key[y]);
+
+	/* keep dictionary order of equal keys */
+	if( result == 0 )
+		return x < y? -1: 1;
+	return result;
+}
+
+/** gydp_dict_keys_lower
+ * first key in [lower, upper) not less than word (block heads select
+ * block of front coded keys if all keys are searched)
+ */
+static guint gydp_dict_keys_lower(GydpDictKeys *self, const gchar *word, guint lower, guint upper) {
+	if( self->words != NULL && lower == 0 && upper == self->size )
+		return gydp_words_lower(self->words, word);
+
+	while( lower < upper ) {
+		const guint middle = lower + (upper - lower) / 2;
+		if( strcmp(gydp_dict_keys_key(self, middle, self->buffer), word) < 0 )
+			lower = middle + 1;
+		else
+			upper = middle;
 	}
 
-	/* free temporart data */
-	g_free((gchar *)word);
+	return lower;
+}
 
-	return n < size? pos: size - 1;
+/** gydp_dict_keys_upper
+ * first key in [lower, upper) past keys starting with length bytes of word
+ * (keys in range are not less than word) or past keys whose first length
+ * bytes are not greater than word (whole sorted keys)
+ */
+static guint gydp_dict_keys_upper(GydpDictKeys *self, const gchar *word, gsize length, guint lower, guint upper) {
+	if( self->words != NULL && lower == 0 && upper == self->size )
+		return gydp_words_upper(self->words, word, length);
+
+	while( lower < upper ) {
+		const guint middle = lower + (upper - lower) / 2;
+		if( strncmp(gydp_dict_keys_key(self, middle, self->buffer), word, length) <= 0 )
+			lower = middle + 1;
+		else
+			upper = middle;
+	}
+
+	return lower;
 }
 
+/** gydp_dict_keys_nearest
+ * no key starts with word, find last key sharing longest prefix with word
+ * (lower is first key not less than word)
+ */
+static guint gydp_dict_keys_nearest(GydpDictKeys *self, const gchar *word, guint lower) {
+	guint prefix = 0;
+
+	/* longest common prefix is shared with one of neighbours */
+	if( lower < self->size )
+		prefix = gydp_dict_keys_prefix(gydp_dict_keys_key(self, lower, self->buffer), word);
+	if( lower > 0 )
+		prefix = MAX(prefix, gydp_dict_keys_prefix(gydp_dict_keys_key(self, lower - 1, self->buffer), word));
+
+	/* find last key sharing this prefix */
+	return self->order[gydp_dict_keys_upper(self, word, prefix, lower, self->size) - 1];
+}
+
+static guint gydp_dict_keys_prefix(const gchar *key, const gchar *word) {
+	guint i = 0;
+
+	/* compare */
+	while( word[i] && key[i] == word[i] )
+		++i;
+
+	return i;
+}
@@ -21,12 +21,25 @@
 #define __GYDP_DICT_H__
 
 #include "gydp_global.h"
-#include <gtk/gtktextbuffer.h>
+#include "gydp_cache.h"
+#include "gydp_text.h"
+#include "gydp_words.h"
+#include <gio/gio.h>
 
 G_BEGIN_DECLS
 
 typedef struct _GydpDict      GydpDict;
 typedef struct _GydpDictClass GydpDictClass;
+typedef struct _GydpDictKeys  GydpDictKeys;
+
+/* asynchronous load completion (called in main loop) */
+typedef void (*GydpDictLoadFunc)(GydpDict *dict, gboolean result, gpointer data);
+
+/* largest edit distance of approximate search */
+#define GYDP_DICT_FUZZY_DISTANCE 2
+
+/* asynchronous search result (called in main loop, not called if cancelled) */
+typedef void (*GydpDictFindFunc)(GydpDict *dict, guint n, gpointer data);
 
 #define GYDP_TYPE_DICT            (gydp_dict_get_type ())
 #define GYDP_DICT(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), GYDP_TYPE_DICT, GydpDict))
@@ -41,6 +54,40 @@ struct _GydpDict {
 	/* READ ONLY */
 	GydpEngine engine;
 	GydpLang language;
+
+	/* PRIVATE (asynchronous load) */
+	GThread *thread;             /* loader thread */
+	GCancellable *cancellable;   /* loader cancellation */
+	volatile gint loaded;        /* words published by loader */
+	volatile gint notify;        /* change notification is pending */
+	gchar **locations;           /* loader arguments (kept for index builder) */
+	GydpLang lang;
+	gboolean result;             /* loader result */
+	GydpDictLoadFunc func;       /* completion callback */
+	gpointer data;
+
+	/* PRIVATE (rendered definitions cache) */
+	GHashTable *texts;           /* entry -> link in texts_used */
+	GQueue *texts_used;          /* cached definitions, recently used first */
+	gsize texts_size;            /* memory held by cached definitions */
+	gsize texts_limit;           /* memory limit (bytes) */
+	guint texts_hits;            /* definitions served from cache */
+	guint texts_misses;          /* definitions rendered by engine */
+
+	/* PRIVATE (idle prefetch of neighbouring definitions) */
+	guint prefetch;              /* idle source id */
+	GArray *prefetch_queue;      /* entries to render (guint) */
+	guint prefetch_pos;          /* next entry in queue */
+	GydpText *prefetch_text;     /* render buffer */
+
+	/* PRIVATE (incremental search) */
+	GArray *narrow;              /* key ranges of previous words, each narrows previous one */
+
+	/* PRIVATE (full-text search) */
+	gchar **sources;             /* files of loaded dictionary (identify index caches) */
+	struct _GydpIndex *index;    /* inverted index, built with first query */
+	gpointer index_build;        /* index built in background (NULL if not running) */
+	gboolean index_failed;       /* dictionary can not be indexed (until next load) */
 };
 
 struct _GydpDictClass {
@@ -49,10 +96,14 @@ struct _GydpDictClass {
 	/* virtual table */
 	gboolean     (*load)(GydpDict *dict, gchar **locations, GydpLang lang);
 	gboolean     (*lang)(GydpDict *dict, GydpLang lang);
+	void         (*configure)(GydpDict *dict);
 	guint        (*size)(GydpDict *dict);
 	const gchar *(*word)(GydpDict *dict, guint n);
-	gboolean     (*text)(GydpDict *dict, guint n, GtkTextBuffer *buffer);
+	gboolean     (*text)(GydpDict *dict, guint n, GydpText *text);
 	guint        (*find)(GydpDict *dict, const gchar *word);
+	GArray      *(*fuzzy)(GydpDict *dict, const gchar *word, guint distance, guint limit);
+	GydpDictKeys *(*keys)(GydpDict *dict);
+	gsize        (*memory)(GydpDict *dict);
 };
 
 GType        gydp_dict_get_type();
@@ -62,14 +113,93 @@ void         gydp_dict_changed (GydpDict *dict);
 gboolean     gydp_dict_load    (GydpDict *dict, gchar **locations, GydpLang lang);
 gboolean     gydp_dict_lang    (GydpDict *dict, GydpLang lang);
 
-/* translation management */
+/* read settings used by load (done by load functions in calling thread,
+ * configuration is not thread safe so loader threads never read it) */
+void         gydp_dict_configure(GydpDict *dict);
+
+/* asynchronous loading, words are published while loading */
+void         gydp_dict_load_async (GydpDict *dict, gchar **locations, GydpLang lang,
+                                   GydpDictLoadFunc func, gpointer data);
+void         gydp_dict_load_cancel(GydpDict *dict);
+gboolean     gydp_dict_loading    (GydpDict *dict);
+
+/* used by engines while loading (any thread) */
+gboolean     gydp_dict_progress   (GydpDict *dict, guint words);
+gboolean     gydp_dict_cancelled  (GydpDict *dict);
+void         gydp_dict_set_sources(GydpDict *dict, const gchar *const *sources);
+
+/* files of loaded dictionary (NULL terminated) */
+const gchar *const *gydp_dict_sources(GydpDict *dict);
+
+/* estimated memory held by loaded dictionary (bytes), engines report memory
+ * of their data beyond mapped dictionary files and search keys */
+gsize        gydp_dict_memory     (GydpDict *dict);
+
+/* translation management, word is owned by dictionary and is valid only
+ * until next word is requested (engines decoding words on demand reuse
+ * one buffer), callers keeping words have to copy them */
 guint        gydp_dict_size    (GydpDict *dict);
 const gchar *gydp_dict_word    (GydpDict *dict, guint n);
-gboolean     gydp_dict_text    (GydpDict *dict, guint n, GtkTextBuffer *buffer);
+gboolean     gydp_dict_text    (GydpDict *dict, guint n, GydpText *text);
 guint        gydp_dict_find    (GydpDict *dict, const gchar *word);
 
+/* search at idle time, long scans are split into slices between events */
+void         gydp_dict_find_async(GydpDict *dict, const gchar *word, GCancellable *cancellable,
+                                  GydpDictFindFunc func, gpointer data);
+
+/* approximate search, closest entries within edit distance (NULL while loading),
+ * it is quick only if precomputed keys are searched instead of all words */
+GArray      *gydp_dict_fuzzy   (GydpDict *dict, const gchar *word, guint distance, guint limit);
+gboolean     gydp_dict_fuzzy_quick(GydpDict *dict);
+
+/* full-text search, ranked entries containing all query terms (NULL while
+ * loading or indexing, index is built in background with first query and
+ * "changed" is emitted when it is ready) */
+GArray      *gydp_dict_search  (GydpDict *dict, const gchar *query, guint limit);
+gboolean     gydp_dict_indexing(GydpDict *dict);
+
+/* rendered definitions cache (emptied on every load) */
+void         gydp_dict_text_flush(GydpDict *dict);
+void         gydp_dict_text_stats(GydpDict *dict, guint *hits, guint *misses, gsize *size);
+
+/* render neighbours of entry into cache at idle time (count on each side and page away) */
+void         gydp_dict_prefetch     (GydpDict *dict, guint n, guint count, guint page);
+void         gydp_dict_prefetch_stop(GydpDict *dict);
+
 /* default implementations for virual functions */
 guint        gydp_dict_find_f  (GydpDict *dict, const gchar *word);
+GArray      *gydp_dict_fuzzy_f (GydpDict *dict, const gchar *word, guint distance, guint limit);
+
+/* folded search keys (built by engines at load time or wrapping front
+ * coded keys of engine, which are decoded on demand and are not thread safe) */
+GydpDictKeys *gydp_dict_keys_new (GydpDict *dict);
+GydpDictKeys *gydp_dict_keys_wrap(GydpWords *words, const guint32 *order);
+void          gydp_dict_keys_free(GydpDictKeys *keys);
+guint         gydp_dict_keys_find(GydpDictKeys *keys, const gchar *word);
+
+/* sorted positions of keys closest to word, closest first */
+GArray       *gydp_dict_keys_fuzzy(GydpDictKeys *keys, const gchar *word, guint distance, guint limit);
+
+/* folded keys in binary order: entry and key at sorted position i (front
+ * coded key is decoded into buffer, otherwise buffer is not used) */
+guint         gydp_dict_keys_size (GydpDictKeys *keys);
+gsize         gydp_dict_keys_memory(GydpDictKeys *keys);
+guint         gydp_dict_keys_entry(GydpDictKeys *keys, guint i);
+const gchar  *gydp_dict_keys_key  (GydpDictKeys *keys, guint i, GString *buffer);
+
+/* sorted positions of keys less than word and of keys whose first length
+ * bytes are not greater than word (length past terminator counts keys not
+ * greater than word) */
+guint         gydp_dict_keys_lower_bound(GydpDictKeys *keys, const gchar *word);
+guint         gydp_dict_keys_upper_bound(GydpDictKeys *keys, const gchar *word, gsize length);
+
+/* folded search keys in index cache (restored keys point into cache,
+ * wrapped keys are stored by their engine) */
+void          gydp_dict_keys_store  (GydpDictKeys *keys, GydpCache *cache);
+GydpDictKeys *gydp_dict_keys_restore(GydpCache *cache, guint size);
+
+/* process string for comparison (case folding and normalization) */
+gchar        *gydp_str_process   (const gchar *str);
 
 G_END_DECLS
 
@@ -0,0 +1,637 @@
+/*
+ * Copyright (C) 2008 Michał Kurgan <michal.kurgan@moloh.net>
+ *
+ * This file is part of gydpdict.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gydpdict.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gydp_dict.h"
+#include "gydp_dict_merge.h"
+#include "gydp_util.h"
+
+#include <string.h>
+
+/* entries walked from cursor before position is searched instead */
+#define GYDP_DICT_MERGE_STEP 64
+
+typedef struct GydpDictMergeSource {
+	GydpDict *dict;         /* loaded engine dictionary */
+	GydpDictKeys *keys;     /* folded keys of dictionary */
+	gboolean owned;         /* keys are built by merge (engine has none) */
+	GydpCache *cache;       /* keys cache of merge (restored keys are used in place) */
+} GydpDictMergeSource;
+
+/* engines merged in this order */
+static const GydpEngine gydp_dict_merge_engines[] = { GYDP_ENGINE_SAP, GYDP_ENGINE_YDP };
+
+struct GydpDictMergeClass {
+	GydpDictClass __parent__;
+};
+
+struct GydpDictMerge {
+	GydpDict __parent__;
+
+	/* merged dictionaries (ordered, equal keys of first one go first) */
+	GydpDictMergeSource *source;
+	guint sources;
+	guint size;             /* entries of all dictionaries */
+
+	/* merged position, sorted position of next key in every dictionary */
+	guint *cursor;
+	guint cursor_n;
+	gboolean cursor_valid;
+
+	/* definition of single dictionary */
+	GydpText *text;
+
+	/* keys compared by merge (front coded keys are decoded here) */
+	GString *buffer[2];
+
+	/* engines configured in main loop and their data dirs (used by next load) */
+	GydpDict *engine[G_N_ELEMENTS(gydp_dict_merge_engines)];
+	gchar **paths[G_N_ELEMENTS(gydp_dict_merge_engines)];
+};
+
+/* perent class holder */
+static GObjectClass *gydp_dict_merge_parent_class = NULL;
+
+/* private functions */
+static void     gydp_dict_merge_init       (GydpDictMerge *self);
+static void     gydp_dict_merge_class_init (GydpDictMergeClass *klass);
+static void     gydp_dict_merge_finalize   (GObject *object);
+
+/* virtual functions */
+static gboolean     gydp_dict_merge_load (GydpDict *dict, gchar **locations, GydpLang lang);
+static gboolean     gydp_dict_merge_lang (GydpDict *dict, GydpLang lang);
+static void         gydp_dict_merge_configure(GydpDict *dict);
+static guint        gydp_dict_merge_size (GydpDict *dict);
+static const gchar *gydp_dict_merge_word (GydpDict *dict, guint n);
+static gboolean     gydp_dict_merge_text (GydpDict *dict, guint n, GydpText *text);
+static guint        gydp_dict_merge_find (GydpDict *dict, const gchar *word);
+static GArray      *gydp_dict_merge_fuzzy(GydpDict *dict, const gchar *word, guint distance, guint limit);
+static gsize        gydp_dict_merge_memory(GydpDict *dict);
+
+/* private utility functions */
+static void         gydp_dict_merge_unload (GydpDictMerge *dict);
+static void         gydp_dict_merge_release(GydpDictMerge *dict);
+static GydpDictKeys *gydp_dict_merge_keys  (GydpDictMergeSource *source);
+static const gchar *gydp_dict_merge_key    (GydpDictMerge *dict, guint s, guint i, GString *buffer);
+static gint         gydp_dict_merge_compare(GydpDictMerge *dict, guint s, guint i, guint t, guint j);
+static guint        gydp_dict_merge_before (GydpDictMerge *dict, guint t, const gchar *key, guint s);
+static guint        gydp_dict_merge_rank   (GydpDictMerge *dict, guint s, guint i);
+static void         gydp_dict_merge_seek   (GydpDictMerge *dict, guint n);
+static guint        gydp_dict_merge_entry  (GydpDictMerge *dict, guint n, guint *source);
+static guint        gydp_dict_merge_prefix (const gchar *key, const gchar *word);
+
+GType gydp_dict_merge_get_type() {
+	static GType type = G_TYPE_INVALID;
+	if( G_UNLIKELY( type == G_TYPE_INVALID ) ) {
+		static const GTypeInfo info = {
+			sizeof(GydpDictMergeClass),                         /* class size */
+			NULL, NULL,                                         /* base init, finalize */
+			(GClassInitFunc) gydp_dict_merge_class_init, NULL,  /* class init, finalize */
+			NULL,                                               /* class init, finalize user_data */
+			sizeof(GydpDictMerge), 0,                           /* base size, prealloc size */
+			(GInstanceInitFunc) gydp_dict_merge_init,           /* instance init */
+			NULL,                                               /* GValue table */
+		};
+
+		type = g_type_register_static(GYDP_TYPE_DICT, "GydpDictMerge", &info, 0);
+	}
+
+	return type;
+}
+
+GObject *gydp_dict_merge_new() {
+	return g_object_new(GYDP_TYPE_DICT_MERGE, NULL);
+}
+
+static void gydp_dict_merge_init(GydpDictMerge *self) {
+	GYDP_DICT(self)->engine = GYDP_ENGINE_MERGE;
+	GYDP_DICT(self)->language = GYDP_LANG_NONE;
+
+	self->buffer[0] = g_string_new(NULL);
+	self->buffer[1] = g_string_new(NULL);
+}
+
+static void gydp_dict_merge_class_init(GydpDictMergeClass *klass) {
+	/* determine parent class */
+	gydp_dict_merge_parent_class = g_type_class_peek_parent(klass);
+
+	GObjectClass *gobject_klass = G_OBJECT_CLASS(klass);
+	gobject_klass->finalize = gydp_dict_merge_finalize;
+
+	GydpDictClass *dict_klass = GYDP_DICT_CLASS(klass);
+	dict_klass->load = gydp_dict_merge_load;
+	dict_klass->lang = gydp_dict_merge_lang;
+	dict_klass->configure = gydp_dict_merge_configure;
+
+	dict_klass->size = gydp_dict_merge_size;
+	dict_klass->word = gydp_dict_merge_word;
+	dict_klass->text = gydp_dict_merge_text;
+	dict_klass->find = gydp_dict_merge_find;
+	dict_klass->fuzzy = gydp_dict_merge_fuzzy;
+
+	/* merged order exists only through keys of every dictionary */
+	dict_klass->keys = NULL;
+	dict_klass->memory = gydp_dict_merge_memory;
+}
+
+static void gydp_dict_merge_finalize(GObject *object) {
+	GydpDictMerge *self = GYDP_DICT_MERGE(object);
+
+	/* unload dictionaries */
+	gydp_dict_merge_unload(self);
+	gydp_dict_merge_release(self);
+	gydp_text_free(self->text);
+	g_string_free(self->buffer[0], TRUE);
+	g_string_free(self->buffer[1], TRUE);
+
+	/* chain to parent finalize */
+	gydp_dict_merge_parent_class->finalize(object);
+}
+
+/** gydp_dict_merge_load
+ * load every engine supporting language (called by loader thread, so
+ * engines prepared by configure are loaded directly), engines failing
+ * to load are left out
+ */
+static gboolean gydp_dict_merge_load(GydpDict *dict, gchar **locations G_GNUC_UNUSED, GydpLang lang) {
+	GydpDictMerge *self = GYDP_DICT_MERGE(dict);
+	GPtrArray *files = g_ptr_array_new();
+
+	/* close previously opened dictionaries */
+	gydp_dict_merge_unload(self);
+	self->source = g_new0(GydpDictMergeSource, G_N_ELEMENTS(gydp_dict_merge_engines));
+
+	for(guint i = 0; i < G_N_ELEMENTS(gydp_dict_merge_engines); ++i) {
+		const GydpEngine engine = gydp_dict_merge_engines[i];
+
+		/* merged words are published at once */
+		if( !gydp_dict_progress(dict, 0) )
+			break;
+
+		/* engine is owned by load from now */
+		GydpDict *source = self->engine[i];
+		gchar **paths = self->paths[i];
+		self->engine[i] = NULL;
+		self->paths[i] = NULL;
+
+		if( source == NULL || !gydp_dict_lang(source, lang) ) {
+			if( source != NULL )
+				g_object_unref(source);
+			g_strfreev(paths);
+			continue;
+		}
+
+		/* engine reports its errors */
+		const gboolean result = GYDP_DICT_GET_CLASS(source)->load(source, paths, lang);
+		g_strfreev(paths);
+
+		if( !result ) {
+			g_object_unref(source);
+			continue;
+		}
+
+		/* engines without keys (lazy mode) get them from merge cache */
+		GydpDictMergeSource *merged = &self->source[self->sources++];
+		GydpDictClass *klass = GYDP_DICT_GET_CLASS(source);
+		merged->dict = source;
+		merged->keys = klass->keys? klass->keys(source): NULL;
+		merged->owned = merged->keys == NULL;
+		if( merged->owned )
+			merged->keys = gydp_dict_merge_keys(merged);
+
+		self->size += gydp_dict_keys_size(merged->keys);
+
+		/* files of all engines identify merged index caches */
+		for(const gchar *const *file = gydp_dict_sources(source); file != NULL && *file != NULL; ++file)
+			g_ptr_array_add(files, (gpointer)*file);
+	}
+
+	g_ptr_array_add(files, NULL);
+	gydp_dict_set_sources(dict, (const gchar *const *)files->pdata);
+	g_ptr_array_free(files, TRUE);
+
+	if( self->sources == 0 || gydp_dict_cancelled(dict) ) {
+		gydp_dict_merge_unload(self);
+		return FALSE;
+	}
+
+	self->cursor = g_new0(guint, self->sources);
+	if( self->text == NULL )
+		self->text = gydp_text_new();
+
+	/* set current language */
+	dict->language = lang;
+
+	return TRUE;
+}
+
+static gboolean gydp_dict_merge_lang(GydpDict *dict G_GNUC_UNUSED, GydpLang lang) {
+	gboolean result = FALSE;
+
+	/* check supported languages of every engine */
+	for(guint i = 0; i < G_N_ELEMENTS(gydp_dict_merge_engines) && !result; ++i) {
+		GydpDict *source = GYDP_DICT(gydp_engine_new(gydp_dict_merge_engines[i]));
+		result = gydp_dict_lang(source, lang);
+		g_object_unref(source);
+	}
+
+	return result;
+}
+
+/** gydp_dict_merge_configure
+ * engines read their settings and data dirs here (in main loop), so
+ * loader thread never reads configuration
+ */
+static void gydp_dict_merge_configure(GydpDict *dict) {
+	GydpDictMerge *self = GYDP_DICT_MERGE(dict);
+
+	/* engines of previous configure were not loaded */
+	gydp_dict_merge_release(self);
+
+	for(guint i = 0; i < G_N_ELEMENTS(gydp_dict_merge_engines); ++i) {
+		const GydpEngine engine = gydp_dict_merge_engines[i];
+
+		self->engine[i] = GYDP_DICT(gydp_engine_new(engine));
+		self->paths[i] = gydp_data_dirs(engine);
+		gydp_dict_configure(self->engine[i]);
+	}
+}
+
+static guint gydp_dict_merge_size(GydpDict *dict) {
+	return GYDP_DICT_MERGE(dict)->size;
+}
+
+static const gchar *gydp_dict_merge_word(GydpDict *dict, guint n) {
+	GydpDictMerge *self = GYDP_DICT_MERGE(dict);
+	guint s;
+
+	const guint i = gydp_dict_merge_entry(self, n, &s);
+	return gydp_dict_word(self->source[s].dict, gydp_dict_keys_entry(self->source[s].keys, i));
+}
+
+/** gydp_dict_merge_text
+ * definitions of all entries with same folded key in every dictionary,
+ * each one is preceded by engine name
+ */
+static gboolean gydp_dict_merge_text(GydpDict *dict, guint n, GydpText *text) {
+	GydpDictMerge *self = GYDP_DICT_MERGE(dict);
+	guint s;
+
+	const guint i = gydp_dict_merge_entry(self, n, &s);
+	const gchar *key = gydp_dict_merge_key(self, s, i, self->buffer[0]);
+	const gsize length = strlen(key) + 1;
+
+	gydp_text_clear(text);
+
+	for(guint t = 0; t < self->sources; ++t) {
+		GydpDictMergeSource *source = &self->source[t];
+		GydpDictClass *klass = GYDP_DICT_GET_CLASS(source->dict);
+		const guint upper = gydp_dict_keys_upper_bound(source->keys, key, length);
+
+		for(guint i = gydp_dict_keys_lower_bound(source->keys, key); i < upper; ++i) {
+			if( !klass->text(source->dict, gydp_dict_keys_entry(source->keys, i), self->text) )
+				continue;
+
+			/* definitions are separated by empty line */
+			if( text->text->len )
+				gydp_text_append(text, "\n\n", -1, GYDP_STYLE_NONE);
+			gydp_text_append(text, gydp_engine_value_to_nick(source->dict->engine), -1,
+					GYDP_STYLE_ITALIC | GYDP_STYLE_COLOR_BLUE);
+			gydp_text_append(text, "\n", -1, GYDP_STYLE_NONE);
+			gydp_text_concat(text, self->text);
+		}
+	}
+
+	return text->text->len > 0;
+}
+
+/** gydp_dict_merge_find
+ * same result as gydp_dict_keys_find over merged keys, positions in
+ * merged order are sums of positions in every dictionary
+ */
+static guint gydp_dict_merge_find(GydpDict *dict, const gchar *word) {
+	GydpDictMerge *self = GYDP_DICT_MERGE(dict);
+	GString *next = self->buffer[0], *prev = self->buffer[1];
+	gboolean next_found = FALSE, prev_found = FALSE;
+	guint lower = 0, prefix = 0;
+
+	gchar *processed = gydp_str_process(word);
+	const gsize length = strlen(processed);
+
+	/* check for string length */
+	if( self->size == 0 || length == 0 ) {
+		g_free(processed);
+		return 0;
+	}
+
+	/* first key not less than word and key before it (copied, keys of one
+	 * dictionary are decoded into same buffer) */
+	GString *key = g_string_new(NULL);
+	for(guint s = 0; s < self->sources; ++s) {
+		const guint i = gydp_dict_keys_lower_bound(self->source[s].keys, processed);
+		lower += i;
+
+		if( i < gydp_dict_keys_size(self->source[s].keys) ) {
+			const gchar *str = gydp_dict_merge_key(self, s, i, key);
+			if( !next_found || strcmp(str, next->str) < 0 )
+				g_string_assign(next, str);
+			next_found = TRUE;
+		}
+		if( i > 0 ) {
+			const gchar *str = gydp_dict_merge_key(self, s, i - 1, key);
+			if( !prev_found || strcmp(str, prev->str) > 0 )
+				g_string_assign(prev, str);
+			prev_found = TRUE;
+		}
+	}
+	g_string_free(key, TRUE);
+
+	/* completely compatible item found */
+	if( next_found && !strncmp(next->str, processed, length) ) {
+		g_free(processed);
+		return lower;
+	}
+
+	/* longest common prefix is shared with one of neighbours */
+	if( next_found )
+		prefix = gydp_dict_merge_prefix(next->str, processed);
+	if( prev_found )
+		prefix = MAX(prefix, gydp_dict_merge_prefix(prev->str, processed));
+
+	/* find last key sharing this prefix */
+	guint upper = 0;
+	for(guint s = 0; s < self->sources; ++s)
+		upper += gydp_dict_keys_upper_bound(self->source[s].keys, processed, prefix);
+
+	g_free(processed);
+	return upper - 1;
+}
+
+/** gydp_dict_merge_fuzzy
+ * approximate search in every dictionary, closest entries of dictionaries
+ * alternate (distances are not compared across dictionaries)
+ */
+static GArray *gydp_dict_merge_fuzzy(GydpDict *dict, const gchar *word, guint distance, guint limit) {
+	GydpDictMerge *self = GYDP_DICT_MERGE(dict);
+	GArray *result = g_array_sized_new(FALSE, FALSE, sizeof(guint), MIN(limit, 64));
+	GArray **found = g_new(GArray *, self->sources);
+	gchar *processed = gydp_str_process(word);
+	gboolean more = TRUE;
+
+	for(guint s = 0; s < self->sources; ++s)
+		found[s] = gydp_dict_keys_fuzzy(self->source[s].keys, processed, distance, limit);
+
+	for(guint i = 0; more && result->len < limit; ++i) {
+		more = FALSE;
+
+		for(guint s = 0; s < self->sources && result->len < limit; ++s) {
+			if( i >= found[s]->len )
+				continue;
+
+			/* keys give sorted positions */
+			const guint n = gydp_dict_merge_rank(self, s, g_array_index(found[s], guint, i));
+			g_array_append_val(result, n);
+			more = TRUE;
+		}
+	}
+
+	for(guint s = 0; s < self->sources; ++s)
+		g_array_free(found[s], TRUE);
+	g_free(found);
+	g_free(processed);
+
+	return result;
+}
+
+/** gydp_dict_merge_memory
+ * data and keys of every dictionary (their files are sources of merge)
+ */
+static gsize gydp_dict_merge_memory(GydpDict *dict) {
+	GydpDictMerge *self = GYDP_DICT_MERGE(dict);
+	gsize result = self->sources * sizeof(GydpDictMergeSource);
+
+	for(guint s = 0; s < self->sources; ++s) {
+		GydpDictClass *klass = GYDP_DICT_GET_CLASS(self->source[s].dict);
+
+		result += gydp_dict_keys_memory(self->source[s].keys);
+		if( klass->memory != NULL )
+			result += klass->memory(self->source[s].dict);
+	}
+
+	return result;
+}
+
+static void gydp_dict_merge_unload(GydpDictMerge *dict) {
+
+	/* validation */
+	g_return_if_fail(GYDP_IS_DICT_MERGE(dict));
+
+	/* free keys before their dictionaries and cache */
+	for(guint s = 0; s < dict->sources; ++s) {
+		if( dict->source[s].owned )
+			gydp_dict_keys_free(dict->source[s].keys);
+		gydp_cache_free(dict->source[s].cache);
+		g_object_unref(dict->source[s].dict);
+	}
+	g_free(dict->source);
+	g_free(dict->cursor);
+
+	/* reset data */
+	dict->source = NULL;
+	dict->sources = 0;
+	dict->size = 0;
+	dict->cursor = NULL;
+	dict->cursor_n = 0;
+	dict->cursor_valid = FALSE;
+
+	/* reset current dictionary */
+	GYDP_DICT(dict)->language = GYDP_LANG_NONE;
+}
+
+/* free engines prepared by configure */
+static void gydp_dict_merge_release(GydpDictMerge *dict) {
+	for(guint i = 0; i < G_N_ELEMENTS(gydp_dict_merge_engines); ++i) {
+		if( dict->engine[i] != NULL )
+			g_object_unref(dict->engine[i]);
+		g_strfreev(dict->paths[i]);
+
+		dict->engine[i] = NULL;
+		dict->paths[i] = NULL;
+	}
+}
+
+/** gydp_dict_merge_keys
+ * keys of engine without them are built once and kept in cache of merge
+ * identified by files of engine (restored keys are used in place)
+ */
+static GydpDictKeys *gydp_dict_merge_keys(GydpDictMergeSource *source) {
+	const gchar *const *sources = gydp_dict_sources(source->dict);
+	const guint size = GYDP_DICT_GET_CLASS(source->dict)->size(source->dict);
+	GydpDictKeys *keys;
+
+	if( sources == NULL )
+		return gydp_dict_keys_new(source->dict);
+
+	gchar *name = g_strconcat(gydp_engine_value_to_nick(GYDP_ENGINE_MERGE), "-",
+			gydp_engine_value_to_nick(source->dict->engine), "-keys", NULL);
+	GydpCache *cache = gydp_cache_new(name, sources);
+	g_free(name);
+
+	if( gydp_cache_load(cache) && (keys = gydp_dict_keys_restore(cache, size)) != NULL ) {
+		source->cache = cache;
+		return keys;
+	}
+
+	/* save keys for next load */
+	keys = gydp_dict_keys_new(source->dict);
+	gydp_dict_keys_store(keys, cache);
+	gydp_cache_save(cache);
+	gydp_cache_free(cache);
+
+	return keys;
+}
+
+/* key at sorted position i of dictionary s (front coded key is decoded into buffer) */
+static const gchar *gydp_dict_merge_key(GydpDictMerge *dict, guint s, guint i, GString *buffer) {
+	return gydp_dict_keys_key(dict->source[s].keys, i, buffer);
+}
+
+/** gydp_dict_merge_compare
+ * merged order of key at sorted position i of dictionary s and key at
+ * position j of dictionary t, equal keys are ordered by dictionary
+ */
+static gint gydp_dict_merge_compare(GydpDictMerge *dict, guint s, guint i, guint t, guint j) {
+	const gint result = strcmp(gydp_dict_merge_key(dict, s, i, dict->buffer[0]),
+			gydp_dict_merge_key(dict, t, j, dict->buffer[1]));
+
+	if( result == 0 )
+		return s == t? (gint)i - (gint)j: (gint)s - (gint)t;
+	return result;
+}
+
+/** gydp_dict_merge_before
+ * number of keys in dictionary t merged before key of dictionary s
+ * (equal keys of dictionaries before s go first)
+ */
+static guint gydp_dict_merge_before(GydpDictMerge *dict, guint t, const gchar *key, guint s) {
+	GydpDictKeys *keys = dict->source[t].keys;
+
+	if( t < s )
+		return gydp_dict_keys_upper_bound(keys, key, strlen(key) + 1);
+	return gydp_dict_keys_lower_bound(keys, key);
+}
+
+/* merged position of key at sorted position i of dictionary s */
+static guint gydp_dict_merge_rank(GydpDictMerge *dict, guint s, guint i) {
+	const gchar *key = gydp_dict_merge_key(dict, s, i, dict->buffer[0]);
+	guint rank = i;
+
+	for(guint t = 0; t < dict->sources; ++t)
+		if( t != s )
+			rank += gydp_dict_merge_before(dict, t, key, s);
+
+	return rank;
+}
+
+/** gydp_dict_merge_seek
+ * find dictionary holding n-th merged key with binary search in every
+ * dictionary (merged position grows with sorted position), then cursor
+ * is set past keys merged before it
+ */
+static void gydp_dict_merge_seek(GydpDictMerge *dict, guint n) {
+	for(guint s = 0; s < dict->sources; ++s) {
+		guint lower = 0, upper = gydp_dict_keys_size(dict->source[s].keys);
+
+		/* first key not merged before n-th one */
+		while( lower < upper ) {
+			const guint middle = lower + (upper - lower) / 2;
+			if( gydp_dict_merge_rank(dict, s, middle) < n )
+				lower = middle + 1;
+			else
+				upper = middle;
+		}
+
+		if( lower == gydp_dict_keys_size(dict->source[s].keys) ||
+				gydp_dict_merge_rank(dict, s, lower) != n )
+			continue;
+
+		const gchar *key = gydp_dict_merge_key(dict, s, lower, dict->buffer[0]);
+		for(guint t = 0; t < dict->sources; ++t)
+			dict->cursor[t] = t == s? lower: gydp_dict_merge_before(dict, t, key, s);
+
+		dict->cursor_n = n;
+		dict->cursor_valid = TRUE;
+		return;
+	}
+
+	g_return_if_reached();
+}
+
+/** gydp_dict_merge_entry
+ * sorted position of n-th merged key and its dictionary, cursor walks entry by entry
+ * for neighbouring positions (scrolling) and searches distant ones
+ */
+static guint gydp_dict_merge_entry(GydpDictMerge *dict, guint n, guint *source) {
+	guint best = 0;
+
+	if( !dict->cursor_valid || n + GYDP_DICT_MERGE_STEP < dict->cursor_n ||
+			n > dict->cursor_n + GYDP_DICT_MERGE_STEP )
+		gydp_dict_merge_seek(dict, n);
+
+	/* step back, last key before cursor is merged last */
+	while( dict->cursor_n > n ) {
+		guint last = G_MAXUINT;
+
+		for(guint s = 0; s < dict->sources; ++s)
+			if( dict->cursor[s] > 0 && (last == G_MAXUINT ||
+					gydp_dict_merge_compare(dict, s, dict->cursor[s] - 1, last, dict->cursor[last] - 1) > 0) )
+				last = s;
+
+		dict->cursor[last] -= 1;
+		dict->cursor_n -= 1;
+	}
+
+	/* step forward, first key at cursor is merged first */
+	do {
+		best = G_MAXUINT;
+
+		for(guint s = 0; s < dict->sources; ++s)
+			if( dict->cursor[s] < gydp_dict_keys_size(dict->source[s].keys) && (best == G_MAXUINT ||
+					gydp_dict_merge_compare(dict, s, dict->cursor[s], best, dict->cursor[best]) < 0) )
+				best = s;
+
+		if( dict->cursor_n == n )
+			break;
+
+		dict->cursor[best] += 1;
+		dict->cursor_n += 1;
+	} while( TRUE );
+
+	*source = best;
+	return dict->cursor[best];
+}
+
+static guint gydp_dict_merge_prefix(const gchar *key, const gchar *word) {
+	guint i = 0;
+
+	/* compare */
+	while( word[i] && key[i] == word[i] )
+		++i;
+
+	return i;
+}
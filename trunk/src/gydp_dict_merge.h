@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2008 Michał Kurgan <michal.kurgan@moloh.net>
+ *
+ * This file is part of gydpdict.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gydpdict.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GYDP_DICT_MERGE_H__
+#define __GYDP_DICT_MERGE_H__
+
+#include "gydp_global.h"
+
+G_BEGIN_DECLS
+
+typedef struct GydpDictMerge      GydpDictMerge;
+typedef struct GydpDictMergeClass GydpDictMergeClass;
+
+#define GYDP_TYPE_DICT_MERGE            (gydp_dict_merge_get_type ())
+#define GYDP_DICT_MERGE(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), GYDP_TYPE_DICT_MERGE, GydpDictMerge))
+#define GYDP_DICT_MERGE_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass),  GYDP_TYPE_DICT_MERGE, GydpDictMergeClass))
+#define GYDP_IS_DICT_MERGE(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GYDP_TYPE_DICT_MERGE))
+#define GYDP_IS_DICT_MERGE_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass),  GYDP_TYPE_DICT_MERGE))
+#define GYDP_DICT_MERGE_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj),  GYDP_TYPE_DICT_MERGE, GydpDictMergeClass))
+
+GType       gydp_dict_merge_get_type() G_GNUC_CONST;
+
+/* words of every engine in one sorted list, language selects direction
+ * (engines load from their own data dirs, locations are not used) */
+GObject    *gydp_dict_merge_new     ();
+
+G_END_DECLS
+
+#endif /* __GYDP_DICT_MERGE_H__ */
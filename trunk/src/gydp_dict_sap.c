@@ -20,19 +20,47 @@
 #include "gydp_dict.h"
 #include "gydp_dict_sap.h"
 #include "gydp_util.h"
+#include "gydp_arena.h"
+#include "gydp_convert.h"
+#include "gydp_cache.h"
+#include "gydp_words.h"
 #include "gydp_conf.h"
 #include "gydp_app.h"
 
-#include <gio/gio.h>
 #include <stdlib.h>
 #include <string.h>
 
 typedef struct GydpDictSAPWord {
-	gchar *str;    /* word data */
-	gsize offset;  /* definition offset */
-	gsize length;  /* definition length */
+	const gchar *str;   /* word data (utf8, stored in arena) */
+	const gchar *text;  /* definition data (mapped) */
+	gsize length;       /* definition length */
 } GydpDictSAPWord;
 
+typedef struct GydpDictSAPPage {
+	const gchar *data;      /* page data (mapped) */
+	guint16 size;           /* page data size */
+	guint16 offset;         /* definitions offset in page */
+	guint16 words;          /* number of words in page */
+	gsize first;            /* index of first page word */
+	const gchar *key;       /* folded first word (arena) */
+
+	/* decoded page (lazy mode) */
+	GydpDictSAPWord *word;
+	GydpArena *arena;
+	GList *link;            /* position in page cache */
+} GydpDictSAPPage;
+
+typedef struct GydpDictSAPEntry {
+	guint32 str;        /* word offset in cached strings */
+	guint32 text;       /* definition offset in file */
+	guint32 length;     /* definition length */
+} GydpDictSAPEntry;
+
+typedef struct GydpDictSAPText {
+	guint32 text;       /* definition offset in file */
+	guint32 length;     /* definition length */
+} GydpDictSAPText;
+
 struct GydpDictSAPClass {
 	GydpDictClass __parent__;
 };
@@ -40,12 +68,40 @@ struct GydpDictSAPClass {
 struct GydpDictSAP {
 	GydpDict __parent__;
 
-	/* dictionary stream */
-	GInputStream *stream;
+	/* settings (read by configure) */
+	gint pages_limit;       /* page cache size, lazy mode is used if set */
+	gint compact_mode;      /* front coded words and keys are kept if set */
+
+	/* dictionary file mapping */
+	GMappedFile *file;
 
 	/* dictionary data */
 	GydpDictSAPWord *word;
 	gsize words;
+
+	/* converted words storage */
+	GydpArena *arena;
+
+	/* folded search keys */
+	GydpDictKeys *keys;
+
+	/* index cache (words and keys are used in place) */
+	GydpCache *cache;
+
+	/* lazy mode (words are decoded per page on first access) */
+	GydpDictSAPPage *page;
+	gsize pages;
+	GQueue *cached;         /* decoded pages, recently used first */
+	guint limit;            /* maximal number of decoded pages */
+	guint32 *keyed;         /* pages with words, first words in binary order */
+	gsize keyed_pages;      /* number of keyed pages (zero if not in order) */
+	GString *buffer;        /* word copied from page or decoded (valid until next word) */
+
+	/* compact mode (words and search keys are front coded) */
+	GydpWords *compact;               /* words in dictionary order */
+	GydpWords *compact_keys;          /* folded words in binary order */
+	const guint32 *compact_order;     /* entry of every folded word */
+	const GydpDictSAPText *compact_text; /* definition of every entry */
 };
 
 /* perent class holder */
@@ -60,16 +116,39 @@ static void     gydp_dict_sap_finalize   (GObject *object);
 /* virtual functions */
 static gboolean     gydp_dict_sap_load(GydpDict *dict, gchar **locations, GydpLang lang);
 static gboolean     gydp_dict_sap_lang(GydpDict *dict, GydpLang lang);
+static void         gydp_dict_sap_configure(GydpDict *dict);
 static guint        gydp_dict_sap_size(GydpDict *dict);
 static const gchar *gydp_dict_sap_word(GydpDict *dict, guint n);
-static gboolean     gydp_dict_sap_text(GydpDict *dict, guint n, GtkTextBuffer *buffer);
+static gboolean     gydp_dict_sap_text(GydpDict *dict, guint n, GydpText *text);
+static guint        gydp_dict_sap_find(GydpDict *dict, const gchar *word);
+static GydpDictKeys *gydp_dict_sap_keys(GydpDict *dict);
+static gsize        gydp_dict_sap_memory(GydpDict *dict);
 
 /* private utility functions */
-static void         gydp_dict_sap_unload(GydpDictSAP *dict);
+static void         gydp_dict_sap_unload (GydpDictSAP *dict);
+static gboolean     gydp_dict_sap_restore(GydpDictSAP *dict, GydpCache *cache);
+static void         gydp_dict_sap_store  (GydpDictSAP *dict, GydpCache *cache);
+
+/* private page functions (pages of dictionary file) */
+static gboolean     gydp_dict_sap_page_read(GydpDictSAPPage *page, const gchar *data, gsize size,
+                                            gsize start, gsize words);
+static gsize        gydp_dict_sap_page_walk(const GydpDictSAPPage *page, GydpArena *arena,
+                                            GydpDictSAPWord *word);
+
+/* private compact mode functions */
+static void         gydp_dict_sap_compact        (GydpDictSAP *dict);
+static gboolean     gydp_dict_sap_compact_restore(GydpDictSAP *dict, GydpCache *cache);
+static void         gydp_dict_sap_compact_store  (GydpDictSAP *dict, GydpCache *cache);
+static gint         gydp_dict_sap_compact_compare(gconstpointer a, gconstpointer b, gpointer data);
+
+/* private lazy mode functions */
+static gboolean         gydp_dict_sap_index  (GydpDictSAP *dict, guint32 words, guint32 pages);
+static GydpDictSAPWord *gydp_dict_sap_entry  (GydpDictSAP *dict, guint n);
+static GydpDictSAPPage *gydp_dict_sap_decode (GydpDictSAP *dict, GydpDictSAPPage *page);
+static void             gydp_dict_sap_release(GydpDictSAPPage *page);
 
 /* external private conversion functions */
-gchar    *gydp_convert_sap       (const gchar *text);
-gboolean  gydp_convert_sap_widget(const gchar *word, const gchar *text, gsize len, GtkTextBuffer *widget);
+gboolean  gydp_convert_sap_text(const gchar *word, const gchar *text, gsize len, GydpText *output);
 
 GType gydp_dict_sap_get_type() {
 	static GType type = G_TYPE_INVALID;
@@ -110,11 +189,15 @@ static void gydp_dict_sap_class_init(GydpDictSAPClass *klass) {
 	GydpDictClass *dict_klass = GYDP_DICT_CLASS(klass);
 	dict_klass->load = gydp_dict_sap_load;
 	dict_klass->lang = gydp_dict_sap_lang;
+	dict_klass->configure = gydp_dict_sap_configure;
 
 	dict_klass->size = gydp_dict_sap_size;
 	dict_klass->word = gydp_dict_sap_word;
 	dict_klass->text = gydp_dict_sap_text;
-	dict_klass->find = gydp_dict_find_f;
+	dict_klass->find = gydp_dict_sap_find;
+	dict_klass->fuzzy = gydp_dict_fuzzy_f;
+	dict_klass->keys = gydp_dict_sap_keys;
+	dict_klass->memory = gydp_dict_sap_memory;
 }
 
 static GObject *gydp_dict_sap_constructor(GType type, guint n, GObjectConstructParam *properties) {
@@ -131,6 +214,8 @@ static void gydp_dict_sap_finalize(GObject *object) {
 
 	/* unload dictionary */
 	gydp_dict_sap_unload(self);
+	if( self->buffer != NULL )
+		g_string_free(self->buffer, TRUE);
 
 	/* chain to parent finalize */
 	gydp_dict_sap_parent_class->finalize(object);
@@ -143,6 +228,7 @@ static gboolean gydp_dict_sap_load(GydpDict *dict, gchar **locations, GydpLang l
 	g_return_val_if_fail(dict->engine == GYDP_ENGINE_SAP, FALSE);
 
 	GydpDictSAP *self = GYDP_DICT_SAP(dict);
+	const gint limit = self->pages_limit, compact = self->compact_mode;
 	const char *filename = NULL;
 
 	/* close previously opened dictionary */
@@ -161,99 +247,120 @@ static gboolean gydp_dict_sap_load(GydpDict *dict, gchar **locations, GydpLang l
 	/* load variables */
 	gboolean if_ok = FALSE, if_error = FALSE;
 	gsize offset_words = 0;
-	guint32 *offset = NULL;
-	GInputStream *stream = NULL;
+	GMappedFile *file = NULL;
+	GydpCache *cache = NULL;
 
 	/* load dictionary */
 	while( TRUE ) {
-		guint32 magic, words, pages;
-		gchar page[16384];
+		guint32 words, pages;
 
-		/* try to open input streams */
+		/* try to map dictionary file */
 		for(; *locations != NULL; ++locations)
-			if( (stream = gydp_file_open(*locations, filename)) != NULL )
+			if( (file = gydp_file_map(*locations, filename)) != NULL )
 				break;
 
-		/* detect failure and save data stream */
-		if( (self->stream = stream) == NULL )
+		/* detect failure and save mapped file */
+		if( (self->file = file) == NULL )
 			break;
 
-		/* read main header and validate format */
-		if( g_input_stream_read(self->stream, &magic, 4, NULL, NULL) != 4 ||
-				GUINT32_FROM_LE(magic) != 0xFADEABBA ||
-				g_input_stream_read(self->stream, &words, 4, NULL, NULL) != 4 ||
-				g_input_stream_read(self->stream, &pages, 4, NULL, NULL) != 4 )
+		const gchar *data = g_mapped_file_get_contents(file);
+		const gsize size = g_mapped_file_get_length(file);
+
+		/* validate main header and format */
+		if( size < 12 || gydp_read_uint32(data) != 0xFADEABBA )
 			break;
 
-		words = GUINT32_FROM_LE(words);
-		pages = GUINT32_FROM_LE(pages);
+		words = gydp_read_uint32(data + 4);
+		pages = gydp_read_uint32(data + 8);
 
-		/* allocate data in dictionary */
-		self->word = g_malloc0(words * sizeof(GydpDictSAPWord ));
-		self->words = words;
+		/* validate sizes (every word takes at least 3 bytes of page) */
+		if( pages > (size - 12) / 4 || words > size / 3 )
+			break;
 
-		/* read offsets */
-		offset = g_malloc(pages * sizeof(guint32));
-		if( g_input_stream_read(self->stream, offset, pages * 4, NULL, NULL) != (gssize)(pages * 4) )
+		/* dictionary file identifies index caches */
+		gchar *path = g_build_filename(*locations, filename, NULL);
+		const gchar *sources[] = { path, NULL };
+		gydp_dict_set_sources(dict, sources);
+		g_free(path);
+
+		/* lazy mode reads only page table */
+		if( limit > 0 ) {
+			self->limit = MAX(limit, 2);
+			if( (if_ok = gydp_dict_sap_index(self, words, pages)) )
+				gydp_dict_progress(dict, self->words);
 			break;
+		}
 
-		for(gsize i = 0; i < pages; ++i)
-			offset[i] = GUINT32_FROM_LE(offset[i]);
+		/* use index cache if it is up to date with dictionary file */
+		if( compact > 0 ) {
+			gchar *name = g_strconcat(gydp_engine_value_to_nick(dict->engine), "-compact", NULL);
+			cache = gydp_cache_new(name, gydp_dict_sources(dict));
+			g_free(name);
 
-		/* read pages */
+			if( gydp_cache_load(cache) && gydp_dict_sap_compact_restore(self, cache) ) {
+				gydp_dict_progress(dict, self->words);
+				if_ok = TRUE;
+				break;
+			}
+		} else {
+			cache = gydp_cache_new(gydp_engine_value_to_nick(dict->engine), gydp_dict_sources(dict));
+
+			if( gydp_cache_load(cache) && gydp_dict_sap_restore(self, cache) ) {
+				gydp_dict_progress(dict, self->words);
+				if_ok = TRUE;
+				break;
+			}
+		}
+
+		/* allocate data in dictionary */
+		self->word = g_malloc0(words * sizeof(GydpDictSAPWord));
+		self->words = words;
+		self->arena = gydp_arena_new(0);
+
+		/* page offsets are addressed directly in mapping */
+		const gchar *offset = data + 12;
+
+		/* index pages */
 		for(gsize i = 0; i < pages; ++i, if_error = FALSE) {
-			guint16 page_words, page_size, page_offset;
+			GydpDictSAPPage page;
 
 			/* assume error */
 			if_error = TRUE;
 
-			/* read page header */
-			if( !g_seekable_seek(G_SEEKABLE(self->stream), offset[i], G_SEEK_SET, NULL, NULL) ||
-					g_input_stream_read(self->stream, &page_words, 2, NULL, NULL) != 2 ||
-					g_input_stream_read(self->stream, &page_size, 2, NULL, NULL) != 2 ||
-					g_input_stream_read(self->stream, &page_offset, 2, NULL, NULL) != 2 )
+			/* extract word links and definitions of all page words */
+			if( !gydp_dict_sap_page_read(&page, data, size, gydp_read_uint32(offset + 4 * i),
+						words - offset_words) ||
+					gydp_dict_sap_page_walk(&page, self->arena, self->word + offset_words) < page.words )
 				break;
 
-			page_words = GUINT16_FROM_LE(page_words);
-			page_size = GUINT16_FROM_LE(page_size);
-			page_offset = GUINT16_FROM_LE(page_offset);
+			/* update offset */
+			offset_words += page.words;
 
-			/* read page */
-			if( g_input_stream_read(self->stream, page, page_size, NULL, NULL) != (gssize)page_size )
+			/* publish loaded words (compact mode replaces them when done) */
+			if( compact > 0? gydp_dict_cancelled(dict): !gydp_dict_progress(dict, offset_words) )
 				break;
-
-			/* extract word links and definition offsets */
-			gchar *page_word = page + page_words * sizeof(gint16);
-			gint16 *length = (gint16 *)page;
-			gsize definition_offset = offset[i] + page_offset + 6;
-			for(gsize x = 0; x < page_words; definition_offset += length[x], ++x) {
-				/* fill all word fields */
-				self->word[x + offset_words].str = gydp_convert_sap(page_word);
-				self->word[x + offset_words].offset = definition_offset;
-				self->word[x + offset_words].length = length[x];
-
-				/* move to next word */
-				page_word += strlen(page_word) + 1;
-			}
-
-			/* update offset */
-			offset_words += page_words;
 		}
 
 		/* check if all pages load correctly */
 		if( if_error )
 			break;
 
+		/* skip words not described by any page */
+		self->words = offset_words;
+
 		/* confirm successful read */
 		if_ok = TRUE;
 		break;
 	}
 
-	g_free(offset);
-
 	/* check if import was correct */
 	if( !if_ok || if_error ) {
 		gydp_dict_sap_unload(self);
+		gydp_cache_free(cache);
+
+		/* cancelled load is not an error */
+		if( gydp_dict_cancelled(dict) )
+			return FALSE;
 
 		if( *locations == NULL )
 			g_printerr("Error loading '%s' dictionary by SAP engine. Missing dictionary files.\n",
@@ -265,12 +372,25 @@ static gboolean gydp_dict_sap_load(GydpDict *dict, gchar **locations, GydpLang l
 		return FALSE;
 	}
 
+	/* index was parsed from dictionary file */
+	if( self->cache == NULL && self->page == NULL ) {
+		if( compact > 0 ) {
+			/* front code words and search keys */
+			gydp_dict_sap_compact(self);
+			gydp_dict_sap_compact_store(self, cache);
+		} else {
+			/* build search keys */
+			self->keys = gydp_dict_keys_new(dict);
+			gydp_dict_sap_store(self, cache);
+		}
+
+		/* index cache is stored for next load */
+		gydp_cache_free(cache);
+	}
+
 	/* set current language */
 	dict->language = lang;
 
-	/* indicate that dictionary changed */
-	gydp_dict_changed(dict);
-
 	return TRUE;
 }
 
@@ -283,6 +403,15 @@ static gboolean gydp_dict_sap_lang(GydpDict *dict G_GNUC_UNUSED, GydpLang lang)
 	return FALSE;
 }
 
+static void gydp_dict_sap_configure(GydpDict *dict) {
+	GydpDictSAP *self = GYDP_DICT_SAP(dict);
+	GydpConf *config = g_object_get_data(G_OBJECT(gydp_app()), GYDP_APP_CONF);
+	const gchar *nick = gydp_engine_value_to_nick(dict->engine);
+
+	self->pages_limit = gydp_conf_get_integer(config, nick, "pages");
+	self->compact_mode = gydp_conf_get_integer(config, nick, "compact");
+}
+
 static guint gydp_dict_sap_size(GydpDict *dict) {
 	GydpDictSAP *self = GYDP_DICT_SAP(dict);
 	return self->words;
@@ -293,60 +422,588 @@ static const gchar *gydp_dict_sap_word(GydpDict *dict, guint n) {
 
 	if( n >= self->words )
 		return NULL;
-	return self->word[n].str;
+	if( self->compact == NULL && self->page == NULL )
+		return self->word[n].str;
+
+	/* words of evicted pages are released and decoded blocks are reused,
+	 * so word is copied */
+	if( self->buffer == NULL )
+		self->buffer = g_string_new(NULL);
+	if( self->compact != NULL )
+		gydp_words_copy(self->compact, n, self->buffer);
+	else
+		g_string_assign(self->buffer, gydp_dict_sap_entry(self, n)->str);
+
+	return self->buffer->str;
 }
 
-static gboolean gydp_dict_sap_text(GydpDict *dict, guint n, GtkTextBuffer *buffer) {
-	GydpDictSAP *self = GYDP_DICT_SAP(dict);
-	GtkTextIter begin, end;
+static gboolean gydp_dict_sap_text(GydpDict *dict, guint n, GydpText *text) {
+	const gchar *word, *data;
+	gsize length;
 
-	/* clear buffer */
-	gtk_text_buffer_get_start_iter(buffer, &begin);
-	gtk_text_buffer_get_end_iter(buffer, &end);
-	gtk_text_buffer_delete(buffer, &begin, &end);
+	/* clear text */
+	gydp_text_clear(text);
 
-	if( n >= self->words )
+	if( !gydp_dict_sap_raw(GYDP_DICT_SAP(dict), n, &word, &data, &length) )
 		return FALSE;
 
-	/* variadic array for definition */
-	gchar text[ self->word[n].length ];
+	/* convert mapped definition to text */
+	gydp_convert_sap_text(word, data, length, text);
+
+	return TRUE;
+}
 
-	if( !g_seekable_seek(G_SEEKABLE(self->stream), self->word[n].offset, G_SEEK_SET, NULL, NULL) ||
-			g_input_stream_read(self->stream, text, self->word[n].length, NULL, NULL) != (gssize)self->word[n].length )
+gboolean gydp_dict_sap_raw(GydpDictSAP *self, guint n, const gchar **word,
+                           const gchar **text, gsize *length) {
+	if( n >= self->words )
 		return FALSE;
 
-	/* convert raw text to buffer */
-	gydp_convert_sap_widget(self->word[n].str, text, self->word[n].length, buffer);
+	/* definition of front coded word */
+	if( self->compact != NULL ) {
+		*word = gydp_words_get(self->compact, n);
+		*text = g_mapped_file_get_contents(self->file) + self->compact_text[n].text;
+		*length = self->compact_text[n].length;
+		return TRUE;
+	}
+
+	GydpDictSAPWord *entry = gydp_dict_sap_entry(self, n);
+	*word = entry->str;
+	*text = entry->text;
+	*length = entry->length;
 
 	return TRUE;
 }
 
+/** gydp_dict_sap_find
+ * in lazy mode first words of pages select last page starting before
+ * word, search continues like linear search in this and next page only
+ * (pages are selected only if their first words are in binary order)
+ */
+static guint gydp_dict_sap_find(GydpDict *dict, const gchar *word) {
+	GydpDictSAP *self = GYDP_DICT_SAP(dict);
+	guint prev = 0, i = 0, n, last;
+	gsize p, next, lower, upper;
+
+	/* all words or keys are available or pages can not be selected */
+	if( self->page == NULL || self->keyed_pages == 0 )
+		return gydp_dict_find_f(dict, word);
+
+	/* validate size */
+	if( self->words == 0 )
+		return 0;
+
+	/* process word for comprison */
+	gchar *find = gydp_str_process(word);
+	const gsize length = strlen(find);
+
+	/* check for string length */
+	if( length == 0 ) {
+		g_free(find);
+		return 0;
+	}
+
+	/* first page with first word not less than word */
+	for(lower = 0, upper = self->keyed_pages; lower < upper;) {
+		const gsize middle = lower + (upper - lower) / 2;
+		if( strcmp(self->page[self->keyed[middle]].key, find) < 0 )
+			lower = middle + 1;
+		else
+			upper = middle;
+	}
+
+	/* search words from previous page to the end of this one */
+	p = lower > 0? self->keyed[lower - 1]: 0;
+	next = lower < self->keyed_pages? self->keyed[lower]: p;
+	n = self->page[p].first;
+	last = self->page[next].first + self->page[next].words;
+
+	for(; n < last; ++n, prev = i) {
+		gchar *key = gydp_str_process(gydp_dict_sap_entry(self, n)->str);
+
+		/* compare */
+		for(i = 0; i < length; ++i)
+			if( find[i] != key[i] )
+				break;
+
+		/* free temporary data */
+		g_free(key);
+
+		/* completely compatible item found */
+		if( i == length )
+			break;
+
+		/* previous item is more compatible */
+		if( i < prev ) {
+			--n;
+			break;
+		}
+	}
+
+	/* free temporary data */
+	g_free(find);
+
+	return MIN(n, last - 1);
+}
+
+static GydpDictKeys *gydp_dict_sap_keys(GydpDict *dict) {
+	GydpDictSAP *self = GYDP_DICT_SAP(dict);
+	return self->keys;
+}
+
+/** gydp_dict_sap_memory
+ * parsed words and their strings, page table with decoded pages and
+ * front coded words with definition table (compact keys are search keys)
+ */
+static gsize gydp_dict_sap_memory(GydpDict *dict) {
+	GydpDictSAP *self = GYDP_DICT_SAP(dict);
+	gsize result = 0;
+
+	if( self->word != NULL )
+		result += self->words * sizeof(GydpDictSAPWord);
+	if( self->arena != NULL )
+		result += gydp_arena_size(self->arena);
+
+	result += self->pages * sizeof(GydpDictSAPPage) + self->keyed_pages * sizeof(guint32);
+	for(GList *link = self->cached != NULL? self->cached->head: NULL; link != NULL; link = link->next) {
+		GydpDictSAPPage *page = link->data;
+		result += page->words * sizeof(GydpDictSAPWord) + gydp_arena_size(page->arena);
+	}
+
+	if( self->compact != NULL )
+		result += gydp_words_memory(self->compact) + self->words * sizeof(GydpDictSAPText);
+
+	return result;
+}
+
 static void gydp_dict_sap_unload(GydpDictSAP *dict) {
 
 	/* validation */
 	g_return_if_fail(GYDP_IS_DICT_SAP(dict));
 	g_return_if_fail(GYDP_DICT(dict)->engine == GYDP_ENGINE_SAP);
 
-	/* detach stream */
-	if( dict->stream )
-		g_input_stream_close(dict->stream, NULL, NULL);
+	/* free converted words at once */
+	gydp_arena_free(dict->arena);
 
-	/* free words and definitions */
-	for(gsize i = 0; i < dict->words; ++i)
-		g_free(dict->word[i].str);
+	/* free search keys */
+	gydp_dict_keys_free(dict->keys);
+
+	/* free front coded words (tables are owned unless mapped from cache) */
+	gydp_words_free(dict->compact);
+	gydp_words_free(dict->compact_keys);
+	if( dict->cache == NULL ) {
+		g_free((gpointer)dict->compact_order);
+		g_free((gpointer)dict->compact_text);
+	}
 
 	/* free arrays */
 	g_free(dict->word);
 
+	/* free decoded pages */
+	for(gsize i = 0; i < dict->pages; ++i)
+		gydp_dict_sap_release(&dict->page[i]);
+	g_free(dict->page);
+	g_free(dict->keyed);
+	if( dict->cached )
+		g_queue_free(dict->cached);
+
+	/* detach mappings (after all mapped data is released) */
+	gydp_cache_free(dict->cache);
+	if( dict->file )
+		g_mapped_file_free(dict->file);
+
 	/* reset data */
-	dict->stream = NULL;
+	dict->file = NULL;
 	dict->word = NULL;
 	dict->words = 0;
+	dict->arena = NULL;
+	dict->keys = NULL;
+	dict->cache = NULL;
+	dict->page = NULL;
+	dict->pages = 0;
+	dict->cached = NULL;
+	dict->limit = 0;
+	dict->keyed = NULL;
+	dict->keyed_pages = 0;
+	dict->compact = NULL;
+	dict->compact_keys = NULL;
+	dict->compact_order = NULL;
+	dict->compact_text = NULL;
 
 	/* reset current dictionary */
 	GYDP_DICT(dict)->language = GYDP_LANG_NONE;
+}
+
+
+/** gydp_dict_sap_restore
+ * use words and keys from index cache, offsets are validated against
+ * dictionary mapping so outdated or broken cache is simply rejected
+ */
+static gboolean gydp_dict_sap_restore(GydpDictSAP *dict, GydpCache *cache) {
+	const gchar *data = g_mapped_file_get_contents(dict->file);
+	const gsize size = g_mapped_file_get_length(dict->file);
+	gsize words, length;
+
+	/* get cache sections */
+	const GydpDictSAPEntry *entry = gydp_cache_get(cache, GYDP_CACHE_WORDS, &words);
+	const gchar *strings = gydp_cache_get(cache, GYDP_CACHE_STRINGS, &length);
+
+	/* validate sections */
+	if( words % sizeof(GydpDictSAPEntry) != 0 ||
+			(words > 0 && (length == 0 || strings[length - 1] != '\0')) )
+		return FALSE;
+	words /= sizeof(GydpDictSAPEntry);
+
+	for(gsize n = 0; n < words; ++n)
+		if( entry[n].str >= length || entry[n].text > size ||
+				entry[n].length > size - entry[n].text )
+			return FALSE;
+
+	/* use cached search keys */
+	if( (dict->keys = gydp_dict_keys_restore(cache, words)) == NULL )
+		return FALSE;
 
-	/* indicate that dictionary changed */
-	gydp_dict_changed(GYDP_DICT(dict));
+	/* words point directly into mappings */
+	dict->word = g_malloc(words * sizeof(GydpDictSAPWord));
+	dict->words = words;
+	dict->cache = cache;
+
+	for(gsize n = 0; n < words; ++n) {
+		dict->word[n].str = strings + entry[n].str;
+		dict->word[n].text = data + entry[n].text;
+		dict->word[n].length = entry[n].length;
+	}
+
+	return TRUE;
+}
+
+static void gydp_dict_sap_store(GydpDictSAP *dict, GydpCache *cache) {
+	const gchar *data = g_mapped_file_get_contents(dict->file);
+	GydpDictSAPEntry *entry = g_malloc(dict->words * sizeof(GydpDictSAPEntry));
+	GString *strings = g_string_sized_new(gydp_arena_size(dict->arena));
+
+	/* words are stored as offsets */
+	for(gsize n = 0; n < dict->words; ++n) {
+		entry[n].str = strings->len;
+		entry[n].text = dict->word[n].text - data;
+		entry[n].length = dict->word[n].length;
+
+		g_string_append_len(strings, dict->word[n].str, strlen(dict->word[n].str) + 1);
+	}
+
+	/* save cache */
+	gydp_cache_set(cache, GYDP_CACHE_WORDS, entry, dict->words * sizeof(GydpDictSAPEntry));
+	gydp_cache_set(cache, GYDP_CACHE_STRINGS, strings->str, strings->len);
+	gydp_dict_keys_store(dict->keys, cache);
+	gydp_cache_save(cache);
+
+	/* free temporary data */
+	g_string_free(strings, TRUE);
+	g_free(entry);
+}
+
+/** gydp_dict_sap_page_read
+ * read header of page starting at start of mapped file, page has to lie
+ * within file, hold at most words words and have its definitions within it
+ */
+static gboolean gydp_dict_sap_page_read(GydpDictSAPPage *page, const gchar *data, gsize size,
+                                        gsize start, gsize words) {
+	/* validate page header */
+	if( start > size || size - start < 6 )
+		return FALSE;
+
+	page->words = gydp_read_uint16(data + start);
+	page->size = gydp_read_uint16(data + start + 2);
+	page->offset = gydp_read_uint16(data + start + 4);
+	page->data = data + start + 6;
+
+	/* validate page */
+	return page->size <= size - start - 6 &&
+			page->words <= words &&
+			page->words * sizeof(guint16) <= page->size &&
+			page->offset <= page->size;
+}
+
+/** gydp_dict_sap_page_walk
+ * convert words of page into arena and point them to their definitions
+ * (validated by gydp_dict_sap_page_read), number of valid words is returned
+ * NOTE: definitions running out of page are broken, as page lies within
+ *       mapped file they are never read outside of it
+ */
+static gsize gydp_dict_sap_page_walk(const GydpDictSAPPage *page, GydpArena *arena,
+                                     GydpDictSAPWord *word) {
+	const gchar *page_end = page->data + page->size;
+	const gchar *page_word = page->data + page->words * sizeof(guint16);
+	const gchar *definition = page->data + page->offset;
+	gsize x;
+
+	for(x = 0; x < page->words; ++x) {
+		const gsize length = gydp_read_uint16(page->data + x * sizeof(guint16));
+		const gchar *word_end = memchr(page_word, '\0', page_end - page_word);
+
+		/* validate word and definition bounds */
+		if( word_end == NULL || length > (gsize)(page_end - definition) )
+			break;
+
+		/* convert word into arena */
+		word[x].str = gydp_convert_arena(GYDP_CODEPAGE_ISO88592, arena, page_word, word_end - page_word);
+
+		/* fill remaining word fields */
+		word[x].text = definition;
+		word[x].length = length;
+
+		/* move to next word */
+		page_word = word_end + 1;
+		definition += length;
+	}
+
+	return x;
 }
 
+/** gydp_dict_sap_compact
+ * replace parsed words with front coded words and folded keys, folded
+ * keys are sorted and wrapped as search keys of dictionary
+ */
+static void gydp_dict_sap_compact(GydpDictSAP *dict) {
+	const gchar *data = g_mapped_file_get_contents(dict->file);
+	GydpDictSAPText *text = g_malloc(dict->words * sizeof(GydpDictSAPText));
+	guint32 *order = g_malloc(dict->words * sizeof(guint32));
+	gchar **key = g_malloc(dict->words * sizeof(gchar *));
+
+	/* words in dictionary order */
+	dict->compact = gydp_words_new();
+	for(gsize n = 0; n < dict->words; ++n) {
+		gydp_words_append(dict->compact, dict->word[n].str);
+		text[n].text = dict->word[n].text - data;
+		text[n].length = dict->word[n].length;
+		key[n] = gydp_str_process(dict->word[n].str);
+		order[n] = n;
+	}
+
+	/* folded words in binary order */
+	g_qsort_with_data(order, dict->words, sizeof(guint32), gydp_dict_sap_compact_compare, key);
+	dict->compact_keys = gydp_words_new();
+	for(gsize i = 0; i < dict->words; ++i)
+		gydp_words_append(dict->compact_keys, key[order[i]]);
+
+	dict->compact_order = order;
+	dict->compact_text = text;
+	dict->keys = gydp_dict_keys_wrap(dict->compact_keys, dict->compact_order);
+
+	/* parsed words are no longer needed */
+	for(gsize n = 0; n < dict->words; ++n)
+		g_free(key[n]);
+	g_free(key);
+	g_free(dict->word);
+	gydp_arena_free(dict->arena);
+	dict->word = NULL;
+	dict->arena = NULL;
+}
+
+/** gydp_dict_sap_compact_restore
+ * use front coded words and tables directly from index cache, offsets
+ * are validated against dictionary mapping
+ */
+static gboolean gydp_dict_sap_compact_restore(GydpDictSAP *dict, GydpCache *cache) {
+	const gsize size = g_mapped_file_get_length(dict->file);
+	gsize words, order_size;
+
+	/* get cache sections */
+	const GydpDictSAPText *text = gydp_cache_get(cache, GYDP_CACHE_COMPACT_TEXTS, &words);
+	const guint32 *order = gydp_cache_get(cache, GYDP_CACHE_COMPACT_ORDER, &order_size);
+
+	/* validate sections */
+	if( words % sizeof(GydpDictSAPText) != 0 )
+		return FALSE;
+	words /= sizeof(GydpDictSAPText);
+
+	if( order_size != words * sizeof(guint32) )
+		return FALSE;
+
+	for(gsize n = 0; n < words; ++n)
+		if( order[n] >= words || text[n].text > size || text[n].length > size - text[n].text )
+			return FALSE;
+
+	dict->compact = gydp_words_restore(cache, GYDP_CACHE_COMPACT_WORDS, GYDP_CACHE_COMPACT_BLOCKS, words);
+	dict->compact_keys = gydp_words_restore(cache, GYDP_CACHE_COMPACT_KEYS, GYDP_CACHE_COMPACT_KEY_BLOCKS, words);
+
+	if( dict->compact == NULL || dict->compact_keys == NULL ) {
+		gydp_words_free(dict->compact);
+		gydp_words_free(dict->compact_keys);
+		dict->compact = NULL;
+		dict->compact_keys = NULL;
+		return FALSE;
+	}
+
+	/* tables point directly into mapping */
+	dict->compact_order = order;
+	dict->compact_text = text;
+	dict->words = words;
+	dict->cache = cache;
+	dict->keys = gydp_dict_keys_wrap(dict->compact_keys, dict->compact_order);
+
+	return TRUE;
+}
+
+static void gydp_dict_sap_compact_store(GydpDictSAP *dict, GydpCache *cache) {
+	/* save cache */
+	gydp_words_store(dict->compact, cache, GYDP_CACHE_COMPACT_WORDS, GYDP_CACHE_COMPACT_BLOCKS);
+	gydp_words_store(dict->compact_keys, cache, GYDP_CACHE_COMPACT_KEYS, GYDP_CACHE_COMPACT_KEY_BLOCKS);
+	gydp_cache_set(cache, GYDP_CACHE_COMPACT_ORDER, dict->compact_order, dict->words * sizeof(guint32));
+	gydp_cache_set(cache, GYDP_CACHE_COMPACT_TEXTS, dict->compact_text, dict->words * sizeof(GydpDictSAPText));
+	gydp_cache_save(cache);
+}
+
+static gint gydp_dict_sap_compact_compare(gconstpointer a, gconstpointer b, gpointer data) {
+	gchar **key = data;
+	const guint32 x = *(const guint32 *)a, y = *(const guint32 *)b;
+	const gint result = strcmp(key[x], key[y]);
+
+	/* keep dictionary order of equal keys */
+	if( result == 0 )
+		return x < y? -1: 1;
+	return result;
+}
+
+/** gydp_dict_sap_index
+ * read page table only, every page gets its first word converted
+ * (for page selection in find), other words are decoded on demand
+ * NOTE: pages are selected only if first words are in binary order,
+ *       otherwise find compares all words
+ */
+static gboolean gydp_dict_sap_index(GydpDictSAP *dict, guint32 words, guint32 pages) {
+	const gchar *data = g_mapped_file_get_contents(dict->file);
+	const gsize size = g_mapped_file_get_length(dict->file);
+	gsize offset_words = 0, i;
+
+	/* allocate pages */
+	dict->page = g_malloc0(pages * sizeof(GydpDictSAPPage));
+	dict->pages = pages;
+	dict->arena = gydp_arena_new(0);
+	dict->cached = g_queue_new();
+
+	for(i = 0; i < pages; ++i) {
+		GydpDictSAPPage *page = &dict->page[i];
+
+		/* validate page */
+		page->first = offset_words;
+		if( !gydp_dict_sap_page_read(page, data, size, gydp_read_uint32(data + 12 + 4 * i),
+					words - offset_words) )
+			break;
+
+		/* convert and fold first word */
+		if( page->words > 0 ) {
+			const gchar *page_word = page->data + page->words * sizeof(guint16);
+			const gchar *page_end = page->data + page->size;
+
+			const gchar *word_end = memchr(page_word, '\0', page_end - page_word);
+			if( word_end == NULL )
+				break;
+
+			const gsize len = word_end - page_word;
+			gchar *str = g_malloc(GYDP_CONVERT_MAX * len + 1);
+			*gydp_convert_buffer(GYDP_CODEPAGE_ISO88592, page_word, len, str) = '\0';
+			gchar *key = gydp_str_process(str);
+			page->key = gydp_arena_insert(dict->arena, key, -1);
+
+			/* free temporary data */
+			g_free(key);
+			g_free(str);
+		}
+
+		/* update offset */
+		offset_words += page->words;
+	}
+
+	/* skip words not described by any page */
+	dict->words = offset_words;
+
+	if( i < pages )
+		return FALSE;
+
+	/* pages with words are searched by their first words */
+	dict->keyed = g_malloc(pages * sizeof(guint32));
+	for(i = 0; i < pages; ++i) {
+		if( dict->page[i].words == 0 )
+			continue;
+
+		/* folded words are not in binary order, so is dictionary */
+		if( dict->keyed_pages > 0 &&
+				strcmp(dict->page[dict->keyed[dict->keyed_pages - 1]].key, dict->page[i].key) > 0 ) {
+			dict->keyed_pages = 0;
+			break;
+		}
+		dict->keyed[dict->keyed_pages++] = i;
+	}
+
+	return TRUE;
+}
+
+static GydpDictSAPWord *gydp_dict_sap_entry(GydpDictSAP *dict, guint n) {
+	gsize lower = 0, upper = dict->pages;
+
+	/* all words are available */
+	if( dict->page == NULL )
+		return &dict->word[n];
+
+	/* find last page starting before word */
+	while( upper - lower > 1 ) {
+		const gsize middle = lower + (upper - lower) / 2;
+		if( dict->page[middle].first <= n )
+			lower = middle;
+		else
+			upper = middle;
+	}
+
+	/* decode page if needed */
+	GydpDictSAPPage *page = gydp_dict_sap_decode(dict, &dict->page[lower]);
+	return &page->word[n - page->first];
+}
+
+/** gydp_dict_sap_decode
+ * decode all words of page, page cache keeps recently used pages
+ * NOTE: words of evicted pages are released, so word strings are
+ *       valid only until other pages are accessed
+ */
+static GydpDictSAPPage *gydp_dict_sap_decode(GydpDictSAP *dict, GydpDictSAPPage *page) {
+	/* page already decoded, mark as recently used */
+	if( page->word != NULL ) {
+		g_queue_unlink(dict->cached, page->link);
+		g_queue_push_head_link(dict->cached, page->link);
+		return page;
+	}
+
+	/* evict least recently used pages */
+	while( g_queue_get_length(dict->cached) >= dict->limit )
+		gydp_dict_sap_release(g_queue_pop_tail(dict->cached));
+
+	/* converted words take at most twice page size (tails are returned to arena) */
+	page->word = g_malloc(page->words * sizeof(GydpDictSAPWord));
+	page->arena = gydp_arena_new(2 * page->size);
+
+	/* extract word links and definitions (page header was validated by index) */
+	gsize x = gydp_dict_sap_page_walk(page, page->arena, page->word);
+
+	/* broken words are left empty */
+	for(; x < page->words; ++x) {
+		page->word[x].str = "";
+		page->word[x].text = page->data;
+		page->word[x].length = 0;
+	}
+
+	/* add page to cache */
+	g_queue_push_head(dict->cached, page);
+	page->link = dict->cached->head;
+
+	return page;
+}
+
+static void gydp_dict_sap_release(GydpDictSAPPage *page) {
+	/* free decoded words */
+	gydp_arena_free(page->arena);
+	g_free(page->word);
+
+	/* reset page */
+	page->word = NULL;
+	page->arena = NULL;
+	page->link = NULL;
+}
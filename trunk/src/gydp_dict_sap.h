@@ -38,6 +38,11 @@ typedef struct GydpDictSAPClass GydpDictSAPClass;
 GType       gydp_dict_sap_get_type() G_GNUC_CONST;
 GObject    *gydp_dict_sap_new     ();
 
+/* word and mapped definition of entry before conversion (word is valid
+ * only until next entry is requested), used by benchmark */
+gboolean    gydp_dict_sap_raw     (GydpDictSAP *dict, guint n, const gchar **word,
+                                   const gchar **text, gsize *length);
+
 G_END_DECLS
 
 #endif /* __GYDP_DICT_SAP_H__ */
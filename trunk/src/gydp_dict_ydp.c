@@ -20,6 +20,9 @@
 #include "gydp_dict.h"
 #include "gydp_dict_ydp.h"
 #include "gydp_util.h"
+#include "gydp_arena.h"
+#include "gydp_convert.h"
+#include "gydp_cache.h"
 #include "gydp_conf.h"
 #include "gydp_app.h"
 
@@ -27,10 +30,15 @@
 #include <string.h>
 
 typedef struct GydpDictYDPWord {
-	gchar *str;    /* word data */
-	gsize offset;  /* definition offset */
+	const gchar *str;  /* word data (utf8, stored in arena) */
+	gsize offset;      /* definition offset */
 } GydpDictYDPWord;
 
+typedef struct GydpDictYDPEntry {
+	guint32 str;       /* word offset in cached strings */
+	guint32 offset;    /* definition offset */
+} GydpDictYDPEntry;
+
 struct GydpDictYDPClass {
 	GydpDictClass __parent__;
 };
@@ -38,12 +46,21 @@ struct GydpDictYDPClass {
 struct GydpDictYDP {
 	GydpDict __parent__;
 
-	/* dictionary stream */
-	GInputStream *stream;
+	/* dictionary definitions mapping */
+	GMappedFile *file;
 
 	/* dictionary data */
 	GydpDictYDPWord *word;
 	gsize words;
+
+	/* converted words storage */
+	GydpArena *arena;
+
+	/* folded search keys */
+	GydpDictKeys *keys;
+
+	/* index cache (words and keys are used in place) */
+	GydpCache *cache;
 };
 
 /* perent class holder */
@@ -60,15 +77,17 @@ static gboolean     gydp_dict_ydp_load(GydpDict *dict, gchar **locations, GydpLa
 static gboolean     gydp_dict_ydp_lang(GydpDict *dict, GydpLang lang);
 static guint        gydp_dict_ydp_size(GydpDict *dict);
 static const gchar *gydp_dict_ydp_word(GydpDict *dict, guint n);
-static gboolean     gydp_dict_ydp_text(GydpDict *dict, guint n, GtkTextBuffer *buffer);
+static gboolean     gydp_dict_ydp_text(GydpDict *dict, guint n, GydpText *text);
+static GydpDictKeys *gydp_dict_ydp_keys(GydpDict *dict);
+static gsize        gydp_dict_ydp_memory(GydpDict *dict);
 
 /* private utility functions */
-static void         gydp_dict_ydp_unload(GydpDictYDP *dict);
+static void         gydp_dict_ydp_unload (GydpDictYDP *dict);
+static gboolean     gydp_dict_ydp_restore(GydpDictYDP *dict, GydpCache *cache);
+static void         gydp_dict_ydp_store  (GydpDictYDP *dict, GydpCache *cache);
 
 /* external private conversion functions */
-gchar    *gydp_convert_ydp       (const gchar *text);
-void      gydp_convert_ydp_buffer(const gchar *text, gboolean phonetic, gchar *buffer);
-gboolean  gydp_convert_ydp_widget(const gchar *word, const gchar *text, GtkTextBuffer *widget);
+gboolean  gydp_convert_ydp_text(const gchar *word, const gchar *text, gsize len, GydpText *output);
 
 GType gydp_dict_ydp_get_type() {
 	static GType type = G_TYPE_INVALID;
@@ -114,6 +133,9 @@ static void gydp_dict_ydp_class_init(GydpDictYDPClass *klass) {
 	dict_klass->word = gydp_dict_ydp_word;
 	dict_klass->text = gydp_dict_ydp_text;
 	dict_klass->find = gydp_dict_find_f;
+	dict_klass->fuzzy = gydp_dict_fuzzy_f;
+	dict_klass->keys = gydp_dict_ydp_keys;
+	dict_klass->memory = gydp_dict_ydp_memory;
 }
 
 static GObject *gydp_dict_ydp_constructor(GType type, guint n, GObjectConstructParam *properties) {
@@ -161,62 +183,64 @@ static gboolean gydp_dict_ydp_load(GydpDict *dict, gchar **locations, GydpLang l
 		g_printerr("Language '%s' is not supported by YDP engine.\n",
 				gydp_lang_value_to_name(lang));
 
-		/* indicate that dictionary changed */
-		gydp_dict_changed(dict);
-
 		return FALSE;
 	}
 
 	/* load variables */
 	gboolean if_ok = FALSE, if_error = FALSE;
-	GString *buffer = g_string_sized_new(128);
-	GInputStream *index = NULL, *stream = NULL;
+	GMappedFile *index = NULL, *file = NULL;
+	GydpCache *cache = NULL;
 
 	while( TRUE ) {
 		guint16 words;
 		guint32 offset;
 
-		/* try to open input streams */
+		/* try to map dictionary files */
 		for(; *locations != NULL; ++locations) {
-			if( (stream = gydp_file_open(*locations, filename[0])) != NULL &&
-					(index = gydp_file_open(*locations, filename[1])) != NULL )
+			if( (file = gydp_file_map(*locations, filename[0])) != NULL &&
+					(index = gydp_file_map(*locations, filename[1])) != NULL )
 				break;
 
-			if( stream != NULL ) {
-				g_input_stream_close(stream, NULL, NULL);
-				stream = NULL;
-			}
-
-			if( index != NULL ) {
-				g_input_stream_close(index, NULL, NULL);
-				index = NULL;
+			if( file != NULL ) {
+				g_mapped_file_free(file);
+				file = NULL;
 			}
 		}
 
-		/* detect failure and save data stream */
-		if( (self->stream = stream) == NULL || index == NULL )
+		/* detect failure and save definitions mapping */
+		if( (self->file = file) == NULL || index == NULL )
 			break;
 
-		/* read size of dictionary */
-		if( !g_seekable_seek(G_SEEKABLE(index), 8, G_SEEK_SET, NULL, NULL) ||
-				g_input_stream_read(index, &words, 2, NULL, NULL) != 2 )
+		/* use index cache if it is up to date with dictionary files */
+		gchar *paths[] = {
+			g_build_filename(*locations, filename[0], NULL),
+			g_build_filename(*locations, filename[1], NULL), NULL };
+		gydp_dict_set_sources(dict, (const gchar *const *)paths);
+		cache = gydp_cache_new(gydp_engine_value_to_nick(dict->engine), gydp_dict_sources(dict));
+		g_free(paths[0]);
+		g_free(paths[1]);
+
+		if( gydp_cache_load(cache) && gydp_dict_ydp_restore(self, cache) ) {
+			gydp_dict_progress(dict, self->words);
+			if_ok = TRUE;
 			break;
-		words = GUINT16_FROM_LE(words);
+		}
 
-		/* allocate data in dictionary */
-		self->word = g_malloc0(words * sizeof(GydpDictYDPWord));
-		self->words = words;
+		const gchar *data = g_mapped_file_get_contents(index);
+		const gsize size = g_mapped_file_get_length(index);
 
-		/* read index offset */
-		if( !g_seekable_seek(G_SEEKABLE(index), 16, G_SEEK_SET, NULL, NULL) ||
-				g_input_stream_read(index, &offset, 4, NULL, NULL) != 4 )
+		/* read size of dictionary and index offset */
+		if( size < 20 )
 			break;
-		offset = GUINT32_FROM_LE(offset);
+		words = gydp_read_uint16(data + 8);
+		offset = gydp_read_uint32(data + 16);
 
-		/* move to index */
-		if( !g_seekable_seek(G_SEEKABLE(index), offset, G_SEEK_SET, NULL, NULL) )
-			break;
+		/* allocate data in dictionary */
+		self->word = g_malloc0(words * sizeof(GydpDictYDPWord));
+		self->words = words;
+		self->arena = gydp_arena_new(0);
 
+		/* walk index in place */
 		for(gsize i = 0; i < words; ++i, if_error = FALSE) {
 			guint32 length;
 
@@ -224,23 +248,30 @@ static gboolean gydp_dict_ydp_load(GydpDict *dict, gchar **locations, GydpLang l
 			if_error = TRUE;
 
 			/* read word properties */
-			if( g_input_stream_read(index, &length, 4, NULL, NULL) != 4 ||
-				g_input_stream_read(index, &offset, 4, NULL, NULL) != 4 )
+			if( offset > size || size - offset < 8 )
 				break;
-			length = GUINT32_FROM_LE(length) & 0xff;
-			offset = GUINT32_FROM_LE(offset);
+			length = gydp_read_uint32(data + offset) & 0xff;
 
-			/* expand buffer if needed */
-			if( length > buffer->allocated_len )
-				g_string_set_size(buffer, length);
-
-			/* read word */
-			if( g_input_stream_read(index, buffer->str, length, NULL, NULL) != (gssize)length )
+			/* validate word (stored with terminator) */
+			const gchar *raw = data + offset + 8;
+			const gchar *raw_end;
+			if( size - offset - 8 < length ||
+					(raw_end = memchr(raw, '\0', length)) == NULL )
 				break;
 
+			/* convert word into arena */
+			self->word[i].str = gydp_convert_arena(GYDP_CODEPAGE_CP1250,
+					self->arena, raw, raw_end - raw);
+
 			/* finalize word structure */
-			self->word[i].str = gydp_convert_ydp(buffer->str);
-			self->word[i].offset = offset;
+			self->word[i].offset = gydp_read_uint32(data + offset + 4);
+
+			/* move to next word */
+			offset += 8 + length;
+
+			/* publish loaded words in chunks */
+			if( (i + 1) % 1024 == 0 && !gydp_dict_progress(dict, i + 1) )
+				break;
 		}
 
 		/* check if all words load correctly */
@@ -252,12 +283,16 @@ static gboolean gydp_dict_ydp_load(GydpDict *dict, gchar **locations, GydpLang l
 		break;
 	}
 
-	g_string_free(buffer, TRUE);
-	if( index ) g_input_stream_close(index, NULL, NULL);
+	if( index ) g_mapped_file_free(index);
 
 	/* check if import was correct */
 	if( !if_ok || if_error ) {
 		gydp_dict_ydp_unload(self);
+		gydp_cache_free(cache);
+
+		/* cancelled load is not an error */
+		if( gydp_dict_cancelled(dict) )
+			return FALSE;
 
 		if( *locations == NULL )
 			g_printerr("Error loading '%s' dictionary by YDP engine. Missing dictionary file(s).\n",
@@ -266,18 +301,22 @@ static gboolean gydp_dict_ydp_load(GydpDict *dict, gchar **locations, GydpLang l
 			g_printerr("Error loading '%s' dictionary by YDP engine at '%s'.\n",
 					gydp_lang_value_to_nick(lang), *locations);
 
-		/* indicate that dictionary changed */
-		gydp_dict_changed(dict);
-
 		return FALSE;
 	}
 
+	/* index was parsed from dictionary files */
+	if( self->cache == NULL ) {
+		/* build search keys */
+		self->keys = gydp_dict_keys_new(dict);
+
+		/* store index cache for next load */
+		gydp_dict_ydp_store(self, cache);
+		gydp_cache_free(cache);
+	}
+
 	/* set current language */
 	dict->language = lang;
 
-	/* indicate that dictionary changed */
-	gydp_dict_changed(dict);
-
 	return TRUE;
 }
 
@@ -303,61 +342,154 @@ static const gchar *gydp_dict_ydp_word(GydpDict *dict, guint n) {
 	return self->word[n].str;
 }
 
-static gboolean gydp_dict_ydp_text(GydpDict *dict, guint n, GtkTextBuffer *buffer) {
-	GydpDictYDP *self = GYDP_DICT_YDP(dict);
-	GtkTextIter begin, end;
-	guint32 length;
+static gboolean gydp_dict_ydp_text(GydpDict *dict, guint n, GydpText *text) {
+	const gchar *word, *data;
+	gsize length;
 
-	/* clear buffer */
-	gtk_text_buffer_get_start_iter(buffer, &begin);
-	gtk_text_buffer_get_end_iter(buffer, &end);
-	gtk_text_buffer_delete(buffer, &begin, &end);
+	/* clear text */
+	gydp_text_clear(text);
 
-	if( n >= self->words )
+	if( !gydp_dict_ydp_raw(GYDP_DICT_YDP(dict), n, &word, &data, &length) )
 		return FALSE;
 
-	if( !g_seekable_seek(G_SEEKABLE(self->stream), self->word[n].offset, G_SEEK_SET, NULL, NULL) ||
-			g_input_stream_read(self->stream, &length, 4, NULL, NULL) != 4 )
+	/* convert mapped definition to text */
+	gydp_convert_ydp_text(word, data, length, text);
+
+	return TRUE;
+}
+
+gboolean gydp_dict_ydp_raw(GydpDictYDP *self, guint n, const gchar **word,
+                           const gchar **text, gsize *length) {
+	if( n >= self->words )
 		return FALSE;
-	length = GUINT32_FROM_LE(length);
 
-	/* variadic array for definition */
-	gchar text[ length+1 ];
+	const gchar *data = g_mapped_file_get_contents(self->file);
+	const gsize size = g_mapped_file_get_length(self->file);
+	const gsize offset = self->word[n].offset;
 
-	/* read word definition */
-	if( g_input_stream_read(self->stream, text, length, NULL, NULL) != (gssize)length )
+	/* read definition length */
+	if( offset > size || size - offset < 4 )
 		return FALSE;
-	text[length] = '\0';
+	*length = gydp_read_uint32(data + offset);
 
-	/* convert raw text to buffer */
-	gydp_convert_ydp_widget(self->word[n].str, text, buffer);
+	/* validate definition bounds */
+	if( size - offset - 4 < *length )
+		return FALSE;
+
+	*word = self->word[n].str;
+	*text = data + offset + 4;
 
 	return TRUE;
 }
 
+static GydpDictKeys *gydp_dict_ydp_keys(GydpDict *dict) {
+	GydpDictYDP *self = GYDP_DICT_YDP(dict);
+	return self->keys;
+}
+
+/* parsed words and their strings */
+static gsize gydp_dict_ydp_memory(GydpDict *dict) {
+	GydpDictYDP *self = GYDP_DICT_YDP(dict);
+	gsize result = 0;
+
+	if( self->word != NULL )
+		result += self->words * sizeof(GydpDictYDPWord);
+	if( self->arena != NULL )
+		result += gydp_arena_size(self->arena);
+
+	return result;
+}
+
 static void gydp_dict_ydp_unload(GydpDictYDP *dict) {
 
 	/* validation */
 	g_return_if_fail(GYDP_IS_DICT_YDP(dict));
 	g_return_if_fail(GYDP_DICT(dict)->engine == GYDP_ENGINE_YDP);
 
-	/* detach stream */
-	if( dict->stream )
-		g_input_stream_close(dict->stream, NULL, NULL);
+	/* free converted words at once */
+	gydp_arena_free(dict->arena);
 
-	/* free words and definitions */
-	for(gsize i = 0; i < dict->words; ++i)
-		g_free(dict->word[i].str);
+	/* free search keys */
+	gydp_dict_keys_free(dict->keys);
 
 	/* free arrays */
 	g_free(dict->word);
 
+	/* detach mappings */
+	gydp_cache_free(dict->cache);
+	if( dict->file )
+		g_mapped_file_free(dict->file);
+
 	/* reset data */
-	dict->stream = NULL;
+	dict->file = NULL;
 	dict->word = NULL;
 	dict->words = 0;
+	dict->arena = NULL;
+	dict->keys = NULL;
+	dict->cache = NULL;
 
 	/* reset current dictionary */
 	GYDP_DICT(dict)->language = GYDP_LANG_NONE;
 }
 
+
+/** gydp_dict_ydp_restore
+ * use words and keys from index cache, definition offsets are
+ * validated on access so only cached strings need checking
+ */
+static gboolean gydp_dict_ydp_restore(GydpDictYDP *dict, GydpCache *cache) {
+	gsize words, length;
+
+	/* get cache sections */
+	const GydpDictYDPEntry *entry = gydp_cache_get(cache, GYDP_CACHE_WORDS, &words);
+	const gchar *strings = gydp_cache_get(cache, GYDP_CACHE_STRINGS, &length);
+
+	/* validate sections */
+	if( words % sizeof(GydpDictYDPEntry) != 0 ||
+			(words > 0 && (length == 0 || strings[length - 1] != '\0')) )
+		return FALSE;
+	words /= sizeof(GydpDictYDPEntry);
+
+	for(gsize n = 0; n < words; ++n)
+		if( entry[n].str >= length )
+			return FALSE;
+
+	/* use cached search keys */
+	if( (dict->keys = gydp_dict_keys_restore(cache, words)) == NULL )
+		return FALSE;
+
+	/* words point directly into cache mapping */
+	dict->word = g_malloc(words * sizeof(GydpDictYDPWord));
+	dict->words = words;
+	dict->cache = cache;
+
+	for(gsize n = 0; n < words; ++n) {
+		dict->word[n].str = strings + entry[n].str;
+		dict->word[n].offset = entry[n].offset;
+	}
+
+	return TRUE;
+}
+
+static void gydp_dict_ydp_store(GydpDictYDP *dict, GydpCache *cache) {
+	GydpDictYDPEntry *entry = g_malloc(dict->words * sizeof(GydpDictYDPEntry));
+	GString *strings = g_string_sized_new(gydp_arena_size(dict->arena));
+
+	/* words are stored as offsets */
+	for(gsize n = 0; n < dict->words; ++n) {
+		entry[n].str = strings->len;
+		entry[n].offset = dict->word[n].offset;
+
+		g_string_append_len(strings, dict->word[n].str, strlen(dict->word[n].str) + 1);
+	}
+
+	/* save cache */
+	gydp_cache_set(cache, GYDP_CACHE_WORDS, entry, dict->words * sizeof(GydpDictYDPEntry));
+	gydp_cache_set(cache, GYDP_CACHE_STRINGS, strings->str, strings->len);
+	gydp_dict_keys_store(dict->keys, cache);
+	gydp_cache_save(cache);
+
+	/* free temporary data */
+	g_string_free(strings, TRUE);
+	g_free(entry);
+}
@@ -38,6 +38,10 @@ typedef struct GydpDictYDPClass GydpDictYDPClass;
 GType       gydp_dict_ydp_get_type() G_GNUC_CONST;
 GObject    *gydp_dict_ydp_new     ();
 
+/* word and mapped definition of entry before conversion, used by benchmark */
+gboolean    gydp_dict_ydp_raw     (GydpDictYDP *dict, guint n, const gchar **word,
+                                   const gchar **text, gsize *length);
+
 G_END_DECLS
 
 #endif /* __GYDP_DICT_YDP_H__ */
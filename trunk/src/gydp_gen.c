@@ -0,0 +1,764 @@
+/*
+ * Copyright (C) 2008 Michał Kurgan <michal.kurgan@moloh.net>
+ *
+ * This file is part of gydpdict.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gydpdict.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "gydp_global.h"
+#include "gydp_dict.h"
+#include "gydp_convert.h"
+
+#include <glib/gstdio.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/* supported number of entries of generated dictionary */
+#define GYDP_GEN_ENTRIES     100000
+#define GYDP_GEN_ENTRIES_MAX 10000000
+
+/* YDP index stores number of words in 16 bits */
+#define GYDP_GEN_YDP_ENTRIES 65535
+
+/* definition sizes (bytes in dictionary codepage) */
+#define GYDP_GEN_TEXT_SIZE 160
+#define GYDP_GEN_TEXT_MIN  16
+#define GYDP_GEN_TEXT_MAX  32768
+
+/* SAP pages are filled up to this size (like bundled dictionaries) */
+#define GYDP_GEN_SAP_PAGE 16384
+
+/* output is written in blocks of this size */
+#define GYDP_GEN_BUFFER (1 << 20)
+
+/* size distribution of definitions */
+typedef enum GydpGenDistribution {
+	GYDP_GEN_FIXED,        /* every definition has mean size */
+	GYDP_GEN_UNIFORM,      /* uniform in 1 .. 2 * mean */
+	GYDP_GEN_EXPONENTIAL,  /* many short and few long definitions */
+} GydpGenDistribution;
+
+/* generated headword */
+typedef struct GydpGenEntry {
+	const gchar *key;      /* processed word (dictionary order) */
+	const gchar *word;     /* utf8 encoded word */
+} GydpGenEntry;
+
+/* generator of single dictionary */
+typedef struct GydpGen {
+	GRand *rand;           /* source of words and definitions */
+	GydpCodepage codepage; /* codepage of written text */
+	GStringChunk *chunk;   /* storage of words and keys */
+	GArray *entries;       /* headwords in dictionary order (GydpGenEntry) */
+	guint32 *sizes;        /* definition size of every entry */
+	GString *word;         /* encoded headword */
+	GString *text;         /* encoded definition */
+	GString *buffer;       /* pending output */
+	FILE *file;            /* output file */
+	guint64 written;       /* bytes written to file */
+} GydpGen;
+
+/* command line options */
+static gchar *gydp_gen_output = NULL;
+static gchar *gydp_gen_engine = NULL;
+static gint gydp_gen_entries = GYDP_GEN_ENTRIES;
+static gint gydp_gen_seed = 1;
+static gint gydp_gen_text_size = GYDP_GEN_TEXT_SIZE;
+static gint gydp_gen_text_max = 4096;
+static gchar *gydp_gen_distribution = NULL;
+static gint gydp_gen_diacritics = 10;
+static gint gydp_gen_capitals = 5;
+static gint gydp_gen_phrases = 10;
+static gint gydp_gen_markup = 20;
+
+static GOptionEntry gydp_gen_options[] = {
+	{ "output", 'o', 0, G_OPTION_ARG_FILENAME, &gydp_gen_output,
+		"Directory of generated dictionary files", "DIR" },
+	{ "engine", 'e', 0, G_OPTION_ARG_STRING, &gydp_gen_engine,
+		"Generate only files of this engine (sap, ydp)", "ENGINE" },
+	{ "entries", 'n', 0, G_OPTION_ARG_INT, &gydp_gen_entries,
+		"Entries of every dictionary (up to 10000000, YDP up to 65535)", "N" },
+	{ "seed", 's', 0, G_OPTION_ARG_INT, &gydp_gen_seed,
+		"Seed of generated words and definitions", "N" },
+	{ "text-size", 't', 0, G_OPTION_ARG_INT, &gydp_gen_text_size,
+		"Mean definition size in bytes", "BYTES" },
+	{ "text-max", 'm', 0, G_OPTION_ARG_INT, &gydp_gen_text_max,
+		"Largest definition size in bytes (up to 32768)", "BYTES" },
+	{ "distribution", 'd', 0, G_OPTION_ARG_STRING, &gydp_gen_distribution,
+		"Definition size distribution (fixed, uniform, exponential)", "NAME" },
+	{ "diacritics", 0, 0, G_OPTION_ARG_INT, &gydp_gen_diacritics,
+		"Percent of letters replaced by Polish ones", "PERCENT" },
+	{ "capitals", 0, 0, G_OPTION_ARG_INT, &gydp_gen_capitals,
+		"Percent of capitalized headwords", "PERCENT" },
+	{ "phrases", 0, 0, G_OPTION_ARG_INT, &gydp_gen_phrases,
+		"Percent of headwords made of several words", "PERCENT" },
+	{ "markup", 0, 0, G_OPTION_ARG_INT, &gydp_gen_markup,
+		"Percent of definition parts with markup", "PERCENT" },
+	{ NULL, 0, 0, 0, NULL, NULL, NULL }
+};
+
+/* Polish letters in dictionary codepages */
+static const struct { gunichar letter; guchar iso; guchar cp; } gydp_gen_letters[] = {
+	{ 0x0105, 0xb1, 0xb9 }, { 0x0104, 0xa1, 0xa5 },  /* ą Ą */
+	{ 0x0107, 0xe6, 0xe6 }, { 0x0106, 0xc6, 0xc6 },  /* ć Ć */
+	{ 0x0119, 0xea, 0xea }, { 0x0118, 0xca, 0xca },  /* ę Ę */
+	{ 0x0142, 0xb3, 0xb3 }, { 0x0141, 0xa3, 0xa3 },  /* ł Ł */
+	{ 0x0144, 0xf1, 0xf1 }, { 0x0143, 0xd1, 0xd1 },  /* ń Ń */
+	{ 0x00f3, 0xf3, 0xf3 }, { 0x00d3, 0xd3, 0xd3 },  /* ó Ó */
+	{ 0x015b, 0xb6, 0x9c }, { 0x015a, 0xa6, 0x8c },  /* ś Ś */
+	{ 0x017a, 0xbc, 0x9f }, { 0x0179, 0xac, 0x8f },  /* ź Ź */
+	{ 0x017c, 0xbf, 0xbf }, { 0x017b, 0xaf, 0xaf },  /* ż Ż */
+};
+
+/* Polish replacements of plain letters */
+static const struct { gchar plain; gunichar letter; } gydp_gen_diacritic[] = {
+	{ 'a', 0x0105 }, { 'c', 0x0107 }, { 'e', 0x0119 }, { 'l', 0x0142 },
+	{ 'n', 0x0144 }, { 'o', 0x00f3 }, { 's', 0x015b }, { 'z', 0x017a }, { 'z', 0x017c },
+};
+
+static const gchar gydp_gen_consonants[] = "bcdfghjklmnprstwz";
+static const gchar gydp_gen_vowels[] = "aeiouy";
+
+/* private functions */
+static GydpGen  *gydp_gen_new      (GydpCodepage codepage, guint32 seed);
+static void      gydp_gen_free     (GydpGen *self);
+static void      gydp_gen_words    (GydpGen *self, guint count);
+static const gchar *gydp_gen_key  (GydpGen *self, const gchar *word);
+static gint      gydp_gen_compare  (gconstpointer a, gconstpointer b);
+static void      gydp_gen_sizes    (GydpGen *self, GydpGenDistribution distribution);
+
+static gunichar  gydp_gen_letter   (GydpGen *self, const gchar *letters);
+static void      gydp_gen_put      (GydpGen *self, GString *out, gunichar letter, gboolean encode);
+static void      gydp_gen_word     (GydpGen *self, GString *out, gboolean encode, gboolean capital);
+static void      gydp_gen_encode   (GydpGen *self, GString *out, const gchar *word);
+static gboolean  gydp_gen_chance   (GydpGen *self, gint percent);
+static void      gydp_gen_pad      (GydpGen *self, GString *out, gsize size);
+
+static void      gydp_gen_text_sap (GydpGen *self, const gchar *word, gsize size);
+static void      gydp_gen_text_ydp (GydpGen *self, const gchar *word, gsize size);
+
+static gboolean  gydp_gen_open     (GydpGen *self, const gchar *filename);
+static gboolean  gydp_gen_flush    (GydpGen *self, gboolean close);
+static void      gydp_gen_uint16   (GString *out, guint16 value);
+static void      gydp_gen_uint32   (GString *out, guint32 value);
+
+static gboolean  gydp_gen_sap      (GydpGen *self, const gchar *filename);
+static gboolean  gydp_gen_ydp      (GydpGen *self, const gchar *filename);
+
+int main(int argc, char *argv[]) {
+	GOptionContext *context = g_option_context_new("- write synthetic SAP and YDP dictionaries");
+	GError *error = NULL;
+
+	g_option_context_add_main_entries(context, gydp_gen_options, NULL);
+	if( !g_option_context_parse(context, &argc, &argv, &error) ) {
+		g_printerr("%s\n", error->message);
+		g_error_free(error);
+		g_option_context_free(context);
+		return EXIT_FAILURE;
+	}
+	g_option_context_free(context);
+
+	/* validate options */
+	GydpGenDistribution distribution = GYDP_GEN_EXPONENTIAL;
+	if( gydp_gen_distribution == NULL || !strcmp(gydp_gen_distribution, "exponential") )
+		distribution = GYDP_GEN_EXPONENTIAL;
+	else if( !strcmp(gydp_gen_distribution, "uniform") )
+		distribution = GYDP_GEN_UNIFORM;
+	else if( !strcmp(gydp_gen_distribution, "fixed") )
+		distribution = GYDP_GEN_FIXED;
+	else {
+		g_printerr("Unknown size distribution '%s'.\n", gydp_gen_distribution);
+		return EXIT_FAILURE;
+	}
+
+	if( gydp_gen_output == NULL ) {
+		g_printerr("Missing output directory (--output).\n");
+		return EXIT_FAILURE;
+	}
+	if( gydp_gen_entries < 1 || gydp_gen_entries > GYDP_GEN_ENTRIES_MAX ) {
+		g_printerr("Number of entries should be in range 1 .. %d.\n", GYDP_GEN_ENTRIES_MAX);
+		return EXIT_FAILURE;
+	}
+
+	gydp_gen_text_max = CLAMP(gydp_gen_text_max, GYDP_GEN_TEXT_MIN, GYDP_GEN_TEXT_MAX);
+	gydp_gen_text_size = CLAMP(gydp_gen_text_size, GYDP_GEN_TEXT_MIN, gydp_gen_text_max);
+	gydp_gen_diacritics = CLAMP(gydp_gen_diacritics, 0, 100);
+	gydp_gen_capitals = CLAMP(gydp_gen_capitals, 0, 100);
+	gydp_gen_phrases = CLAMP(gydp_gen_phrases, 0, 100);
+	gydp_gen_markup = CLAMP(gydp_gen_markup, 0, 100);
+
+	if( g_mkdir_with_parents(gydp_gen_output, 0755) != 0 ) {
+		g_printerr("Error creating directory '%s'.\n", gydp_gen_output);
+		return EXIT_FAILURE;
+	}
+
+	/* files of every engine and language (both languages use the same layout) */
+	static const struct {
+		GydpEngine engine;
+		const gchar *filename;
+		GydpCodepage codepage;
+		gboolean (*write)(GydpGen *self, const gchar *filename);
+	} files[] = {
+		{ GYDP_ENGINE_SAP, "dvp_1.dic",   GYDP_CODEPAGE_ISO88592, gydp_gen_sap },
+		{ GYDP_ENGINE_SAP, "dvp_2.dic",   GYDP_CODEPAGE_ISO88592, gydp_gen_sap },
+		{ GYDP_ENGINE_YDP, "DICT100",     GYDP_CODEPAGE_CP1250,   gydp_gen_ydp },
+		{ GYDP_ENGINE_YDP, "DICT101",     GYDP_CODEPAGE_CP1250,   gydp_gen_ydp },
+	};
+	gboolean result = TRUE;
+
+	for(guint i = 0; i < G_N_ELEMENTS(files) && result; ++i) {
+		if( gydp_gen_engine && strcmp(gydp_gen_engine, gydp_engine_value_to_nick(files[i].engine)) )
+			continue;
+
+		/* every file has its own words */
+		GydpGen *gen = gydp_gen_new(files[i].codepage, gydp_gen_seed * G_N_ELEMENTS(files) + i);
+		guint count = gydp_gen_entries;
+
+		if( files[i].engine == GYDP_ENGINE_YDP && count > GYDP_GEN_YDP_ENTRIES ) {
+			g_printerr("YDP index holds at most %d entries, %s is limited to them.\n",
+					GYDP_GEN_YDP_ENTRIES, files[i].filename);
+			count = GYDP_GEN_YDP_ENTRIES;
+		}
+
+		gydp_gen_words(gen, count);
+		gydp_gen_sizes(gen, distribution);
+
+		gchar *filename = g_build_filename(gydp_gen_output, files[i].filename, NULL);
+		result = files[i].write(gen, filename);
+		g_free(filename);
+
+		gydp_gen_free(gen);
+	}
+
+	/* free data */
+	g_free(gydp_gen_output);
+	g_free(gydp_gen_engine);
+	g_free(gydp_gen_distribution);
+
+	return result? EXIT_SUCCESS: EXIT_FAILURE;
+}
+
+static GydpGen *gydp_gen_new(GydpCodepage codepage, guint32 seed) {
+	GydpGen *self = g_slice_new0(GydpGen);
+
+	self->rand = g_rand_new_with_seed(seed);
+	self->codepage = codepage;
+	self->chunk = g_string_chunk_new(GYDP_GEN_BUFFER);
+	self->entries = g_array_new(FALSE, FALSE, sizeof(GydpGenEntry));
+	self->word = g_string_sized_new(64);
+	self->text = g_string_sized_new(GYDP_GEN_TEXT_MAX + 64);
+	self->buffer = g_string_sized_new(GYDP_GEN_BUFFER + GYDP_GEN_SAP_PAGE);
+
+	return self;
+}
+
+static void gydp_gen_free(GydpGen *self) {
+	if( self->file != NULL )
+		fclose(self->file);
+
+	g_rand_free(self->rand);
+	g_string_chunk_free(self->chunk);
+	g_array_free(self->entries, TRUE);
+	g_free(self->sizes);
+	g_string_free(self->word, TRUE);
+	g_string_free(self->text, TRUE);
+	g_string_free(self->buffer, TRUE);
+	g_slice_free(GydpGen, self);
+}
+
+/** gydp_gen_words
+ * headwords are unique by processed key and sorted by it like dictionary
+ * order expected by engines, duplicates are replaced until count is reached
+ * (short words run out quickly, so only replacements are sorted each round)
+ */
+static void gydp_gen_words(GydpGen *self, guint count) {
+	GString *word = g_string_sized_new(64);
+	guint sorted = 0;
+
+	while( self->entries->len < count ) {
+		/* generate missing words */
+		for(guint i = self->entries->len; i < count; ++i) {
+			GydpGenEntry entry;
+
+			g_string_truncate(word, 0);
+			gydp_gen_word(self, word, FALSE, gydp_gen_chance(self, gydp_gen_capitals));
+			if( gydp_gen_chance(self, gydp_gen_phrases) )
+				for(guint n = g_rand_int_range(self->rand, 1, 3); n > 0; --n) {
+					g_string_append_c(word, ' ');
+					gydp_gen_word(self, word, FALSE, FALSE);
+				}
+
+			entry.key = gydp_gen_key(self, word->str);
+			entry.word = g_string_chunk_insert(self->chunk, word->str);
+
+			g_array_append_val(self->entries, entry);
+		}
+
+		/* sort new words and merge them with previous ones, duplicated keys are dropped */
+		GydpGenEntry *entries = (GydpGenEntry *)self->entries->data;
+		const guint size = self->entries->len;
+		GArray *merged = g_array_sized_new(FALSE, FALSE, sizeof(GydpGenEntry), count);
+
+		qsort(entries + sorted, size - sorted, sizeof(GydpGenEntry), gydp_gen_compare);
+
+		for(guint i = 0, j = sorted; i < sorted || j < size; ) {
+			const GydpGenEntry *entry = j == size || (i < sorted &&
+					gydp_gen_compare(entries + i, entries + j) <= 0)? entries + i++: entries + j++;
+
+			if( merged->len == 0 ||
+					strcmp(g_array_index(merged, GydpGenEntry, merged->len - 1).key, entry->key) )
+				g_array_append_vals(merged, entry, 1);
+		}
+
+		g_array_free(self->entries, TRUE);
+		self->entries = merged;
+		sorted = merged->len;
+	}
+
+	g_string_free(word, TRUE);
+}
+
+/** gydp_gen_key
+ * processed word, plain words are folded in place as processing of
+ * whole word list dominates generation time otherwise
+ */
+static const gchar *gydp_gen_key(GydpGen *self, const gchar *word) {
+	gchar buffer[256], *pos = buffer;
+	const gchar *str;
+
+	for(str = word; *str && pos < buffer + sizeof(buffer) - 1; ++str)
+		if( (guchar)*str >= 0x80 )
+			break;
+		else if( *str != ' ' )
+			*(pos++) = g_ascii_tolower(*str);
+
+	if( *str == '\0' ) {
+		*pos = '\0';
+		return g_string_chunk_insert(self->chunk, buffer);
+	}
+
+	gchar *key = gydp_str_process(word);
+	const gchar *result = g_string_chunk_insert(self->chunk, key);
+	g_free(key);
+
+	return result;
+}
+
+static gint gydp_gen_compare(gconstpointer a, gconstpointer b) {
+	const GydpGenEntry *first = a, *second = b;
+	const gint result = strcmp(first->key, second->key);
+	return result? result: strcmp(first->word, second->word);
+}
+
+static void gydp_gen_sizes(GydpGen *self, GydpGenDistribution distribution) {
+	const gdouble mean = gydp_gen_text_size;
+
+	self->sizes = g_new(guint32, self->entries->len);
+	for(guint i = 0; i < self->entries->len; ++i) {
+		gdouble size = mean;
+
+		switch( distribution ) {
+		case GYDP_GEN_FIXED:
+			break;
+		case GYDP_GEN_UNIFORM:
+			size = g_rand_double_range(self->rand, 1.0, 2.0 * mean);
+			break;
+		case GYDP_GEN_EXPONENTIAL:
+			size = -mean * log(1.0 - g_rand_double(self->rand));
+			break;
+		}
+
+		self->sizes[i] = CLAMP(size, GYDP_GEN_TEXT_MIN, gydp_gen_text_max);
+	}
+}
+
+static gunichar gydp_gen_letter(GydpGen *self, const gchar *letters) {
+	const gchar letter = letters[g_rand_int_range(self->rand, 0, strlen(letters))];
+
+	/* replace with Polish letter */
+	if( gydp_gen_chance(self, gydp_gen_diacritics) ) {
+		guint first = G_N_ELEMENTS(gydp_gen_diacritic), last = 0;
+
+		for(guint i = 0; i < G_N_ELEMENTS(gydp_gen_diacritic); ++i)
+			if( gydp_gen_diacritic[i].plain == letter ) {
+				first = MIN(first, i);
+				last = i;
+			}
+
+		if( first <= last )
+			return gydp_gen_diacritic[g_rand_int_range(self->rand, first, last + 1)].letter;
+	}
+
+	return letter;
+}
+
+static void gydp_gen_put(GydpGen *self, GString *out, gunichar letter, gboolean encode) {
+	if( !encode || letter < 0x80 ) {
+		g_string_append_unichar(out, letter);
+		return;
+	}
+
+	/* write letter in codepage of dictionary */
+	for(guint i = 0; i < G_N_ELEMENTS(gydp_gen_letters); ++i)
+		if( gydp_gen_letters[i].letter == letter ) {
+			g_string_append_c(out, self->codepage == GYDP_CODEPAGE_CP1250?
+					gydp_gen_letters[i].cp: gydp_gen_letters[i].iso);
+			return;
+		}
+
+	g_string_append_c(out, '?');
+}
+
+/** gydp_gen_word
+ * word of one to four syllables, utf8 encoded or in codepage of dictionary
+ */
+static void gydp_gen_word(GydpGen *self, GString *out, gboolean encode, gboolean capital) {
+	const guint syllables = g_rand_int_range(self->rand, 1, 5);
+
+	for(guint i = 0; i < syllables; ++i) {
+		gunichar letter[3];
+		guint n = 0;
+
+		if( g_rand_int_range(self->rand, 0, 3) )
+			letter[n++] = gydp_gen_letter(self, gydp_gen_consonants);
+		letter[n++] = gydp_gen_letter(self, gydp_gen_vowels);
+		if( !g_rand_int_range(self->rand, 0, 4) )
+			letter[n++] = gydp_gen_letter(self, gydp_gen_consonants);
+
+		if( i == 0 && capital )
+			letter[0] = g_unichar_toupper(letter[0]);
+
+		for(guint x = 0; x < n; ++x)
+			gydp_gen_put(self, out, letter[x], encode);
+	}
+}
+
+static void gydp_gen_encode(GydpGen *self, GString *out, const gchar *word) {
+	for(; *word; word = g_utf8_next_char(word))
+		gydp_gen_put(self, out, g_utf8_get_char(word), TRUE);
+}
+
+static gboolean gydp_gen_chance(GydpGen *self, gint percent) {
+	return g_rand_int_range(self->rand, 0, 100) < percent;
+}
+
+/** gydp_gen_pad
+ * fill definition with plain words up to exact size
+ */
+static void gydp_gen_pad(GydpGen *self, GString *out, gsize size) {
+	while( out->len < size ) {
+		if( out->len + 1 < size && out->len && out->str[out->len - 1] != ' ' &&
+				!g_rand_int_range(self->rand, 0, 6) )
+			g_string_append_c(out, ' ');
+		else
+			gydp_gen_put(self, out, gydp_gen_letter(self,
+					out->len % 2? gydp_gen_vowels: gydp_gen_consonants), TRUE);
+	}
+}
+
+/** gydp_gen_text_sap
+ * definition in SAP markup of exactly size bytes, markup is not split
+ * by padding so parser never reads past end of definition
+ */
+static void gydp_gen_text_sap(GydpGen *self, const gchar *word, gsize size) {
+	/* word types (rzeczownik, czasownik, przymiotnik, przysłówek, skrót) */
+	static const guint16 types[] = { 0x0009, 0x000f, 0x0001, 0x0002, 0x0249 };
+	GString *text = self->text;
+
+	g_string_truncate(text, 0);
+
+	if( gydp_gen_chance(self, gydp_gen_markup) ) {
+		const guint16 type = types[g_rand_int_range(self->rand, 0, G_N_ELEMENTS(types))];
+		g_string_append_c(text, '#');
+		g_string_append_c(text, type >> 8);
+		g_string_append_c(text, type & 0xff);
+	}
+
+	while( text->len + 48 < size ) {
+		if( gydp_gen_chance(self, gydp_gen_markup) )
+			switch( g_rand_int_range(self->rand, 0, 4) ) {
+			case 0: /* bold example with headword */
+				g_string_append(text, "{* ");
+				gydp_gen_word(self, text, TRUE, FALSE);
+				g_string_append_c(text, '}');
+				break;
+			case 1: /* next meaning */
+				g_string_append_c(text, '$');
+				break;
+			case 2: /* separator */
+				g_string_append_c(text, '-');
+				break;
+			case 3: /* remark */
+				g_string_append_c(text, '(');
+				gydp_gen_word(self, text, TRUE, FALSE);
+				g_string_append_c(text, ')');
+				break;
+			}
+		else {
+			gydp_gen_word(self, text, TRUE, FALSE);
+			g_string_append(text, g_rand_int_range(self->rand, 0, 3)? " ": ",");
+		}
+	}
+
+	gydp_gen_pad(self, text, size - 1);
+	g_string_append_c(text, '\n');
+}
+
+/** gydp_gen_text_ydp
+ * definition in YDP rich text of about size bytes, headword comes first
+ * so short definitions may be longer
+ */
+static void gydp_gen_text_ydp(GydpGen *self, const gchar *word, gsize size) {
+	static const gchar *types[] = { "n", "v", "adj", "adv", "pron" };
+	GString *text = self->text;
+
+	g_string_truncate(text, 0);
+	g_string_append(text, "{\\b ");
+	g_string_append(text, word);
+	g_string_append(text, "}\\par ");
+
+	while( text->len + 48 < size ) {
+		if( gydp_gen_chance(self, gydp_gen_markup) )
+			switch( g_rand_int_range(self->rand, 0, 4) ) {
+			case 0: /* word type */
+				g_string_append_printf(text, "{\\i %s} ",
+						types[g_rand_int_range(self->rand, 0, G_N_ELEMENTS(types))]);
+				break;
+			case 1: /* translation */
+				g_string_append(text, "{\\cf2 ");
+				gydp_gen_word(self, text, TRUE, FALSE);
+				g_string_append(text, "} ");
+				break;
+			case 2: /* next meaning */
+				g_string_append(text, "\\line ");
+				break;
+			case 3: /* example */
+				g_string_append(text, "{\\b ");
+				gydp_gen_word(self, text, TRUE, FALSE);
+				g_string_append(text, "} ");
+				break;
+			}
+		else {
+			gydp_gen_word(self, text, TRUE, FALSE);
+			g_string_append(text, g_rand_int_range(self->rand, 0, 3)? " ": ", ");
+		}
+	}
+
+	gydp_gen_pad(self, text, size > 4? size - 4: 0);
+	g_string_append(text, "\\par");
+}
+
+static gboolean gydp_gen_open(GydpGen *self, const gchar *filename) {
+	if( (self->file = g_fopen(filename, "wb")) == NULL ) {
+		g_printerr("Error writing '%s'.\n", filename);
+		return FALSE;
+	}
+
+	self->written = 0;
+	g_string_truncate(self->buffer, 0);
+	return TRUE;
+}
+
+static gboolean gydp_gen_flush(GydpGen *self, gboolean close) {
+	gboolean result = fwrite(self->buffer->str, 1, self->buffer->len, self->file) == self->buffer->len;
+
+	self->written += self->buffer->len;
+	g_string_truncate(self->buffer, 0);
+
+	if( close ) {
+		result = fclose(self->file) == 0 && result;
+		self->file = NULL;
+	}
+
+	if( !result )
+		g_printerr("Error writing dictionary file.\n");
+	return result;
+}
+
+static void gydp_gen_uint16(GString *out, guint16 value) {
+	g_string_append_c(out, value & 0xff);
+	g_string_append_c(out, value >> 8);
+}
+
+static void gydp_gen_uint32(GString *out, guint32 value) {
+	gydp_gen_uint16(out, value & 0xffff);
+	gydp_gen_uint16(out, value >> 16);
+}
+
+/** gydp_gen_sap
+ * pages are filled up to GYDP_GEN_SAP_PAGE bytes, layout of pages is
+ * computed first as page table precedes them
+ */
+static gboolean gydp_gen_sap(GydpGen *self, const gchar *filename) {
+	const GydpGenEntry *entries = (const GydpGenEntry *)self->entries->data;
+	const guint words = self->entries->len;
+	GArray *first = g_array_new(FALSE, FALSE, sizeof(guint32));
+	GArray *size = g_array_new(FALSE, FALSE, sizeof(guint32));
+	guint32 page_size = 0;
+
+	/* split entries into pages */
+	for(guint32 i = 0; i < words; ++i) {
+		const guint32 entry = sizeof(guint16) + g_utf8_strlen(entries[i].word, -1) + 1 + self->sizes[i];
+
+		if( i == 0 || page_size + entry > GYDP_GEN_SAP_PAGE ) {
+			if( i > 0 )
+				g_array_append_val(size, page_size);
+			g_array_append_val(first, i);
+			page_size = 0;
+		}
+		page_size += entry;
+	}
+	g_array_append_val(size, page_size);
+	g_array_append_val(first, words);
+
+	/* pages are addressed by 32 bits offsets */
+	const guint pages = size->len;
+	guint64 offset = 12 + 4 * (guint64)pages;
+	for(guint i = 0; i < pages; ++i)
+		offset += 6 + g_array_index(size, guint32, i);
+
+	if( offset > G_MAXUINT32 ) {
+		g_printerr("Dictionary '%s' is too large for SAP format.\n", filename);
+		g_array_free(first, TRUE);
+		g_array_free(size, TRUE);
+		return FALSE;
+	}
+
+	gboolean result = gydp_gen_open(self, filename);
+
+	if( result ) {
+		/* header and page table */
+		gydp_gen_uint32(self->buffer, 0xFADEABBA);
+		gydp_gen_uint32(self->buffer, words);
+		gydp_gen_uint32(self->buffer, pages);
+
+		offset = 12 + 4 * pages;
+		for(guint i = 0; i < pages; ++i) {
+			gydp_gen_uint32(self->buffer, offset);
+			offset += 6 + g_array_index(size, guint32, i);
+		}
+	}
+
+	for(guint i = 0; i < pages && result; ++i) {
+		const guint32 begin = g_array_index(first, guint32, i);
+		const guint32 end = g_array_index(first, guint32, i + 1);
+		gsize start, definitions;
+
+		/* page header, definitions start after word list */
+		gydp_gen_uint16(self->buffer, end - begin);
+		gydp_gen_uint16(self->buffer, g_array_index(size, guint32, i));
+		start = self->buffer->len;
+		gydp_gen_uint16(self->buffer, 0);
+
+		for(guint32 n = begin; n < end; ++n)
+			gydp_gen_uint16(self->buffer, self->sizes[n]);
+		for(guint32 n = begin; n < end; ++n) {
+			gydp_gen_encode(self, self->buffer, entries[n].word);
+			g_string_append_c(self->buffer, '\0');
+		}
+
+		definitions = self->buffer->len - start - 2;
+		self->buffer->str[start] = definitions & 0xff;
+		self->buffer->str[start + 1] = definitions >> 8;
+
+		for(guint32 n = begin; n < end; ++n) {
+			gydp_gen_text_sap(self, entries[n].word, self->sizes[n]);
+			g_string_append_len(self->buffer, self->text->str, self->text->len);
+		}
+
+		if( self->buffer->len >= GYDP_GEN_BUFFER )
+			result = gydp_gen_flush(self, FALSE);
+	}
+
+	if( self->file != NULL )
+		result = gydp_gen_flush(self, TRUE) && result;
+
+	if( result )
+		g_print("%s: %u entries, %u pages, %.1f MiB\n", filename, words, pages,
+				self->written / (1024.0 * 1024.0));
+
+	g_array_free(first, TRUE);
+	g_array_free(size, TRUE);
+
+	return result;
+}
+
+/** gydp_gen_ydp
+ * definitions are written as they are generated, index is kept in memory
+ * (it holds at most GYDP_GEN_YDP_ENTRIES words)
+ */
+static gboolean gydp_gen_ydp(GydpGen *self, const gchar *filename) {
+	const GydpGenEntry *entries = (const GydpGenEntry *)self->entries->data;
+	const guint words = self->entries->len;
+	gchar *dat = g_strconcat(filename, ".DAT", NULL);
+	gchar *idx = g_strconcat(filename, ".IDX", NULL);
+	GString *index = g_string_sized_new(24 + 32 * words);
+	GError *error = NULL;
+
+	/* index header, word list starts right after it */
+	gydp_gen_uint32(index, 0);
+	gydp_gen_uint32(index, 0);
+	gydp_gen_uint16(index, words);
+	gydp_gen_uint16(index, 0);
+	gydp_gen_uint32(index, 0);
+	gydp_gen_uint32(index, 24);
+	gydp_gen_uint32(index, 0);
+
+	gboolean result = gydp_gen_open(self, dat);
+
+	for(guint i = 0; i < words && result; ++i) {
+		const guint64 offset = self->written + self->buffer->len;
+
+		if( offset > G_MAXUINT32 ) {
+			g_printerr("Dictionary '%s' is too large for YDP format.\n", dat);
+			result = FALSE;
+			break;
+		}
+
+		/* index entry (length includes terminator) */
+		g_string_truncate(self->word, 0);
+		gydp_gen_encode(self, self->word, entries[i].word);
+		gydp_gen_uint32(index, self->word->len + 1);
+		gydp_gen_uint32(index, offset);
+		g_string_append_len(index, self->word->str, self->word->len + 1);
+
+		/* definition */
+		gydp_gen_text_ydp(self, self->word->str, self->sizes[i]);
+		gydp_gen_uint32(self->buffer, self->text->len);
+		g_string_append_len(self->buffer, self->text->str, self->text->len);
+
+		if( self->buffer->len >= GYDP_GEN_BUFFER )
+			result = gydp_gen_flush(self, FALSE);
+	}
+
+	if( self->file != NULL )
+		result = gydp_gen_flush(self, TRUE) && result;
+
+	if( result && !g_file_set_contents(idx, index->str, index->len, &error) ) {
+		g_printerr("%s\n", error->message);
+		g_error_free(error);
+		result = FALSE;
+	}
+
+	if( result )
+		g_print("%s: %u entries, %.1f MiB\n", dat, words, self->written / (1024.0 * 1024.0));
+
+	g_string_free(index, TRUE);
+	g_free(dat);
+	g_free(idx);
+
+	return result;
+}
@@ -60,6 +60,7 @@ GType gydp_engine_get_type() {
 		static const GEnumValue values[] = {
 			{ GYDP_ENGINE_SAP, "GYDP_ENGINE_SAP", "sap" },
 			{ GYDP_ENGINE_YDP, "GYDP_ENGINE_YDP", "ydp" },
+			{ GYDP_ENGINE_MERGE, "GYDP_ENGINE_MERGE", "merge" },
 			{ 0, NULL, NULL}
 		};
 
@@ -77,6 +78,16 @@ GEnumClass *gydp_enum(GydpEnum type) {
 	}
 }
 
+GEnumValue *gydp_enum_value(GydpEnum type, const gchar *name) {
+	GEnumClass *klass = gydp_enum(type);
+	GEnumValue *value = NULL;
+
+	if( name != NULL && (value = g_enum_get_value_by_nick(klass, name)) == NULL )
+		value = g_enum_get_value_by_name(klass, name);
+
+	return value;
+}
+
 const gchar *gydp_lang_value_to_name(GydpLang lang) {
 	return g_enum_get_value(gydp_language, lang)->value_name;
 }
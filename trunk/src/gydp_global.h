@@ -33,6 +33,7 @@ G_BEGIN_DECLS
 /* GydpApp properites */
 #define GYDP_APP_DICT "dict"
 #define GYDP_APP_CONF "cfg"
+#define GYDP_APP_REGISTRY "registry"
 
 /* GtkTextBuffer tag names */
 #define GYDP_TAG_ALIGN_CENTER  "center"
@@ -64,6 +65,7 @@ typedef enum {
 	GYDP_ENGINE_DEFAULT,
 	GYDP_ENGINE_SAP,
 	GYDP_ENGINE_YDP,
+	GYDP_ENGINE_MERGE,
 } GydpEngine;
 
 typedef enum {
@@ -74,6 +76,9 @@ typedef enum {
 /* gydp enums management */
 GEnumClass  *gydp_enum                (GydpEnum type);
 
+/* value given by nick or name (NULL if unknown or name is NULL) */
+GEnumValue  *gydp_enum_value          (GydpEnum type, const gchar *name);
+
 /* gydp enum helper functions */
 const gchar *gydp_lang_value_to_name  (GydpLang lang);
 const gchar *gydp_lang_value_to_nick  (GydpLang lang);
@@ -0,0 +1,466 @@
+/*
+ * Copyright (C) 2008 Michał Kurgan <michal.kurgan@moloh.net>
+ *
+ * This file is part of gydpdict.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gydpdict.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gydp_index.h"
+#include "gydp_cache.h"
+#include "gydp_text.h"
+
+#include <math.h>
+#include <string.h>
+
+/* shortest indexed term (characters) */
+#define GYDP_INDEX_TERM_MIN 2
+
+typedef struct GydpIndexPosting {
+	guint32 entry;     /* entry containing term */
+	guint32 count;     /* term occurrences in entry */
+} GydpIndexPosting;
+
+typedef struct GydpIndexHit {
+	guint entry;
+	gdouble score;
+} GydpIndexHit;
+
+struct _GydpIndex {
+	GydpCache *cache;                  /* index cache (keeps sections mapped) */
+	const gchar *terms;                /* terms (sorted, terminated) */
+	const guint32 *term;               /* term offsets in terms */
+	const guint32 *start;              /* first posting of every term (and end) */
+	const GydpIndexPosting *postings;  /* postings of all terms (ordered by entry) */
+	gsize length;                      /* size of terms */
+	guint size;                        /* number of terms */
+	guint entries;                     /* number of indexed entries */
+	gboolean mapped;                   /* data is owned by index cache */
+};
+
+/* term callback, takes ownership of term */
+typedef void (*GydpIndexTermFunc)(gchar *term, gpointer data);
+
+/* private functions */
+static GydpCache *gydp_index_cache     (GydpDict *dict);
+static void     gydp_index_terms       (const gchar *text, gsize len, GydpIndexTermFunc func, gpointer data);
+static gboolean gydp_index_build       (GydpIndex *self, GydpDict *dict, GCancellable *cancellable);
+static void     gydp_index_build_term  (gchar *term, gpointer data);
+static void     gydp_index_store       (GydpIndex *self, GydpCache *cache);
+static gboolean gydp_index_restore     (GydpIndex *self, GydpCache *cache);
+static gint     gydp_index_find        (GydpIndex *self, const gchar *word);
+static void     gydp_index_query_term  (gchar *term, gpointer data);
+static gint     gydp_index_compare_term(gconstpointer a, gconstpointer b);
+static gint     gydp_index_compare_hit (gconstpointer a, gconstpointer b);
+
+/** gydp_index_open
+ * use index cache of dictionary files if it is up to date (cheap, index is
+ * used in place), NULL if index has to be built
+ */
+GydpIndex *gydp_index_open(GydpDict *dict) {
+	GydpCache *cache = gydp_index_cache(dict);
+	GydpIndex *self;
+
+	if( cache == NULL )
+		return NULL;
+
+	self = g_slice_new0(GydpIndex);
+	self->entries = gydp_dict_size(dict);
+
+	if( gydp_cache_load(cache) && gydp_index_restore(self, cache) ) {
+		self->cache = cache;
+		return self;
+	}
+
+	/* free temporary data */
+	gydp_cache_free(cache);
+	g_slice_free(GydpIndex, self);
+	return NULL;
+}
+
+/** gydp_index_new
+ * read all definitions, build index and save it in cache, may be called in
+ * any thread for dictionary used only by it (NULL if cancelled)
+ */
+GydpIndex *gydp_index_new(GydpDict *dict, GCancellable *cancellable) {
+	GydpIndex *self = g_slice_new0(GydpIndex);
+	GydpCache *cache;
+
+	self->entries = gydp_dict_size(dict);
+
+	if( !gydp_index_build(self, dict, cancellable) ) {
+		g_slice_free(GydpIndex, self);
+		return NULL;
+	}
+
+	/* save index for next session */
+	if( (cache = gydp_index_cache(dict)) != NULL ) {
+		gydp_index_store(self, cache);
+		gydp_cache_save(cache);
+		gydp_cache_free(cache);
+	}
+
+	return self;
+}
+
+void gydp_index_free(GydpIndex *self) {
+	if( self != NULL ) {
+		if( !self->mapped ) {
+			g_free((gchar *)self->terms);
+			g_free((guint32 *)self->term);
+			g_free((guint32 *)self->start);
+			g_free((GydpIndexPosting *)self->postings);
+		}
+		gydp_cache_free(self->cache);
+
+		g_slice_free(GydpIndex, self);
+	}
+}
+
+gsize gydp_index_memory(GydpIndex *self) {
+	return self->length + (2 * self->size + 1) * sizeof(guint32) +
+		self->start[self->size] * sizeof(GydpIndexPosting);
+}
+
+/** gydp_index_query
+ * entries are ranked by sum of term frequency times inverse document
+ * frequency, postings are intersected starting with rarest term
+ */
+GArray *gydp_index_query(GydpIndex *self, const gchar *query, guint limit) {
+	GArray *result = g_array_new(FALSE, FALSE, sizeof(guint));
+	GPtrArray *words = g_ptr_array_new();
+	GArray *hits = g_array_new(FALSE, FALSE, sizeof(GydpIndexHit));
+	gint *found = NULL;
+	guint i;
+
+	/* process query like definitions */
+	gydp_index_terms(query, strlen(query), gydp_index_query_term, words);
+
+	while( words->len ) {
+		found = g_new(gint, words->len);
+
+		/* every term has to be present */
+		for(i = 0; i < words->len; ++i)
+			if( (found[i] = gydp_index_find(self, g_ptr_array_index(words, i))) < 0 )
+				break;
+		if( i < words->len )
+			break;
+
+		/* order terms by number of entries (insertion sort, queries are short) */
+		for(i = 1; i < words->len; ++i)
+			for(guint j = i; j > 0 && self->start[found[j] + 1] - self->start[found[j]] <
+					self->start[found[j - 1] + 1] - self->start[found[j - 1]]; --j) {
+				const gint swap = found[j];
+				found[j] = found[j - 1];
+				found[j - 1] = swap;
+			}
+
+		for(i = 0; i < words->len; ++i) {
+			const GydpIndexPosting *posting = self->postings + self->start[found[i]];
+			const guint count = self->start[found[i] + 1] - self->start[found[i]];
+			const gdouble idf = log((self->entries + 1.0) / count);
+
+			/* rarest term gives candidates */
+			if( i == 0 ) {
+				for(guint n = 0; n < count; ++n) {
+					GydpIndexHit hit = { posting[n].entry, posting[n].count * idf };
+					g_array_append_val(hits, hit);
+				}
+				continue;
+			}
+
+			/* keep candidates containing term (both are ordered by entry) */
+			guint kept = 0, n = 0;
+			for(guint h = 0; h < hits->len; ++h) {
+				GydpIndexHit *hit = &g_array_index(hits, GydpIndexHit, h);
+
+				while( n < count && posting[n].entry < hit->entry )
+					++n;
+				if( n == count )
+					break;
+				if( posting[n].entry == hit->entry ) {
+					hit->score += posting[n].count * idf;
+					g_array_index(hits, GydpIndexHit, kept++) = *hit;
+				}
+			}
+			g_array_set_size(hits, kept);
+		}
+
+		/* best entries first */
+		g_array_sort(hits, gydp_index_compare_hit);
+		for(i = 0; i < hits->len && i < limit; ++i)
+			g_array_append_val(result, g_array_index(hits, GydpIndexHit, i).entry);
+		break;
+	}
+
+	/* free temporary data */
+	g_ptr_array_foreach(words, (GFunc)g_free, NULL);
+	g_ptr_array_free(words, TRUE);
+	g_array_free(hits, TRUE);
+	g_free(found);
+
+	return result;
+}
+
+/* full-text index is kept apart from engine index cache */
+static GydpCache *gydp_index_cache(GydpDict *dict) {
+	const gchar *const *sources = gydp_dict_sources(dict);
+	GydpCache *cache;
+
+	if( sources == NULL )
+		return NULL;
+
+	gchar *name = g_strconcat(gydp_engine_value_to_nick(dict->engine), "-text", NULL);
+	cache = gydp_cache_new(name, sources);
+	g_free(name);
+
+	return cache;
+}
+
+/** gydp_index_terms
+ * terms are runs of letters and digits, processed for comparison like
+ * headwords (ascii terms are only lowered)
+ */
+static void gydp_index_terms(const gchar *text, gsize len, GydpIndexTermFunc func, gpointer data) {
+	const gchar *pos = text, *end = text + len;
+
+	while( pos < end ) {
+		const gchar *begin = pos;
+		gboolean ascii = TRUE;
+		guint chars = 0;
+
+		/* collect term characters */
+		while( pos < end ) {
+			if( (guchar)*pos < 128 ) {
+				if( !g_ascii_isalnum(*pos) )
+					break;
+				++pos;
+			} else {
+				if( !g_unichar_isalnum(g_utf8_get_char(pos)) )
+					break;
+				ascii = FALSE;
+				pos = MIN(g_utf8_next_char(pos), end);
+			}
+			++chars;
+		}
+
+		if( chars >= GYDP_INDEX_TERM_MIN ) {
+			if( ascii )
+				func(g_ascii_strdown(begin, pos - begin), data);
+			else {
+				gchar *term = g_strndup(begin, pos - begin);
+				func(gydp_str_process(term), data);
+				g_free(term);
+			}
+		}
+
+		/* skip separator */
+		if( chars == 0 )
+			pos = MIN(g_utf8_next_char(pos), end);
+	}
+}
+
+typedef struct GydpIndexBuild {
+	GHashTable *table;   /* term -> GArray of postings */
+	guint32 entry;       /* current entry */
+} GydpIndexBuild;
+
+/* entries rendered between cancellation checks */
+#define GYDP_INDEX_BUILD_SLICE 256
+
+static gboolean gydp_index_build(GydpIndex *self, GydpDict *dict, GCancellable *cancellable) {
+	GydpDictClass *klass = GYDP_DICT_GET_CLASS(dict);
+	GydpText *text = gydp_text_new();
+	GydpIndexBuild build;
+
+	build.table = g_hash_table_new(g_str_hash, g_str_equal);
+
+	/* collect postings of all entries (appended in entry order) */
+	for(build.entry = 0; build.entry < self->entries; ++build.entry) {
+		if( build.entry % GYDP_INDEX_BUILD_SLICE == 0 && g_cancellable_is_cancelled(cancellable) )
+			break;
+		if( klass->text(dict, build.entry, text) )
+			gydp_index_terms(text->text->str, text->text->len, gydp_index_build_term, &build);
+	}
+
+	GHashTableIter it;
+	gpointer key, value;
+
+	/* drop partial postings */
+	if( build.entry < self->entries ) {
+		g_hash_table_iter_init(&it, build.table);
+		while( g_hash_table_iter_next(&it, &key, &value) ) {
+			g_array_free(value, TRUE);
+			g_free(key);
+		}
+		g_hash_table_destroy(build.table);
+		gydp_text_free(text);
+		return FALSE;
+	}
+
+	/* sort terms for binary search */
+	GPtrArray *terms = g_ptr_array_sized_new(g_hash_table_size(build.table));
+	gsize count = 0;
+
+	g_hash_table_iter_init(&it, build.table);
+	while( g_hash_table_iter_next(&it, &key, &value) ) {
+		g_ptr_array_add(terms, key);
+		count += ((GArray *)value)->len;
+	}
+	g_ptr_array_sort(terms, gydp_index_compare_term);
+
+	/* store terms and postings in single blocks */
+	GString *data = g_string_sized_new(terms->len * 8);
+	guint32 *term = g_new(guint32, terms->len);
+	guint32 *start = g_new(guint32, terms->len + 1);
+	GydpIndexPosting *postings = g_new(GydpIndexPosting, count);
+
+	count = 0;
+	for(guint i = 0; i < terms->len; ++i) {
+		gchar *word = g_ptr_array_index(terms, i);
+		GArray *list = g_hash_table_lookup(build.table, word);
+
+		term[i] = data->len;
+		g_string_append_len(data, word, strlen(word) + 1);
+
+		start[i] = count;
+		memcpy(postings + count, list->data, list->len * sizeof(GydpIndexPosting));
+		count += list->len;
+
+		/* free temporary data */
+		g_array_free(list, TRUE);
+		g_free(word);
+	}
+	start[terms->len] = count;
+
+	self->size = terms->len;
+	self->length = data->len;
+	self->terms = g_string_free(data, FALSE);
+	self->term = term;
+	self->start = start;
+	self->postings = postings;
+
+	/* free temporary data */
+	g_ptr_array_free(terms, TRUE);
+	g_hash_table_destroy(build.table);
+	gydp_text_free(text);
+
+	return TRUE;
+}
+
+static void gydp_index_build_term(gchar *term, gpointer data) {
+	GydpIndexBuild *build = data;
+	GArray *list = g_hash_table_lookup(build->table, term);
+
+	if( list == NULL ) {
+		list = g_array_new(FALSE, FALSE, sizeof(GydpIndexPosting));
+		g_hash_table_insert(build->table, term, list);
+	} else
+		g_free(term);
+
+	/* count occurrences in current entry */
+	if( list->len && g_array_index(list, GydpIndexPosting, list->len - 1).entry == build->entry )
+		g_array_index(list, GydpIndexPosting, list->len - 1).count += 1;
+	else {
+		GydpIndexPosting posting = { build->entry, 1 };
+		g_array_append_val(list, posting);
+	}
+}
+
+static void gydp_index_store(GydpIndex *self, GydpCache *cache) {
+	gydp_cache_set(cache, GYDP_CACHE_TEXT_TERMS, self->terms, self->length);
+	gydp_cache_set(cache, GYDP_CACHE_TEXT_TERM, self->term, self->size * sizeof(guint32));
+	gydp_cache_set(cache, GYDP_CACHE_TEXT_START, self->start, (self->size + 1) * sizeof(guint32));
+	gydp_cache_set(cache, GYDP_CACHE_TEXT_POSTINGS, self->postings,
+			self->start[self->size] * sizeof(GydpIndexPosting));
+}
+
+/** gydp_index_restore
+ * use index directly from loaded cache, all offsets are validated so that
+ * broken cache can not cause reads outside of mapping, and terms have to be
+ * sorted and postings ordered by entry as binary search and intersection
+ * of postings expect
+ */
+static gboolean gydp_index_restore(GydpIndex *self, GydpCache *cache) {
+	gsize length, term_size, start_size, postings_size;
+	const gchar *terms = gydp_cache_get(cache, GYDP_CACHE_TEXT_TERMS, &length);
+	const guint32 *term = gydp_cache_get(cache, GYDP_CACHE_TEXT_TERM, &term_size);
+	const guint32 *start = gydp_cache_get(cache, GYDP_CACHE_TEXT_START, &start_size);
+	const GydpIndexPosting *postings = gydp_cache_get(cache, GYDP_CACHE_TEXT_POSTINGS, &postings_size);
+	const gsize size = term_size / sizeof(guint32);
+	const gsize count = postings_size / sizeof(GydpIndexPosting);
+
+	/* validate sections */
+	if( term_size % sizeof(guint32) || postings_size % sizeof(GydpIndexPosting) ||
+			start_size != (size + 1) * sizeof(guint32) ||
+			start[0] != 0 || start[size] != count ||
+			(size > 0 && (length == 0 || terms[length - 1] != '\0')) )
+		return FALSE;
+
+	for(gsize i = 0; i < size; ++i)
+		if( term[i] >= length || start[i] > start[i + 1] ||
+				(i > 0 && strcmp(terms + term[i - 1], terms + term[i]) >= 0) )
+			return FALSE;
+
+	for(gsize i = 0; i < size; ++i)
+		for(guint32 n = start[i]; n < start[i + 1]; ++n)
+			if( postings[n].entry >= self->entries ||
+					(n > start[i] && postings[n - 1].entry >= postings[n].entry) )
+				return FALSE;
+
+	/* index is used in place */
+	self->terms = terms;
+	self->term = term;
+	self->start = start;
+	self->postings = postings;
+	self->length = length;
+	self->size = size;
+	self->mapped = TRUE;
+
+	return TRUE;
+}
+
+static gint gydp_index_find(GydpIndex *self, const gchar *word) {
+	guint lower = 0, upper = self->size;
+
+	while( lower < upper ) {
+		const guint middle = lower + (upper - lower) / 2;
+		const gint result = strcmp(self->terms + self->term[middle], word);
+
+		if( result == 0 )
+			return middle;
+		if( result < 0 )
+			lower = middle + 1;
+		else
+			upper = middle;
+	}
+
+	return -1;
+}
+
+static void gydp_index_query_term(gchar *term, gpointer data) {
+	g_ptr_array_add(data, term);
+}
+
+static gint gydp_index_compare_term(gconstpointer a, gconstpointer b) {
+	return strcmp(*(const gchar **)a, *(const gchar **)b);
+}
+
+static gint gydp_index_compare_hit(gconstpointer a, gconstpointer b) {
+	const GydpIndexHit *x = a, *y = b;
+
+	if( x->score != y->score )
+		return x->score > y->score? -1: 1;
+	return x->entry < y->entry? -1: x->entry > y->entry;
+}
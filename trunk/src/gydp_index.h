@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2008 Michał Kurgan <michal.kurgan@moloh.net>
+ *
+ * This file is part of gydpdict.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gydpdict.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GYDP_INDEX_H__
+#define __GYDP_INDEX_H__
+
+#include "gydp_global.h"
+#include "gydp_dict.h"
+
+G_BEGIN_DECLS
+
+typedef struct _GydpIndex GydpIndex;
+
+/* full-text index of dictionary definitions, restored from cache (NULL if
+ * there is no valid one) or built from all definitions (NULL if cancelled) */
+GydpIndex *gydp_index_open (GydpDict *dict);
+GydpIndex *gydp_index_new  (GydpDict *dict, GCancellable *cancellable);
+void       gydp_index_free (GydpIndex *self);
+gsize      gydp_index_memory(GydpIndex *self);
+
+/* entries containing all query terms, best first (guint array) */
+GArray    *gydp_index_query(GydpIndex *self, const gchar *query, guint limit);
+
+G_END_DECLS
+
+#endif /* __GYDP_INDEX_H__ */
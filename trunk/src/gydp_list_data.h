@@ -36,7 +36,7 @@ typedef struct _GydpListData      GydpListData;
 struct _GydpListDataIface {
 	GTypeInterface __parent__;
 
-	/* virtual table */
+	/* virtual table (item is valid until next item is requested) */
 	guint        (*get_items)(GydpListData *list_data);
 	const gchar *(*get_item) (GydpListData *list_data, guint n);
 };
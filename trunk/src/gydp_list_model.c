@@ -0,0 +1,358 @@
+/*
+ * Copyright (C) 2008 Michał Kurgan <michal.kurgan@moloh.net>
+ *
+ * This file is part of gydpdict.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gydpdict.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gydp_list_model.h"
+
+struct _GydpListModelClass {
+	GObjectClass __parent__;
+};
+
+struct _GydpListModel {
+	GObject __parent__;
+
+	/* exposed range of list data */
+	guint offset;           /* first exposed item */
+	guint length;           /* exposed items limit */
+	guint rows;             /* rows announced to views */
+	gint stamp;             /* iterator validity stamp */
+
+	/* properties */
+	GydpListData *data;
+};
+
+static GObjectClass *gydp_list_model_parent_klass = NULL;
+
+/* private GObject functions */
+static void     gydp_list_model_init      (GydpListModel *self);
+static void     gydp_list_model_class_init(GydpListModelClass *klass);
+static void     gydp_list_model_finalize  (GObject *object);
+
+/* private interface callbacks */
+static void              gydp_list_model_iface_init          (GtkTreeModelIface *iface);
+static GtkTreeModelFlags gydp_list_model_iface_get_flags     (GtkTreeModel *model);
+static gint              gydp_list_model_iface_get_n_columns (GtkTreeModel *model);
+static GType             gydp_list_model_iface_get_column_type(GtkTreeModel *model, gint column);
+static gboolean          gydp_list_model_iface_get_iter      (GtkTreeModel *model, GtkTreeIter *iter, GtkTreePath *path);
+static GtkTreePath      *gydp_list_model_iface_get_path      (GtkTreeModel *model, GtkTreeIter *iter);
+static void              gydp_list_model_iface_get_value     (GtkTreeModel *model, GtkTreeIter *iter, gint column, GValue *value);
+static gboolean          gydp_list_model_iface_iter_next     (GtkTreeModel *model, GtkTreeIter *iter);
+static gboolean          gydp_list_model_iface_iter_children (GtkTreeModel *model, GtkTreeIter *iter, GtkTreeIter *parent);
+static gboolean          gydp_list_model_iface_iter_has_child(GtkTreeModel *model, GtkTreeIter *iter);
+static gint              gydp_list_model_iface_iter_n_children(GtkTreeModel *model, GtkTreeIter *iter);
+static gboolean          gydp_list_model_iface_iter_nth_child(GtkTreeModel *model, GtkTreeIter *iter, GtkTreeIter *parent, gint n);
+static gboolean          gydp_list_model_iface_iter_parent   (GtkTreeModel *model, GtkTreeIter *iter, GtkTreeIter *child);
+
+/* private callbacks */
+static void     gydp_list_model_data_changed(GydpListData *list_data, gpointer data);
+
+/* private functions */
+static gboolean gydp_list_model_iter   (GydpListModel *self, GtkTreeIter *iter, guint row);
+static guint    gydp_list_model_rows   (GydpListModel *self);
+static void     gydp_list_model_insert (GydpListModel *self, guint row);
+static void     gydp_list_model_delete (GydpListModel *self, guint row);
+static void     gydp_list_model_resize (GydpListModel *self, guint rows);
+
+GType gydp_list_model_get_type() {
+	static GType type = G_TYPE_INVALID;
+	if( G_UNLIKELY( type == G_TYPE_INVALID ) ) {
+		static const GTypeInfo info = {
+			sizeof(GydpListModelClass),                        /* class size */
+			NULL, NULL,                                        /* base init, finalize */
+			(GClassInitFunc) gydp_list_model_class_init, NULL, /* class init, finalize */
+			NULL,                                              /* class init, finalize user_data */
+			sizeof(GydpListModel), 0,                          /* base size, prealloc size */
+			(GInstanceInitFunc) gydp_list_model_init,          /* instance init */
+			NULL,                                              /* GValue table */
+		};
+		static const GInterfaceInfo tree_model_info = {
+			(GInterfaceInitFunc) gydp_list_model_iface_init,   /* iface init */
+			(GInterfaceFinalizeFunc) NULL,                     /* iface finalize */
+			NULL                                               /* iface data */
+		};
+
+		type = g_type_register_static(G_TYPE_OBJECT, "GydpListModel", &info, 0);
+		g_type_add_interface_static(type, GTK_TYPE_TREE_MODEL, &tree_model_info);
+	}
+
+	return type;
+}
+
+GydpListModel *gydp_list_model_new(GydpListData *list_data) {
+	GydpListModel *model = g_object_new(GYDP_TYPE_LIST_MODEL, NULL);
+	gydp_list_model_set_data(model, list_data);
+	return model;
+}
+
+void gydp_list_model_set_data(GydpListModel *model, GydpListData *list_data) {
+	g_return_if_fail( GYDP_IS_LIST_MODEL(model) );
+	g_return_if_fail( list_data == NULL || GYDP_IS_LIST_DATA(list_data) );
+
+	if( model->data == list_data )
+		return;
+
+	/* rows of previous data are not related to new ones */
+	gydp_list_model_resize(model, 0);
+
+	/* hold reference for new data before previous one is released */
+	if( list_data != NULL ) {
+		g_object_ref(list_data);
+		g_signal_connect_object(G_OBJECT(list_data), "changed",
+				G_CALLBACK(gydp_list_model_data_changed), model, 0);
+	}
+	if( model->data != NULL ) {
+		g_signal_handlers_disconnect_by_func(G_OBJECT(model->data),
+				G_CALLBACK(gydp_list_model_data_changed), model);
+		g_object_unref(model->data);
+	}
+	model->data = list_data;
+
+	/* announce rows of new data */
+	gydp_list_model_resize(model, gydp_list_model_rows(model));
+}
+
+GydpListData *gydp_list_model_get_data(GydpListModel *model) {
+	g_return_val_if_fail( GYDP_IS_LIST_MODEL(model), NULL );
+	return model->data;
+}
+
+/** gydp_list_model_set_range
+ * exposed rows work as a ring, when range moves by less than its size rows
+ * leaving it are deleted at one end and new rows inserted at the other, so
+ * views keep remaining rows (and selection) and only read items of new ones,
+ * distant move replaces all rows
+ */
+void gydp_list_model_set_range(GydpListModel *model, guint offset, guint length) {
+	g_return_if_fail( GYDP_IS_LIST_MODEL(model) );
+
+	model->length = length;
+
+	/* rows exposed at new offset (range is kept by trailing rows update) */
+	const guint items = model->data != NULL? gydp_list_data_get_items(model->data): 0;
+	const guint rows = offset < items? MIN(items - offset, length): 0;
+
+	if( offset > model->offset && offset - model->offset < model->rows ) {
+		/* moved forward, leading rows scrolled out */
+		for(guint n = offset - model->offset; n > 0; --n) {
+			model->offset += 1;
+			gydp_list_model_delete(model, 0);
+		}
+	} else if( offset < model->offset && model->offset - offset < rows && model->rows > 0 ) {
+		/* moved backward, leading rows scrolled in */
+		for(guint n = model->offset - offset; n > 0; --n) {
+			model->offset -= 1;
+			gydp_list_model_insert(model, 0);
+		}
+	} else if( offset != model->offset ) {
+		/* nothing in common */
+		gydp_list_model_resize(model, 0);
+		model->offset = offset;
+	}
+
+	/* trailing rows */
+	gydp_list_model_resize(model, gydp_list_model_rows(model));
+}
+
+static void gydp_list_model_init(GydpListModel *self) {
+	self->offset = 0;
+	self->length = G_MAXUINT;
+	self->rows = 0;
+	self->stamp = g_random_int();
+	self->data = NULL;
+}
+
+static void gydp_list_model_class_init(GydpListModelClass *klass) {
+	/* determine parent class */
+	gydp_list_model_parent_klass = g_type_class_peek_parent(klass);
+
+	GObjectClass *gobject_klass = G_OBJECT_CLASS(klass);
+	gobject_klass->finalize = gydp_list_model_finalize;
+}
+
+static void gydp_list_model_finalize(GObject *object) {
+	GydpListModel *model = GYDP_LIST_MODEL(object);
+
+	if( model->data != NULL ) {
+		g_signal_handlers_disconnect_by_func(G_OBJECT(model->data),
+				G_CALLBACK(gydp_list_model_data_changed), model);
+		g_object_unref(model->data);
+	}
+
+	/* chain to parent finalize */
+	gydp_list_model_parent_klass->finalize(object);
+}
+
+static void gydp_list_model_iface_init(GtkTreeModelIface *iface) {
+	iface->get_flags = gydp_list_model_iface_get_flags;
+	iface->get_n_columns = gydp_list_model_iface_get_n_columns;
+	iface->get_column_type = gydp_list_model_iface_get_column_type;
+	iface->get_iter = gydp_list_model_iface_get_iter;
+	iface->get_path = gydp_list_model_iface_get_path;
+	iface->get_value = gydp_list_model_iface_get_value;
+	iface->iter_next = gydp_list_model_iface_iter_next;
+	iface->iter_children = gydp_list_model_iface_iter_children;
+	iface->iter_has_child = gydp_list_model_iface_iter_has_child;
+	iface->iter_n_children = gydp_list_model_iface_iter_n_children;
+	iface->iter_nth_child = gydp_list_model_iface_iter_nth_child;
+	iface->iter_parent = gydp_list_model_iface_iter_parent;
+}
+
+static GtkTreeModelFlags gydp_list_model_iface_get_flags(GtkTreeModel *model G_GNUC_UNUSED) {
+	return GTK_TREE_MODEL_LIST_ONLY;
+}
+
+static gint gydp_list_model_iface_get_n_columns(GtkTreeModel *model G_GNUC_UNUSED) {
+	return GYDP_LIST_MODEL_COLUMNS;
+}
+
+static GType gydp_list_model_iface_get_column_type(GtkTreeModel *model G_GNUC_UNUSED, gint column) {
+	switch( column ) {
+	case GYDP_LIST_MODEL_COLUMN_WORD: return G_TYPE_STRING;
+	case GYDP_LIST_MODEL_COLUMN_ID:   return G_TYPE_INT;
+	default:
+		g_return_val_if_reached(G_TYPE_INVALID);
+	}
+}
+
+static gboolean gydp_list_model_iface_get_iter(GtkTreeModel *model, GtkTreeIter *iter, GtkTreePath *path) {
+	if( gtk_tree_path_get_depth(path) != 1 )
+		return FALSE;
+	return gydp_list_model_iter(GYDP_LIST_MODEL(model), iter, gtk_tree_path_get_indices(path)[0]);
+}
+
+static GtkTreePath *gydp_list_model_iface_get_path(GtkTreeModel *model, GtkTreeIter *iter) {
+	g_return_val_if_fail( iter->stamp == GYDP_LIST_MODEL(model)->stamp, NULL );
+	return gtk_tree_path_new_from_indices(GPOINTER_TO_UINT(iter->user_data), -1);
+}
+
+/** gydp_list_model_iface_get_value
+ * items are copied, list data may keep only last requested item
+ */
+static void gydp_list_model_iface_get_value(GtkTreeModel *model, GtkTreeIter *iter, gint column, GValue *value) {
+	GydpListModel *self = GYDP_LIST_MODEL(model);
+	const guint n = self->offset + GPOINTER_TO_UINT(iter->user_data);
+
+	g_return_if_fail( iter->stamp == self->stamp );
+
+	switch( column ) {
+	case GYDP_LIST_MODEL_COLUMN_WORD:
+		g_value_init(value, G_TYPE_STRING);
+		g_value_set_string(value, gydp_list_data_get_item(self->data, n));
+		break;
+	case GYDP_LIST_MODEL_COLUMN_ID:
+		g_value_init(value, G_TYPE_INT);
+		g_value_set_int(value, n);
+		break;
+	default:
+		g_return_if_reached();
+	}
+}
+
+static gboolean gydp_list_model_iface_iter_next(GtkTreeModel *model, GtkTreeIter *iter) {
+	return gydp_list_model_iter(GYDP_LIST_MODEL(model), iter, GPOINTER_TO_UINT(iter->user_data) + 1);
+}
+
+static gboolean gydp_list_model_iface_iter_children(GtkTreeModel *model, GtkTreeIter *iter, GtkTreeIter *parent) {
+	return gydp_list_model_iface_iter_nth_child(model, iter, parent, 0);
+}
+
+static gboolean gydp_list_model_iface_iter_has_child(GtkTreeModel *model G_GNUC_UNUSED, GtkTreeIter *iter G_GNUC_UNUSED) {
+	return FALSE;
+}
+
+static gint gydp_list_model_iface_iter_n_children(GtkTreeModel *model, GtkTreeIter *iter) {
+	/* only root has children */
+	return iter == NULL? (gint)GYDP_LIST_MODEL(model)->rows: 0;
+}
+
+static gboolean gydp_list_model_iface_iter_nth_child(GtkTreeModel *model, GtkTreeIter *iter, GtkTreeIter *parent, gint n) {
+	if( parent != NULL || n < 0 )
+		return FALSE;
+	return gydp_list_model_iter(GYDP_LIST_MODEL(model), iter, n);
+}
+
+static gboolean gydp_list_model_iface_iter_parent(GtkTreeModel *model G_GNUC_UNUSED, GtkTreeIter *iter G_GNUC_UNUSED,
+		GtkTreeIter *child G_GNUC_UNUSED) {
+	return FALSE;
+}
+
+/** gydp_list_model_data_changed
+ * items of list data may differ at every position, refresh exposed rows
+ */
+static void gydp_list_model_data_changed(GydpListData *list_data G_GNUC_UNUSED, gpointer data) {
+	GydpListModel *model = GYDP_LIST_MODEL(data);
+	GtkTreeIter it;
+
+	gydp_list_model_resize(model, gydp_list_model_rows(model));
+
+	for(guint row = 0; row < model->rows; ++row) {
+		GtkTreePath *path = gtk_tree_path_new_from_indices(row, -1);
+
+		gydp_list_model_iter(model, &it, row);
+		gtk_tree_model_row_changed(GTK_TREE_MODEL(model), path, &it);
+		gtk_tree_path_free(path);
+	}
+}
+
+static gboolean gydp_list_model_iter(GydpListModel *self, GtkTreeIter *iter, guint row) {
+	if( row >= self->rows )
+		return FALSE;
+
+	iter->stamp = self->stamp;
+	iter->user_data = GUINT_TO_POINTER(row);
+	return TRUE;
+}
+
+static guint gydp_list_model_rows(GydpListModel *self) {
+	const guint items = self->data != NULL? gydp_list_data_get_items(self->data): 0;
+
+	if( self->offset >= items )
+		return 0;
+	return MIN(items - self->offset, self->length);
+}
+
+/** gydp_list_model_insert
+ * count new row at position and announce it
+ */
+static void gydp_list_model_insert(GydpListModel *self, guint row) {
+	GtkTreePath *path = gtk_tree_path_new_from_indices(row, -1);
+	GtkTreeIter it;
+
+	self->rows += 1;
+	gydp_list_model_iter(self, &it, row);
+	gtk_tree_model_row_inserted(GTK_TREE_MODEL(self), path, &it);
+	gtk_tree_path_free(path);
+}
+
+static void gydp_list_model_delete(GydpListModel *self, guint row) {
+	GtkTreePath *path = gtk_tree_path_new_from_indices(row, -1);
+
+	self->rows -= 1;
+	gtk_tree_model_row_deleted(GTK_TREE_MODEL(self), path);
+	gtk_tree_path_free(path);
+}
+
+/** gydp_list_model_resize
+ * add or remove rows at the end of list
+ */
+static void gydp_list_model_resize(GydpListModel *self, guint rows) {
+	while( self->rows > rows )
+		gydp_list_model_delete(self, self->rows - 1);
+	while( self->rows < rows )
+		gydp_list_model_insert(self, self->rows);
+}
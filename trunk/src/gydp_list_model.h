@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2008 Michał Kurgan <michal.kurgan@moloh.net>
+ *
+ * This file is part of gydpdict.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gydpdict.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GYDP_LIST_MODEL_H__
+#define __GYDP_LIST_MODEL_H__
+
+#include "gydp_global.h"
+#include "gydp_list_data.h"
+#include <gtk/gtk.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GydpListModelClass GydpListModelClass;
+typedef struct _GydpListModel      GydpListModel;
+
+/* list model columns */
+enum {
+	GYDP_LIST_MODEL_COLUMN_WORD,    /* item of list data (G_TYPE_STRING) */
+	GYDP_LIST_MODEL_COLUMN_ID,      /* index in list data (G_TYPE_INT) */
+	GYDP_LIST_MODEL_COLUMNS,
+};
+
+#define GYDP_TYPE_LIST_MODEL            (gydp_list_model_get_type())
+#define GYDP_LIST_MODEL(obj)            (G_TYPE_CHECK_INSTANCE_CAST((obj), GYDP_TYPE_LIST_MODEL, GydpListModel))
+#define GYDP_LIST_MODEL_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST((klass),  GYDP_TYPE_LIST_MODEL, GydpListModelClass))
+#define GYDP_IS_LIST_MODEL(obj)         (G_TYPE_CHECK_INSTANCE_TYPE((obj), GYDP_TYPE_LIST_MODEL))
+#define GYDP_IS_LIST_MODEL_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE((klass),  GYDP_TYPE_LIST_MODEL))
+#define GYDP_LIST_MODEL_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS((obj),  GYDP_TYPE_LIST_MODEL, GydpListModelClass))
+
+GType         gydp_list_model_get_type () G_GNUC_CONST;
+
+/* model exposing all items of list data (read in place) */
+GydpListModel *gydp_list_model_new     (GydpListData *list_data);
+
+void          gydp_list_model_set_data (GydpListModel *model, GydpListData *list_data);
+GydpListData *gydp_list_model_get_data (GydpListModel *model);
+
+/* expose only items offset .. offset + length (G_MAXUINT for all), rows of
+ * items exposed before are kept (moved), only new ones are announced */
+void          gydp_list_model_set_range(GydpListModel *model, guint offset, guint length);
+
+G_END_DECLS
+
+#endif /* __GYDP_LIST_MODEL_H__ */
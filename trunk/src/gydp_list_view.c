@@ -18,17 +18,11 @@
  */
 
 #include "gydp_list_view.h"
+#include "gydp_list_model.h"
 
 #include <gdk/gdkkeysyms.h>
 #include <string.h>
 
-/* list model columns */
-enum {
-	COLUMN_WORD,
-	COLUMN_ID,
-	COLUMNS,
-};
-
 /* signals */
 enum {
 	SIGNAL_CHANGED,
@@ -56,6 +50,7 @@ struct _GydpListView {
 
 	/* internal data */
 	gint height;            /* current widget height */
+	gint cell_height;       /* single row height (0 if not measured) */
 	gint selected;          /* currently selected item */
 
 	/* properties */
@@ -78,6 +73,8 @@ static void     gydp_list_view_selection_changed   (GtkTreeSelection *selection,
 static gboolean gydp_list_view_event_scroll        (GtkWidget *widget, GdkEventScroll *event, gpointer data);
 static gboolean gydp_list_view_event_button_press  (GtkWidget *widget, GdkEventButton *event, gpointer data);
 static void     gydp_list_view_size_allocate       (GtkWidget *widget, GtkAllocation *allocation, gpointer data);
+static void     gydp_list_view_style_set           (GtkWidget *widget, GtkStyle *previous, gpointer data);
+static void     gydp_list_view_data_changed        (GydpListData *list_data, gpointer data);
 static void     gydp_list_view_scroll_value_changed(GtkRange *range, gpointer data);
 
 /* private update functions */
@@ -110,18 +107,37 @@ GtkWidget *gydp_list_view_new() {
 
 void gydp_list_view_set_data(GydpListView *list_view, GydpListData *list_data) {
 	g_return_if_fail( GYDP_IS_LIST_VIEW(list_view) );
+	g_return_if_fail( list_data == NULL || GYDP_IS_LIST_DATA(list_data) );
+
+	GtkTreeModel *model = gtk_tree_view_get_model(GTK_TREE_VIEW(list_view->list));
 
 	/* unref previous data */
-	g_object_unref(list_view->data);
-	list_view->data = NULL;
+	if( list_view->data != NULL ) {
+		g_signal_handlers_disconnect_by_func(G_OBJECT(list_view->data),
+				G_CALLBACK(gydp_list_view_data_changed), list_view);
+		g_object_unref(list_view->data);
+		list_view->data = NULL;
+	}
+
+	/* rows of previous data are removed with selection */
+	list_view->selected = -1;
+	gydp_list_model_set_data(GYDP_LIST_MODEL(model), list_data);
 
 	/* hold reference for new data */
 	if( list_data != NULL ) {
-		g_return_if_fail( GYDP_IS_LIST_DATA(list_data) );
-
-		list_view->data = list_data;
-		g_object_unref(list_view->data);
+		list_view->data = g_object_ref(list_data);
+		g_signal_connect_object(G_OBJECT(list_data), "changed",
+				G_CALLBACK(gydp_list_view_data_changed), list_view, 0);
 	}
+
+	/* show new data from the top */
+	gydp_list_view_data_changed(list_data, list_view);
+	gtk_range_set_value(GTK_RANGE(list_view->scroll), 0);
+}
+
+GydpListData *gydp_list_view_get_data(GydpListView *list_view) {
+	g_return_val_if_fail( GYDP_IS_LIST_VIEW(list_view), NULL );
+	return list_view->data;
 }
 
 static void gydp_list_view_init(GydpListView *self) {
@@ -129,6 +145,7 @@ static void gydp_list_view_init(GydpListView *self) {
 	/* init data */
 	self->selected = -1;
 	self->height = GTK_WIDGET(self)->allocation.height;
+	self->cell_height = 0;
 
 	/* init properties */
 
@@ -143,13 +160,14 @@ static void gydp_list_view_init(GydpListView *self) {
 	gtk_tree_selection_set_mode(selection, GTK_SELECTION_SINGLE);
 
 	{ /* list/view model */
-		GtkListStore *store = gtk_list_store_new(COLUMNS, G_TYPE_STRING, G_TYPE_INT);
+		GydpListModel *store = gydp_list_model_new(NULL);
 		GtkCellRenderer *renderer = gtk_cell_renderer_text_new();
 		GtkTreeViewColumn *column = gtk_tree_view_column_new_with_attributes(
-				"Word", renderer, "text", COLUMN_WORD, NULL);
+				"Word", renderer, "text", GYDP_LIST_MODEL_COLUMN_WORD, NULL);
 		gtk_tree_view_column_set_sizing(column, GTK_TREE_VIEW_COLUMN_FIXED);
 		gtk_tree_view_append_column(GTK_TREE_VIEW(self->list), column);
 		gtk_tree_view_set_model(GTK_TREE_VIEW(self->list), GTK_TREE_MODEL(store));
+		g_object_unref(store);
 	}
 
 	/* list scroll */
@@ -165,6 +183,8 @@ static void gydp_list_view_init(GydpListView *self) {
 			G_CALLBACK(gydp_list_view_selection_changed), self);
 	g_signal_connect(G_OBJECT(self->list), "size-allocate",
 			G_CALLBACK(gydp_list_view_size_allocate), self);
+	g_signal_connect(G_OBJECT(self->list), "style-set",
+			G_CALLBACK(gydp_list_view_style_set), self);
 	g_signal_connect(G_OBJECT(self->list), "scroll-event",
 			G_CALLBACK(gydp_list_view_event_scroll), self);
 	g_signal_connect(G_OBJECT(self->list), "button-press-event",
@@ -204,6 +224,14 @@ static GObject *gydp_list_view_constructor(GType type, guint n, GObjectConstruct
 }
 
 static void gydp_list_view_finalize(GObject *object) {
+	GydpListView *list_view = GYDP_LIST_VIEW(object);
+
+	if( list_view->data != NULL ) {
+		g_signal_handlers_disconnect_by_func(G_OBJECT(list_view->data),
+				G_CALLBACK(gydp_list_view_data_changed), list_view);
+		g_object_unref(list_view->data);
+	}
+
 	/* chain to parent finalize */
 	gydp_list_view_parent_klass->finalize(object);
 }
@@ -243,7 +271,7 @@ static void gydp_list_view_selection_changed(GtkTreeSelection *selection, gpoint
 
 	/* check if any item is actually selected */
 	if( gtk_tree_selection_get_selected(selection, &model, &it) ) {
-		gtk_tree_model_get(model, &it, COLUMN_WORD, &word, COLUMN_ID, &current, -1);
+		gtk_tree_model_get(model, &it, GYDP_LIST_MODEL_COLUMN_WORD, &word, GYDP_LIST_MODEL_COLUMN_ID, &current, -1);
 
 		/* check if selected new item */
 		if( listview->selected != current ) {
@@ -312,6 +340,35 @@ static void gydp_list_view_size_allocate(GtkWidget *widget, GtkAllocation *alloc
 	}
 }
 
+/** gydp_list_view_style_set
+ * font or theme change alters row height, measure it again
+ */
+static void gydp_list_view_style_set(GtkWidget *widget G_GNUC_UNUSED, GtkStyle *previous G_GNUC_UNUSED, gpointer data) {
+	GydpListView *listview = GYDP_LIST_VIEW(data);
+
+	listview->cell_height = 0;
+
+	/* update the list and list selection */
+	gydp_list_view_update(listview);
+	gydp_list_view_update_select(listview);
+}
+
+/** gydp_list_view_data_changed
+ * items were added or replaced, update scroll range and visible rows
+ */
+static void gydp_list_view_data_changed(GydpListData *list_data, gpointer data) {
+	GydpListView *listview = GYDP_LIST_VIEW(data);
+	GtkAdjustment *adjustment = gtk_range_get_adjustment(GTK_RANGE(listview->scroll));
+	const guint items = list_data != NULL? gydp_list_data_get_items(list_data): 0;
+
+	/* update scroll range */
+	g_object_set(G_OBJECT(adjustment), "upper", (gdouble)items, NULL);
+
+	/* update the list and list selection */
+	gydp_list_view_update(listview);
+	gydp_list_view_update_select(listview);
+}
+
 static void gydp_list_view_scroll_value_changed(GtkRange G_GNUC_UNUSED *range, gpointer data) {
 	GydpListView *listview = GYDP_LIST_VIEW(data);
 
@@ -357,12 +414,13 @@ static void gydp_list_view_select(GydpListView *self, gint value, gint offset) {
 	}
 }
 
+/** gydp_list_view_update
+ * move visible rows to scroll position, rows which stay visible are kept
+ * (with selection) and only items of newly exposed rows are read
+ */
 static void gydp_list_view_update(GydpListView *self) {
-	GtkTreeModel *store = gtk_tree_view_get_model(GTK_TREE_VIEW(self->list));
-	GtkTreeIter it;
+	GydpListModel *model = GYDP_LIST_MODEL(gtk_tree_view_get_model(GTK_TREE_VIEW(self->list)));
 	gdouble position;
-	gint cell_height, separator, id;
-	const gchar *word;
 
 	/* get scroll for word list */
 	GtkAdjustment *adjustment = gtk_range_get_adjustment(GTK_RANGE(self->scroll));
@@ -370,37 +428,22 @@ static void gydp_list_view_update(GydpListView *self) {
 	/* top items on word list */
 	g_object_get(G_OBJECT(adjustment), "value", &position, NULL);
 
-	/* get single cell size */
-	GtkTreeViewColumn *column = gtk_tree_view_get_column(GTK_TREE_VIEW(self->list), 0);
-	gtk_tree_view_column_cell_get_size(column, NULL, NULL, NULL, NULL, &cell_height);
-	gtk_widget_style_get(self->list, "vertical-separator", &separator, NULL);
-	cell_height += separator;
-
-	/* clear store */
-	gtk_list_store_clear(GTK_LIST_STORE(store));
+	/* get single cell size (kept until style changes) */
+	if( self->cell_height <= 0 ) {
+		GtkTreeViewColumn *column = gtk_tree_view_get_column(GTK_TREE_VIEW(self->list), 0);
+		gint cell_height, separator;
 
-	/* NOTICE:
-	 * setting store explicitly sends selection-changed signal */
+		gtk_tree_view_column_cell_get_size(column, NULL, NULL, NULL, NULL, &cell_height);
+		gtk_widget_style_get(self->list, "vertical-separator", &separator, NULL);
 
-	const gint size = self->list->allocation.height / cell_height;
-	for(gint i = 0; i < size; ++i) {
-
-		/* get id */
-		id = i + (gint)position;
-
-		/* extract item associated with id */
-		word = gydp_list_data_get_item(self->data, id);
-		g_warn_if_fail( word != NULL );
-
-		/* add only available words */
-		if( word != NULL ) {
-			gtk_list_store_append(GTK_LIST_STORE(store), &it);
-			gtk_list_store_set(GTK_LIST_STORE(store), &it,
-					COLUMN_WORD, word,
-					COLUMN_ID, id, -1);
-		}
+		/* not measured before widget is realized */
+		if( cell_height > 0 )
+			self->cell_height = cell_height + separator;
 	}
 
+	const gint size = self->cell_height > 0? self->list->allocation.height / self->cell_height: 0;
+	gydp_list_model_set_range(model, (guint)position, (guint)size);
+
 	/* adjust scroll (rounding is important) */
 	g_object_set(G_OBJECT(adjustment),
 			"page-size", (gdouble)(gint)size,
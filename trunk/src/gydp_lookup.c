@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2008 Michał Kurgan <michal.kurgan@moloh.net>
+ *
+ * This file is part of gydpdict.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gydpdict.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "gydp_lookup.h"
+#include "gydp_dict.h"
+#include "gydp_util.h"
+#include "gydp_conf.h"
+#include "gydp_app.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/* private functions */
+static gboolean    gydp_lookup_word (GydpDict *dict, const gchar *word, GydpText *text);
+static gboolean    gydp_lookup_input(GydpDict *dict, GydpText *text);
+
+gboolean gydp_lookup_run(const gchar *engine, const gchar *lang, gchar **words) {
+	GydpConf *config = g_object_get_data(G_OBJECT(gydp_app()), GYDP_APP_CONF);
+	GydpEngine engine_value = GYDP_ENGINE_DEFAULT;
+	GEnumValue *value;
+
+	/* select engine */
+	if( engine != NULL ) {
+		if( (value = gydp_enum_value(GYDP_ENUM_ENGINE, engine)) == NULL ) {
+			g_printerr("Unknown engine '%s'.\n", engine);
+			return FALSE;
+		}
+		engine_value = value->value;
+	}
+
+	GydpDict *dict = GYDP_DICT(gydp_engine_new(engine_value));
+
+	/* select language (configured one by default) */
+	gchar *name = lang? g_strdup(lang):
+		gydp_conf_get_string(config, gydp_engine_value_to_nick(dict->engine), "lang");
+	value = gydp_enum_value(GYDP_ENUM_LANG, name);
+
+	if( value == NULL ) {
+		g_printerr("Unknown language '%s'.\n", name);
+		g_object_unref(dict);
+		g_free(name);
+		return FALSE;
+	}
+	g_free(name);
+
+	/* load dictionary in this thread (engine reports errors) */
+	gchar **paths = gydp_data_dirs(dict->engine);
+	gboolean result = gydp_dict_load(dict, paths, value->value);
+	g_strfreev(paths);
+
+	if( result ) {
+		GydpText *text = gydp_text_new();
+
+		if( words != NULL && *words != NULL ) {
+			for(; *words != NULL; ++words)
+				result = gydp_lookup_word(dict, *words, text) && result;
+		} else
+			result = gydp_lookup_input(dict, text);
+
+		gydp_text_free(text);
+		fflush(stdout);
+	}
+
+	g_object_unref(dict);
+
+	return result;
+}
+
+/** gydp_lookup_word
+ * print headword and definition of best compatible entry, entry has to
+ * start with word (headword is printed first, rendering may release it)
+ */
+static gboolean gydp_lookup_word(GydpDict *dict, const gchar *word, GydpText *text) {
+	const guint n = gydp_dict_find(dict, word);
+	const gchar *headword = gydp_dict_word(dict, n);
+	gboolean result = FALSE;
+
+	if( headword != NULL && *word != '\0' ) {
+		gchar *find = gydp_str_process(word);
+		gchar *key = gydp_str_process(headword);
+
+		if( g_str_has_prefix(key, find) ) {
+			fputs(headword, stdout);
+			fputc('\n', stdout);
+			result = TRUE;
+		}
+
+		g_free(key);
+		g_free(find);
+	}
+
+	if( !result ) {
+		g_printerr("No entry for '%s'.\n", word);
+		return FALSE;
+	}
+
+	/* definitions are separated by empty line */
+	if( gydp_dict_text(dict, n, text) && text->text->len ) {
+		fwrite(text->text->str, 1, text->text->len, stdout);
+		if( text->text->str[text->text->len - 1] != '\n' )
+			fputc('\n', stdout);
+	}
+	fputc('\n', stdout);
+
+	return TRUE;
+}
+
+/** gydp_lookup_input
+ * look up every non empty line of standard input, lines are read as
+ * raw bytes and invalid UTF-8 is reported instead of looked up
+ */
+static gboolean gydp_lookup_input(GydpDict *dict, GydpText *text) {
+	GString *line = g_string_new(NULL);
+	gboolean result = TRUE;
+	gchar buffer[1024];
+
+	while( fgets(buffer, sizeof(buffer), stdin) != NULL ) {
+		g_string_append(line, buffer);
+
+		/* long lines are read in parts */
+		if( line->str[line->len - 1] != '\n' && !feof(stdin) )
+			continue;
+
+		g_strstrip(line->str);
+
+		if( !g_utf8_validate(line->str, -1, NULL) ) {
+			g_printerr("Invalid UTF-8 in input line, skipped.\n");
+			result = FALSE;
+		} else if( *line->str != '\0' )
+			result = gydp_lookup_word(dict, line->str, text) && result;
+
+		g_string_truncate(line, 0);
+	}
+
+	g_string_free(line, TRUE);
+
+	return result;
+}
@@ -0,0 +1,33 @@
+/*
+ * Copyright (C) 2008 Michał Kurgan <michal.kurgan@moloh.net>
+ *
+ * This file is part of gydpdict.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gydpdict.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef __GYDP_LOOKUP_H__
+#define __GYDP_LOOKUP_H__
+
+#include "gydp_global.h"
+
+G_BEGIN_DECLS
+
+/* print definitions of words (lines of standard input if there are no
+ * words) as plain text, engine and language are given by nick or name
+ * (NULL selects configured ones), fails if any word is not found */
+gboolean gydp_lookup_run(const gchar *engine, const gchar *lang, gchar **words);
+
+G_END_DECLS
+
+#endif /* __GYDP_LOOKUP_H__ */
@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2008 Michał Kurgan <michal.kurgan@moloh.net>
+ *
+ * This file is part of gydpdict.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gydpdict.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gydp_registry.h"
+#include "gydp_util.h"
+
+typedef struct GydpRegistryEntry {
+	GydpEngine engine;
+	GydpLang lang;    /* requested language (engine sets its own when loaded) */
+	GydpDict *dict;
+} GydpRegistryEntry;
+
+struct _GydpRegistry {
+	GQueue *entries; /* resident dictionaries, recently used first */
+	gsize limit;     /* memory limit (bytes) */
+};
+
+/* private functions */
+static GList *gydp_registry_find   (GydpRegistry *self, GydpEngine engine, GydpLang lang);
+static void   gydp_registry_release(GydpRegistryEntry *entry);
+
+GydpRegistry *gydp_registry_new(gsize limit) {
+	GydpRegistry *self = g_slice_new(GydpRegistry);
+
+	self->entries = g_queue_new();
+	self->limit = limit;
+
+	return self;
+}
+
+void gydp_registry_free(GydpRegistry *self) {
+	if( self != NULL ) {
+		/* loaders of released dictionaries are stopped */
+		g_queue_foreach(self->entries, (GFunc)gydp_registry_release, NULL);
+		g_queue_free(self->entries);
+
+		g_slice_free(GydpRegistry, self);
+	}
+}
+
+GydpDict *gydp_registry_get(GydpRegistry *self, GydpEngine engine, GydpLang lang, gboolean *resident) {
+	GList *link = gydp_registry_find(self, engine, lang);
+
+	if( resident )
+		*resident = link != NULL;
+
+	/* mark as recently used */
+	if( link != NULL ) {
+		g_queue_unlink(self->entries, link);
+		g_queue_push_head_link(self->entries, link);
+		return ((GydpRegistryEntry *)link->data)->dict;
+	}
+
+	/* create empty dictionary */
+	GydpDict *dict = GYDP_DICT(gydp_engine_new(engine));
+	if( !gydp_dict_lang(dict, lang) ) {
+		g_object_unref(dict);
+		return NULL;
+	}
+
+	GydpRegistryEntry *entry = g_slice_new(GydpRegistryEntry);
+	entry->engine = engine;
+	entry->lang = lang;
+	entry->dict = dict;
+	g_queue_push_head(self->entries, entry);
+
+	/* make room for new dictionary */
+	gydp_registry_trim(self);
+
+	return dict;
+}
+
+gboolean gydp_registry_lang(GydpRegistry *self, GydpEngine engine, GydpLang lang) {
+	gboolean result;
+
+	/* any dictionary of engine can tell */
+	for(GList *link = self->entries->head; link != NULL; link = link->next) {
+		GydpRegistryEntry *entry = link->data;
+		if( entry->engine == engine )
+			return gydp_dict_lang(entry->dict, lang);
+	}
+
+	GydpDict *dict = GYDP_DICT(gydp_engine_new(engine));
+	result = gydp_dict_lang(dict, lang);
+	g_object_unref(dict);
+
+	return result;
+}
+
+void gydp_registry_remove(GydpRegistry *self, GydpDict *dict) {
+	for(GList *link = self->entries->head; link != NULL; link = link->next) {
+		GydpRegistryEntry *entry = link->data;
+		if( entry->dict == dict ) {
+			g_queue_delete_link(self->entries, link);
+			gydp_registry_release(entry);
+			return;
+		}
+	}
+}
+
+/** gydp_registry_trim
+ * memory of dictionaries is estimated when they are loaded (loading ones
+ * are not counted), least recently used are released until rest fits
+ */
+void gydp_registry_trim(GydpRegistry *self) {
+	gsize size = 0;
+
+	for(GList *link = self->entries->head; link != NULL; link = link->next) {
+		GydpRegistryEntry *entry = link->data;
+		if( !gydp_dict_loading(entry->dict) )
+			size += gydp_dict_memory(entry->dict);
+	}
+
+	while( size > self->limit && self->entries->length > 1 ) {
+		GydpRegistryEntry *entry = g_queue_pop_tail(self->entries);
+
+		if( !gydp_dict_loading(entry->dict) )
+			size -= MIN(size, gydp_dict_memory(entry->dict));
+		gydp_registry_release(entry);
+	}
+}
+
+/** gydp_registry_find
+ * there are few engine and language pairs, so dictionaries are simply
+ * compared one by one
+ */
+static GList *gydp_registry_find(GydpRegistry *self, GydpEngine engine, GydpLang lang) {
+	for(GList *link = self->entries->head; link != NULL; link = link->next) {
+		GydpRegistryEntry *entry = link->data;
+		if( entry->engine == engine && entry->lang == lang )
+			return link;
+	}
+
+	return NULL;
+}
+
+static void gydp_registry_release(GydpRegistryEntry *entry) {
+	g_object_unref(entry->dict);
+	g_slice_free(GydpRegistryEntry, entry);
+}
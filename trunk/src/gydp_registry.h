@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2008 Michał Kurgan <michal.kurgan@moloh.net>
+ *
+ * This file is part of gydpdict.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gydpdict.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GYDP_REGISTRY_H__
+#define __GYDP_REGISTRY_H__
+
+#include "gydp_global.h"
+#include "gydp_dict.h"
+
+G_BEGIN_DECLS
+
+typedef struct _GydpRegistry GydpRegistry;
+
+/* dictionaries of every engine and language kept loaded within memory
+ * limit (bytes), least recently used ones are released first */
+GydpRegistry *gydp_registry_new   (gsize limit);
+void          gydp_registry_free  (GydpRegistry *self);
+
+/* dictionary of engine and language (kept by registry), new one is empty
+ * and has to be loaded by caller unless resident (NULL if not supported) */
+GydpDict     *gydp_registry_get   (GydpRegistry *self, GydpEngine engine, GydpLang lang,
+                                   gboolean *resident);
+
+/* check if engine supports language */
+gboolean      gydp_registry_lang  (GydpRegistry *self, GydpEngine engine, GydpLang lang);
+
+/* forget dictionary (failed load is repeated with next get) */
+void          gydp_registry_remove(GydpRegistry *self, GydpDict *dict);
+
+/* release least recently used dictionaries over limit (last used one is kept) */
+void          gydp_registry_trim  (GydpRegistry *self);
+
+G_END_DECLS
+
+#endif /* __GYDP_REGISTRY_H__ */
@@ -0,0 +1,981 @@
+/*
+ * Copyright (C) 2008 Michał Kurgan <michal.kurgan@moloh.net>
+ *
+ * This file is part of gydpdict.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gydpdict.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* sockets and signals are POSIX, not part of C99 */
+#define _POSIX_C_SOURCE 200112L
+
+#include "gydp_serve.h"
+#include "gydp_dict.h"
+#include "gydp_util.h"
+#include "gydp_conf.h"
+#include "gydp_app.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+/* command line limit of RFC 2229 and answer limits of single database */
+#define GYDP_SERVE_LINE    1024
+#define GYDP_SERVE_READ    4096
+#define GYDP_SERVE_DEFINES 32
+#define GYDP_SERVE_MATCHES 256
+
+typedef enum {
+	GYDP_SERVE_EXACT,
+	GYDP_SERVE_PREFIX,
+	GYDP_SERVE_LEV,
+	GYDP_SERVE_STRATEGIES
+} GydpServeStrategy;
+
+typedef struct {
+	gchar    *name;         /* database name (engine and languages) */
+	gchar    *description;
+	GydpDict *dict;
+	GMutex   *lock;         /* dictionaries are not thread safe */
+} GydpServeBase;
+
+typedef struct {
+	GPtrArray *bases;
+	GMutex    *lock;        /* guards clients and returned */
+	GSList    *clients;     /* connected clients */
+	GSList    *returned;    /* clients answered by workers */
+	gint       timeout;     /* idle clients timeout (seconds) */
+	guint      serial;      /* connections accepted */
+} GydpServe;
+
+/* clients wait in main loop and are handed to worker only when they
+ * send data, worker answers complete commands and returns them */
+typedef struct {
+	gint       fd;
+	guint      serial;
+	gboolean   open;        /* FALSE when client quits or is disconnected */
+	gboolean   discard;     /* rest of overlong line is skipped */
+	time_t     active;      /* last command (idle clients expire) */
+	GString   *in;          /* incomplete command line */
+	GString   *out;         /* answer, sent after every command */
+	GydpText  *text;
+} GydpServeClient;
+
+static const struct {
+	const gchar *name;
+	const gchar *description;
+} gydp_serve_strategies[GYDP_SERVE_STRATEGIES] = {
+	{ "exact",  "Match headwords exactly" },
+	{ "prefix", "Match prefixes" },
+	{ "lev",    "Match headwords within Levenshtein distance" },
+};
+
+/* set by signal handler, stops accepting clients */
+static volatile sig_atomic_t gydp_serve_signal = 0;
+
+/* wakes main loop, written by signal handler and by workers */
+static gint gydp_serve_pipe[2] = { -1, -1 };
+
+/* private functions */
+static void        gydp_serve_load     (GydpServe *self, GydpEngine engine, GydpLang lang);
+static gint        gydp_serve_listen   (const gchar *location, gchar **path);
+static gboolean    gydp_serve_pipe_open(void);
+static void        gydp_serve_wake     (void);
+static void        gydp_serve_interrupt(int signum);
+static GydpServeClient *gydp_serve_accept(GydpServe *self, gint fd);
+static void        gydp_serve_close    (GydpServe *self, GydpServeClient *client);
+static void        gydp_serve_client   (gpointer data, gpointer user_data);
+static gboolean    gydp_serve_input    (GydpServe *self, GydpServeClient *client,
+                                        const gchar *data, gsize length);
+static gboolean    gydp_serve_line     (GydpServe *self, GydpServeClient *client,
+                                        gchar *line, gsize length);
+static gboolean    gydp_serve_flush    (GydpServeClient *client);
+static gchar     **gydp_serve_split    (const gchar *line);
+static gboolean    gydp_serve_command  (GydpServe *self, GydpServeClient *client, gchar **argv);
+static void        gydp_serve_define   (GydpServe *self, GydpServeClient *client,
+                                        const gchar *database, const gchar *word);
+static void        gydp_serve_match    (GydpServe *self, GydpServeClient *client,
+                                        const gchar *database, const gchar *strategy, const gchar *word);
+static void        gydp_serve_show     (GydpServe *self, GydpServeClient *client, gchar **argv);
+static guint       gydp_serve_entries  (GydpServeBase *base, GydpServeStrategy strategy,
+                                        const gchar *word, GArray *entries);
+static gint        gydp_serve_compare  (gconstpointer a, gconstpointer b);
+static void        gydp_serve_quote    (GString *out, const gchar *str);
+static void        gydp_serve_text     (GString *out, const GString *text);
+
+gboolean gydp_serve_run(const gchar *engine, const gchar *location) {
+	GydpConf *config = g_object_get_data(G_OBJECT(gydp_app()), GYDP_APP_CONF);
+	GydpEngine engines[] = { GYDP_ENGINE_SAP, GYDP_ENGINE_YDP };
+	gsize count = G_N_ELEMENTS(engines);
+	GError *error = NULL;
+
+	/* select engine (merged one duplicates SAP and YDP, so not default) */
+	if( engine != NULL ) {
+		GEnumValue *value = gydp_enum_value(GYDP_ENUM_ENGINE, engine);
+
+		if( value == NULL ) {
+			g_printerr("Unknown engine '%s'.\n", engine);
+			return FALSE;
+		}
+		engines[0] = value->value;
+		count = 1;
+	}
+
+	GydpServe serve = { g_ptr_array_new(), g_mutex_new(), NULL, NULL, 0, 0 };
+	serve.timeout = gydp_conf_get_integer(config, "serve", "timeout");
+
+	/* every language is loaded before clients are accepted */
+	for(gsize i = 0; i < count; ++i) {
+		gydp_serve_load(&serve, engines[i], GYDP_LANG_ENG_TO_POL);
+		gydp_serve_load(&serve, engines[i], GYDP_LANG_ENG_FROM_POL);
+	}
+
+	gchar *path = NULL;
+	gint fd = -1;
+	GThreadPool *pool = NULL;
+
+	if( serve.bases->len == 0 )
+		g_printerr("No dictionary loaded.\n");
+	else if( (fd = gydp_serve_listen(location, &path)) >= 0 && !gydp_serve_pipe_open() ) {
+		g_printerr("Unable to create pipe: %s.\n", g_strerror(errno));
+	} else if( fd >= 0 ) {
+		const gint workers = gydp_conf_get_integer(config, "serve", "workers");
+		sigset_t signals, mask;
+
+		/* workers are started at once with signals blocked, so signals
+		 * interrupt poll of main thread */
+		sigemptyset(&signals);
+		sigaddset(&signals, SIGINT);
+		sigaddset(&signals, SIGTERM);
+		pthread_sigmask(SIG_BLOCK, &signals, &mask);
+		pool = g_thread_pool_new(gydp_serve_client, &serve, MAX(workers, 1), TRUE, &error);
+		pthread_sigmask(SIG_SETMASK, &mask, NULL);
+
+		if( pool == NULL ) {
+			g_printerr("Unable to start workers: %s.\n", error->message);
+			g_error_free(error);
+		}
+	}
+
+	if( pool != NULL ) {
+		struct sigaction action;
+
+		memset(&action, 0, sizeof(action));
+		sigemptyset(&action.sa_mask);
+		action.sa_handler = gydp_serve_interrupt;
+		sigaction(SIGINT, &action, NULL);
+		sigaction(SIGTERM, &action, NULL);
+
+		/* disconnected clients are reported by write errors */
+		action.sa_handler = SIG_IGN;
+		sigaction(SIGPIPE, &action, NULL);
+
+		g_print("Serving %u databases on %s.\n", serve.bases->len,
+				path? path: location? location: G_STRINGIFY(GYDP_SERVE_PORT));
+
+		/* idle clients are polled by main thread, workers are busy only
+		 * while commands are answered (signal wakes poll through pipe,
+		 * so it is not lost before poll is entered) */
+		GPtrArray *idle = g_ptr_array_new();
+		GArray *fds = g_array_new(FALSE, TRUE, sizeof(struct pollfd));
+
+		while( !gydp_serve_signal ) {
+			struct pollfd *poll_fds;
+			time_t now = time(NULL);
+			gint wait = -1;
+
+			g_array_set_size(fds, 2 + idle->len);
+			poll_fds = (struct pollfd *)fds->data;
+			poll_fds[0].fd = fd;
+			poll_fds[1].fd = gydp_serve_pipe[0];
+			for(guint i = 0; i < idle->len; ++i) {
+				GydpServeClient *client = g_ptr_array_index(idle, i);
+
+				poll_fds[2 + i].fd = client->fd;
+				if( serve.timeout > 0 ) {
+					const glong left = CLAMP(client->active + serve.timeout - now, 0, G_MAXINT / 1000);
+
+					if( wait < 0 || left * 1000 < wait )
+						wait = left * 1000;
+				}
+			}
+			for(guint i = 0; i < fds->len; ++i) {
+				poll_fds[i].events = POLLIN;
+				poll_fds[i].revents = 0;
+			}
+
+			if( poll(poll_fds, fds->len, wait) < 0 ) {
+				if( errno == EINTR )
+					continue;
+				g_printerr("Unable to wait for clients: %s.\n", g_strerror(errno));
+				break;
+			}
+
+			/* wakeups of signals and workers */
+			if( poll_fds[1].revents != 0 ) {
+				gchar drain[64];
+
+				while( read(gydp_serve_pipe[0], drain, sizeof(drain)) > 0 );
+			}
+
+			/* clients with data are answered by workers, idle ones expire
+			 * (removed client is replaced by last one, already checked) */
+			now = time(NULL);
+			for(guint i = idle->len; i-- > 0; ) {
+				GydpServeClient *client = g_ptr_array_index(idle, i);
+
+				if( poll_fds[2 + i].revents != 0 ) {
+					g_ptr_array_remove_index_fast(idle, i);
+					g_thread_pool_push(pool, client, NULL);
+				} else if( serve.timeout > 0 && now - client->active >= serve.timeout ) {
+					g_ptr_array_remove_index_fast(idle, i);
+					gydp_serve_close(&serve, client);
+				}
+			}
+
+			/* answered clients wait for next command */
+			g_mutex_lock(serve.lock);
+			GSList *returned = serve.returned;
+			serve.returned = NULL;
+			g_mutex_unlock(serve.lock);
+
+			for(GSList *i = returned; i != NULL; i = i->next) {
+				GydpServeClient *client = i->data;
+
+				if( client->open ) {
+					client->active = now;
+					g_ptr_array_add(idle, client);
+				} else
+					gydp_serve_close(&serve, client);
+			}
+			g_slist_free(returned);
+
+			/* new client waits for first command */
+			if( poll_fds[0].revents != 0 ) {
+				GydpServeClient *client = gydp_serve_accept(&serve, fd);
+
+				if( client != NULL )
+					g_ptr_array_add(idle, client);
+			}
+		}
+
+		/* connected clients are disconnected, busy ones are returned by workers */
+		g_mutex_lock(serve.lock);
+		for(GSList *i = serve.clients; i != NULL; i = i->next)
+			shutdown(((GydpServeClient *)i->data)->fd, SHUT_RDWR);
+		g_mutex_unlock(serve.lock);
+
+		g_thread_pool_free(pool, FALSE, TRUE);
+
+		while( serve.clients != NULL )
+			gydp_serve_close(&serve, serve.clients->data);
+		g_slist_free(serve.returned);
+		g_ptr_array_free(idle, TRUE);
+		g_array_free(fds, TRUE);
+	}
+
+	/* release socket and dictionaries */
+	if( fd >= 0 )
+		close(fd);
+	for(guint i = 0; i < G_N_ELEMENTS(gydp_serve_pipe); ++i) {
+		if( gydp_serve_pipe[i] >= 0 )
+			close(gydp_serve_pipe[i]);
+		gydp_serve_pipe[i] = -1;
+	}
+	if( path != NULL )
+		unlink(path);
+	g_free(path);
+
+	for(guint i = 0; i < serve.bases->len; ++i) {
+		GydpServeBase *base = g_ptr_array_index(serve.bases, i);
+
+		g_object_unref(base->dict);
+		g_mutex_free(base->lock);
+		g_free(base->description);
+		g_free(base->name);
+		g_free(base);
+	}
+	g_ptr_array_free(serve.bases, TRUE);
+	g_mutex_free(serve.lock);
+
+	/* interrupted server finishes successfully */
+	return pool != NULL && gydp_serve_signal != 0;
+}
+
+/** gydp_serve_load
+ * load language of engine as database named after engine nick and
+ * languages (e.g. sap-en-pl), unsupported languages are skipped
+ */
+static void gydp_serve_load(GydpServe *self, GydpEngine engine, GydpLang lang) {
+	GydpDict *dict = GYDP_DICT(gydp_engine_new(engine));
+
+	if( !gydp_dict_lang(dict, lang) ) {
+		g_object_unref(dict);
+		return;
+	}
+
+	/* load dictionary in this thread (engine reports errors) */
+	gchar **paths = gydp_data_dirs(dict->engine);
+	const gboolean result = gydp_dict_load(dict, paths, lang);
+	g_strfreev(paths);
+
+	if( !result ) {
+		g_object_unref(dict);
+		return;
+	}
+
+	const gchar *nick = gydp_engine_value_to_nick(dict->engine);
+	gchar *label = g_ascii_strup(nick, -1);
+	GydpServeBase *base = g_new(GydpServeBase, 1);
+
+	base->name = g_strdup_printf("%s-%s", nick, lang == GYDP_LANG_ENG_TO_POL? "en-pl": "pl-en");
+	base->description = g_strdup_printf("%s %s", label, gydp_lang_value_to_nick(lang));
+	base->dict = dict;
+	base->lock = g_mutex_new();
+	g_ptr_array_add(self->bases, base);
+
+	g_free(label);
+}
+
+/** gydp_serve_listen
+ * listening socket of Unix socket path or loopback port, socket left by
+ * previous server is replaced (path is set to socket removed at exit)
+ */
+static gint gydp_serve_listen(const gchar *location, gchar **path) {
+	union {
+		struct sockaddr    any;
+		struct sockaddr_un local;
+		struct sockaddr_in inet;
+	} address;
+	socklen_t length;
+	struct stat info;
+
+	memset(&address, 0, sizeof(address));
+
+	if( location != NULL && strchr(location, '/') != NULL ) {
+		if( strlen(location) >= sizeof(address.local.sun_path) ) {
+			g_printerr("Socket path '%s' is too long.\n", location);
+			return -1;
+		}
+		address.local.sun_family = AF_UNIX;
+		strcpy(address.local.sun_path, location);
+		length = sizeof(address.local);
+
+		if( stat(location, &info) == 0 && S_ISSOCK(info.st_mode) )
+			unlink(location);
+	} else {
+		glong port = GYDP_SERVE_PORT;
+
+		if( location != NULL ) {
+			gchar *end = NULL;
+
+			port = strtol(location, &end, 10);
+			if( *location == '\0' || *end != '\0' || port <= 0 || port > 65535 ) {
+				g_printerr("Invalid port '%s'.\n", location);
+				return -1;
+			}
+		}
+
+		/* lookups are not authenticated, only local clients are served */
+		address.inet.sin_family = AF_INET;
+		address.inet.sin_port = htons(port);
+		address.inet.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		length = sizeof(address.inet);
+	}
+
+	const gint fd = socket(address.any.sa_family, SOCK_STREAM, 0);
+
+	if( fd >= 0 && address.any.sa_family == AF_INET ) {
+		const int reuse = 1;
+		setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+	}
+
+	if( fd < 0 || bind(fd, &address.any, length) != 0 || listen(fd, SOMAXCONN) != 0 ) {
+		g_printerr("Unable to listen on '%s': %s.\n",
+				location? location: G_STRINGIFY(GYDP_SERVE_PORT), g_strerror(errno));
+		if( fd >= 0 )
+			close(fd);
+		return -1;
+	}
+
+	/* readiness is polled, accept must not block if client is gone */
+	fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+	if( address.any.sa_family == AF_UNIX )
+		*path = g_strdup(location);
+
+	return fd;
+}
+
+/** gydp_serve_pipe_open
+ * pipe waking main loop, both ends are non-blocking (full pipe already
+ * wakes main loop and signal handler must not block)
+ */
+static gboolean gydp_serve_pipe_open() {
+	if( pipe(gydp_serve_pipe) != 0 )
+		return FALSE;
+
+	for(guint i = 0; i < G_N_ELEMENTS(gydp_serve_pipe); ++i)
+		fcntl(gydp_serve_pipe[i], F_SETFL, fcntl(gydp_serve_pipe[i], F_GETFL) | O_NONBLOCK);
+
+	return TRUE;
+}
+
+static void gydp_serve_wake() {
+	while( write(gydp_serve_pipe[1], "", 1) < 0 && errno == EINTR );
+}
+
+static void gydp_serve_interrupt(int signum) {
+	const gint error = errno;
+
+	gydp_serve_signal = signum;
+	gydp_serve_wake();
+	errno = error;
+}
+
+/** gydp_serve_accept
+ * accept waiting client and greet it (listening socket is non-blocking,
+ * so client gone before accept does not block main loop)
+ */
+static GydpServeClient *gydp_serve_accept(GydpServe *self, gint fd) {
+	const gint connection = accept(fd, NULL, NULL);
+
+	if( connection < 0 ) {
+		if( errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK && errno != ECONNABORTED )
+			g_printerr("Unable to accept client: %s.\n", g_strerror(errno));
+		return NULL;
+	}
+
+	/* answers are written blocking, clients not reading them release
+	 * their workers after timeout */
+	fcntl(connection, F_SETFL, fcntl(connection, F_GETFL) & ~O_NONBLOCK);
+	if( self->timeout > 0 ) {
+		struct timeval timeout = { self->timeout, 0 };
+		setsockopt(connection, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+	}
+
+	GydpServeClient *client = g_new0(GydpServeClient, 1);
+	client->fd = connection;
+	client->serial = ++self->serial;
+	client->active = time(NULL);
+	client->in = g_string_new(NULL);
+	client->out = g_string_new(NULL);
+	client->text = gydp_text_new();
+
+	g_mutex_lock(self->lock);
+	self->clients = g_slist_prepend(self->clients, client);
+	g_mutex_unlock(self->lock);
+
+	g_string_printf(client->out, "220 %s gydpdict %s <> <%u.%d@%s>\r\n",
+			g_get_host_name(), GYDP_VERSION, client->serial, (gint)getpid(), g_get_host_name());
+	client->open = gydp_serve_flush(client);
+
+	if( !client->open ) {
+		gydp_serve_close(self, client);
+		return NULL;
+	}
+
+	return client;
+}
+
+static void gydp_serve_close(GydpServe *self, GydpServeClient *client) {
+	g_mutex_lock(self->lock);
+	self->clients = g_slist_remove(self->clients, client);
+	g_mutex_unlock(self->lock);
+
+	close(client->fd);
+	gydp_text_free(client->text);
+	g_string_free(client->out, TRUE);
+	g_string_free(client->in, TRUE);
+	g_free(client);
+}
+
+/** gydp_serve_client
+ * worker of thread pool, answers commands sent by client (which has
+ * data waiting) and returns client to main loop
+ */
+static void gydp_serve_client(gpointer data, gpointer user_data) {
+	GydpServeClient *client = data;
+	GydpServe *self = user_data;
+	gchar buffer[GYDP_SERVE_READ];
+	ssize_t length;
+
+	do
+		length = read(client->fd, buffer, sizeof(buffer));
+	while( length < 0 && errno == EINTR );
+
+	client->open = length > 0 && gydp_serve_input(self, client, buffer, length);
+
+	g_mutex_lock(self->lock);
+	self->returned = g_slist_prepend(self->returned, client);
+	g_mutex_unlock(self->lock);
+	gydp_serve_wake();
+}
+
+/** gydp_serve_input
+ * append data to command line of client and answer complete lines,
+ * overlong lines are rejected once and skipped up to their end (FALSE
+ * when client quits or is disconnected)
+ */
+static gboolean gydp_serve_input(GydpServe *self, GydpServeClient *client,
+                                 const gchar *data, gsize length) {
+	const gchar *end = data + length;
+	gboolean open = TRUE;
+
+	while( open && data < end ) {
+		const gchar *next = memchr(data, '\n', end - data);
+		const gsize size = (next? next: end) - data;
+
+		if( !client->discard )
+			g_string_append_len(client->in, data, size);
+		data += size;
+
+		if( next != NULL ) {
+			if( !client->discard )
+				open = gydp_serve_line(self, client, client->in->str, client->in->len);
+			client->discard = FALSE;
+			g_string_truncate(client->in, 0);
+			++data;
+		} else if( client->in->len > GYDP_SERVE_LINE ) {
+			g_string_append(client->out, "500 line too long\r\n");
+			client->discard = TRUE;
+			g_string_truncate(client->in, 0);
+		}
+
+		open = gydp_serve_flush(client) && open;
+	}
+
+	return open;
+}
+
+/** gydp_serve_line
+ * answer command line (without line feed, terminated at length), lines
+ * containing NUL are rejected as they can not be split (FALSE when
+ * client quits)
+ */
+static gboolean gydp_serve_line(GydpServe *self, GydpServeClient *client,
+                                gchar *line, gsize length) {
+	gboolean open = TRUE;
+
+	if( length > GYDP_SERVE_LINE ) {
+		g_string_append(client->out, "500 line too long\r\n");
+	} else if( memchr(line, '\0', length) != NULL ) {
+		g_string_append(client->out, "500 invalid character in command\r\n");
+	} else if( !g_utf8_validate(line, length, NULL) ) {
+		g_string_append(client->out, "500 invalid UTF-8\r\n");
+	} else {
+		gchar **argv = gydp_serve_split(g_strchomp(line));
+
+		/* empty lines are ignored */
+		if( *argv != NULL )
+			open = gydp_serve_command(self, client, argv);
+		g_strfreev(argv);
+	}
+
+	return open;
+}
+
+static gboolean gydp_serve_flush(GydpServeClient *client) {
+	const gchar *pos = client->out->str;
+	gsize left = client->out->len;
+
+	while( left > 0 ) {
+		const ssize_t sent = write(client->fd, pos, left);
+
+		if( sent < 0 ) {
+			if( errno == EINTR )
+				continue;
+			break;
+		}
+		pos += sent;
+		left -= sent;
+	}
+
+	g_string_truncate(client->out, 0);
+
+	return left == 0;
+}
+
+/** gydp_serve_split
+ * split command into words, words are separated by spaces and may be
+ * quoted with single or double quotes (backslash escapes next character)
+ */
+static gchar **gydp_serve_split(const gchar *line) {
+	GPtrArray *words = g_ptr_array_new();
+	GString *word = g_string_new(NULL);
+
+	for(;;) {
+		gchar quote = '\0';
+
+		while( *line == ' ' || *line == '\t' )
+			++line;
+		if( *line == '\0' )
+			break;
+
+		for(g_string_truncate(word, 0); *line != '\0'; ++line) {
+			if( *line == '\\' && line[1] != '\0' )
+				g_string_append_c(word, *++line);
+			else if( quote != '\0' && *line == quote )
+				quote = '\0';
+			else if( quote == '\0' && (*line == '"' || *line == '\'') )
+				quote = *line;
+			else if( quote == '\0' && (*line == ' ' || *line == '\t') )
+				break;
+			else
+				g_string_append_c(word, *line);
+		}
+
+		g_ptr_array_add(words, g_strdup(word->str));
+	}
+
+	g_string_free(word, TRUE);
+	g_ptr_array_add(words, NULL);
+
+	return (gchar **)g_ptr_array_free(words, FALSE);
+}
+
+/** gydp_serve_command
+ * answer single command, commands and their parameters are checked as
+ * in RFC 2229 (FALSE when client quits)
+ */
+static gboolean gydp_serve_command(GydpServe *self, GydpServeClient *client, gchar **argv) {
+	const guint argc = g_strv_length(argv);
+	const gchar *command = argv[0];
+
+	if( g_ascii_strcasecmp(command, "define") == 0 ) {
+		if( argc == 3 )
+			gydp_serve_define(self, client, argv[1], argv[2]);
+		else
+			g_string_append(client->out, "501 syntax error, illegal parameters\r\n");
+	} else if( g_ascii_strcasecmp(command, "match") == 0 ) {
+		if( argc == 4 )
+			gydp_serve_match(self, client, argv[1], argv[2], argv[3]);
+		else
+			g_string_append(client->out, "501 syntax error, illegal parameters\r\n");
+	} else if( g_ascii_strcasecmp(command, "show") == 0 ) {
+		gydp_serve_show(self, client, argv);
+	} else if( g_ascii_strcasecmp(command, "client") == 0 ) {
+		g_string_append(client->out, "250 ok\r\n");
+	} else if( g_ascii_strcasecmp(command, "status") == 0 ) {
+		g_mutex_lock(self->lock);
+		g_string_append_printf(client->out, "210 status databases=%u clients=%u\r\n",
+				self->bases->len, g_slist_length(self->clients));
+		g_mutex_unlock(self->lock);
+	} else if( g_ascii_strcasecmp(command, "help") == 0 ) {
+		g_string_append(client->out,
+				"113 help text follows\r\n"
+				"DEFINE database word         -- look up word in database\r\n"
+				"MATCH database strategy word -- match word in database using strategy\r\n"
+				"SHOW DB                      -- list all accessible databases\r\n"
+				"SHOW STRAT                   -- list available matching strategies\r\n"
+				"SHOW INFO database           -- provide information about database\r\n"
+				"SHOW SERVER                  -- provide site-specific information\r\n"
+				"CLIENT info                  -- identify client to server\r\n"
+				"STATUS                       -- display timing information\r\n"
+				"HELP                         -- display this help information\r\n"
+				"QUIT                         -- terminate connection\r\n"
+				".\r\n"
+				"250 ok\r\n");
+	} else if( g_ascii_strcasecmp(command, "quit") == 0 ) {
+		g_string_append(client->out, "221 bye\r\n");
+		return FALSE;
+	} else
+		g_string_append(client->out, "500 unknown command\r\n");
+
+	return TRUE;
+}
+
+/** gydp_serve_define
+ * definitions of entries equal to word, "*" searches all databases and
+ * "!" stops at first database with definitions
+ */
+static void gydp_serve_define(GydpServe *self, GydpServeClient *client,
+                              const gchar *database, const gchar *word) {
+	const gboolean first = strcmp(database, "!") == 0;
+	const gboolean all = first || strcmp(database, "*") == 0;
+	GArray *entries = g_array_new(FALSE, FALSE, sizeof(guint));
+	GString *out = g_string_new(NULL);
+	gboolean known = all;
+	guint count = 0;
+
+	for(guint i = 0; i < self->bases->len; ++i) {
+		GydpServeBase *base = g_ptr_array_index(self->bases, i);
+
+		if( !all && strcmp(base->name, database) != 0 )
+			continue;
+		known = TRUE;
+
+		g_mutex_lock(base->lock);
+		gydp_serve_entries(base, GYDP_SERVE_EXACT, word, entries);
+
+		for(guint j = 0; j < entries->len && j < GYDP_SERVE_DEFINES; ++j) {
+			const guint n = g_array_index(entries, guint, j);
+
+			/* headword is quoted first, rendering may release it */
+			g_string_append(out, "151 ");
+			gydp_serve_quote(out, gydp_dict_word(base->dict, n));
+			g_string_append_printf(out, " %s ", base->name);
+			gydp_serve_quote(out, base->description);
+			g_string_append(out, "\r\n");
+
+			if( gydp_dict_text(base->dict, n, client->text) )
+				gydp_serve_text(out, client->text->text);
+			g_string_append(out, ".\r\n");
+			++count;
+		}
+		g_mutex_unlock(base->lock);
+
+		if( first && entries->len )
+			break;
+	}
+
+	if( !known )
+		g_string_append(client->out, "550 invalid database, use \"SHOW DB\" for list of databases\r\n");
+	else if( count == 0 )
+		g_string_append(client->out, "552 no match\r\n");
+	else
+		g_string_append_printf(client->out, "150 %u definitions retrieved\r\n%s250 ok\r\n", count, out->str);
+
+	g_string_free(out, TRUE);
+	g_array_free(entries, TRUE);
+}
+
+/** gydp_serve_match
+ * headwords matching word with strategy ("." selects prefix), "*" searches
+ * all databases and "!" stops at first database with matches
+ */
+static void gydp_serve_match(GydpServe *self, GydpServeClient *client,
+                             const gchar *database, const gchar *strategy, const gchar *word) {
+	const gboolean first = strcmp(database, "!") == 0;
+	const gboolean all = first || strcmp(database, "*") == 0;
+	GydpServeStrategy method = strcmp(strategy, ".") == 0? GYDP_SERVE_PREFIX: GYDP_SERVE_STRATEGIES;
+	GArray *entries = g_array_new(FALSE, FALSE, sizeof(guint));
+	GString *out = g_string_new(NULL);
+	gboolean known = all;
+	guint count = 0;
+
+	for(guint i = 0; i < GYDP_SERVE_STRATEGIES && method == GYDP_SERVE_STRATEGIES; ++i)
+		if( g_ascii_strcasecmp(strategy, gydp_serve_strategies[i].name) == 0 )
+			method = i;
+
+	for(guint i = 0; i < self->bases->len && method != GYDP_SERVE_STRATEGIES; ++i) {
+		GydpServeBase *base = g_ptr_array_index(self->bases, i);
+
+		if( !all && strcmp(base->name, database) != 0 )
+			continue;
+		known = TRUE;
+
+		g_mutex_lock(base->lock);
+		gydp_serve_entries(base, method, word, entries);
+
+		for(guint j = 0; j < entries->len; ++j) {
+			g_string_append_printf(out, "%s ", base->name);
+			gydp_serve_quote(out, gydp_dict_word(base->dict, g_array_index(entries, guint, j)));
+			g_string_append(out, "\r\n");
+		}
+		count += entries->len;
+		g_mutex_unlock(base->lock);
+
+		if( first && entries->len )
+			break;
+	}
+
+	if( method == GYDP_SERVE_STRATEGIES )
+		g_string_append(client->out, "551 invalid strategy, use \"SHOW STRAT\" for a list of strategies\r\n");
+	else if( !known )
+		g_string_append(client->out, "550 invalid database, use \"SHOW DB\" for list of databases\r\n");
+	else if( count == 0 )
+		g_string_append(client->out, "552 no match\r\n");
+	else
+		g_string_append_printf(client->out, "152 %u matches found\r\n%s.\r\n250 ok\r\n", count, out->str);
+
+	g_string_free(out, TRUE);
+	g_array_free(entries, TRUE);
+}
+
+static void gydp_serve_show(GydpServe *self, GydpServeClient *client, gchar **argv) {
+	const guint argc = g_strv_length(argv);
+	GString *out = client->out;
+
+	if( argc == 2 && (g_ascii_strcasecmp(argv[1], "db") == 0 ||
+				g_ascii_strcasecmp(argv[1], "databases") == 0) ) {
+		g_string_append_printf(out, "110 %u databases present\r\n", self->bases->len);
+		for(guint i = 0; i < self->bases->len; ++i) {
+			GydpServeBase *base = g_ptr_array_index(self->bases, i);
+
+			g_string_append_printf(out, "%s ", base->name);
+			gydp_serve_quote(out, base->description);
+			g_string_append(out, "\r\n");
+		}
+		g_string_append(out, ".\r\n250 ok\r\n");
+	} else if( argc == 2 && (g_ascii_strcasecmp(argv[1], "strat") == 0 ||
+				g_ascii_strcasecmp(argv[1], "strategies") == 0) ) {
+		g_string_append_printf(out, "111 %u strategies available\r\n", GYDP_SERVE_STRATEGIES);
+		for(guint i = 0; i < GYDP_SERVE_STRATEGIES; ++i) {
+			g_string_append_printf(out, "%s ", gydp_serve_strategies[i].name);
+			gydp_serve_quote(out, gydp_serve_strategies[i].description);
+			g_string_append(out, "\r\n");
+		}
+		g_string_append(out, ".\r\n250 ok\r\n");
+	} else if( argc == 3 && g_ascii_strcasecmp(argv[1], "info") == 0 ) {
+		GydpServeBase *base = NULL;
+
+		for(guint i = 0; i < self->bases->len && base == NULL; ++i)
+			if( strcmp(((GydpServeBase *)g_ptr_array_index(self->bases, i))->name, argv[2]) == 0 )
+				base = g_ptr_array_index(self->bases, i);
+
+		if( base == NULL ) {
+			g_string_append(out, "550 invalid database, use \"SHOW DB\" for list of databases\r\n");
+			return;
+		}
+
+		/* loaded dictionaries are not modified, no lock is needed */
+		g_string_append_printf(out, "112 database information follows\r\n%s\r\nEntries: %u\r\n",
+				base->description, gydp_dict_size(base->dict));
+		for(const gchar *const *source = gydp_dict_sources(base->dict); source && *source; ++source)
+			g_string_append_printf(out, "Source: %s\r\n", *source);
+		g_string_append(out, ".\r\n250 ok\r\n");
+	} else if( argc == 2 && g_ascii_strcasecmp(argv[1], "server") == 0 ) {
+		g_string_append_printf(out, "114 server information follows\r\ngydpdict %s\r\n.\r\n250 ok\r\n",
+				GYDP_VERSION);
+	} else
+		g_string_append(out, "501 syntax error, illegal parameters\r\n");
+}
+
+/** gydp_serve_entries
+ * entries of database matching word with strategy (called with database
+ * locked), folded keys are searched by bounds (all words are scanned for
+ * engines without keys), entries are limited and duplicates are skipped
+ */
+static guint gydp_serve_entries(GydpServeBase *base, GydpServeStrategy strategy,
+                                const gchar *word, GArray *entries) {
+	gchar *find = gydp_str_process(word);
+
+	g_array_set_size(entries, 0);
+
+	if( *find == '\0' ) {
+		/* empty word matches nothing */
+	} else if( strategy == GYDP_SERVE_LEV ) {
+		GArray *hits = gydp_dict_fuzzy(base->dict, find, GYDP_DICT_FUZZY_DISTANCE, GYDP_SERVE_MATCHES);
+
+		if( hits != NULL ) {
+			g_array_append_vals(entries, hits->data, hits->len);
+			g_array_free(hits, TRUE);
+		}
+	} else {
+		GydpDictClass *klass = GYDP_DICT_GET_CLASS(base->dict);
+		GydpDictKeys *keys = klass->keys? klass->keys(base->dict): NULL;
+		/* exact match compares terminator too */
+		const gsize length = strlen(find) + (strategy == GYDP_SERVE_EXACT);
+
+		if( keys != NULL ) {
+			/* matching keys are consecutive in binary order */
+			const guint upper = gydp_dict_keys_upper_bound(keys, find, length);
+
+			for(guint i = gydp_dict_keys_lower_bound(keys, find);
+					i < upper && entries->len < GYDP_SERVE_MATCHES; ++i) {
+				const guint n = gydp_dict_keys_entry(keys, i);
+				g_array_append_val(entries, n);
+			}
+		} else {
+			/* engines without keys are not sorted by folded words */
+			const guint size = gydp_dict_size(base->dict);
+
+			for(guint n = 0; n < size && entries->len < GYDP_SERVE_MATCHES; ++n) {
+				gchar *key = gydp_str_process(gydp_dict_word(base->dict, n));
+
+				if( strncmp(key, find, length) == 0 )
+					g_array_append_val(entries, n);
+				g_free(key);
+			}
+		}
+
+		/* entries are listed in dictionary order, definitions of homographs
+		 * are all given but they are listed once */
+		g_array_sort(entries, gydp_serve_compare);
+
+		if( strategy != GYDP_SERVE_EXACT ) {
+			gchar *previous = NULL;
+			guint count = 0;
+
+			for(guint i = 0; i < entries->len; ++i) {
+				const guint n = g_array_index(entries, guint, i);
+				const gchar *headword = gydp_dict_word(base->dict, n);
+
+				if( previous == NULL || strcmp(previous, headword) != 0 ) {
+					g_array_index(entries, guint, count++) = n;
+					g_free(previous);
+					previous = g_strdup(headword);
+				}
+			}
+			g_array_set_size(entries, count);
+			g_free(previous);
+		}
+	}
+
+	g_free(find);
+
+	return entries->len;
+}
+
+static gint gydp_serve_compare(gconstpointer a, gconstpointer b) {
+	const guint x = *(const guint *)a, y = *(const guint *)b;
+
+	return x < y? -1: x > y;
+}
+
+/** gydp_serve_quote
+ * quoted string of protocol, quotes and backslashes are escaped
+ */
+static void gydp_serve_quote(GString *out, const gchar *str) {
+	g_string_append_c(out, '"');
+	for(; str != NULL && *str != '\0'; ++str) {
+		if( *str == '"' || *str == '\\' )
+			g_string_append_c(out, '\\');
+		g_string_append_c(out, *str);
+	}
+	g_string_append_c(out, '"');
+}
+
+/** gydp_serve_text
+ * definition as text lines of protocol, lines starting with dot are
+ * doubled and every line ends with CRLF
+ */
+static void gydp_serve_text(GString *out, const GString *text) {
+	const gchar *line = text->str;
+	const gchar *end = text->str + text->len;
+
+	while( line < end ) {
+		const gchar *next = memchr(line, '\n', end - line);
+		const gsize length = (next? next: end) - line;
+
+		if( *line == '.' )
+			g_string_append_c(out, '.');
+		g_string_append_len(out, line, length);
+		g_string_append(out, "\r\n");
+		line += length + 1;
+	}
+}
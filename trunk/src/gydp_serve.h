@@ -0,0 +1,36 @@
+/*
+ * Copyright (C) 2008 Michał Kurgan <michal.kurgan@moloh.net>
+ *
+ * This file is part of gydpdict.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gydpdict.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef __GYDP_SERVE_H__
+#define __GYDP_SERVE_H__
+
+#include "gydp_global.h"
+
+G_BEGIN_DECLS
+
+/* default port of DICT protocol (RFC 2229) */
+#define GYDP_SERVE_PORT 2628
+
+/* answer DICT protocol clients until interrupted, every language of engine
+ * (given by nick or name, NULL selects SAP and YDP) is kept loaded, listen
+ * is Unix socket path (contains '/') or port on loopback (NULL for default) */
+gboolean gydp_serve_run(const gchar *engine, const gchar *listen);
+
+G_END_DECLS
+
+#endif /* __GYDP_SERVE_H__ */
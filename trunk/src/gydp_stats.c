@@ -0,0 +1,210 @@
+/*
+ * Copyright (C) 2008 Michał Kurgan <michal.kurgan@moloh.net>
+ *
+ * This file is part of gydpdict.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gydpdict.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "gydp_stats.h"
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* histogram buckets, bucket n holds times of 2^n .. 2^(n+1) nanoseconds (first from zero) */
+#define GYDP_STATS_BUCKETS 40
+
+/* width of histogram bars */
+#define GYDP_STATS_BAR 40
+
+typedef struct GydpStats {
+	guint64 calls;                          /* measured operations */
+	gdouble total;                          /* sum of times (seconds) */
+	gdouble max;                            /* longest operation (seconds) */
+	guint64 histogram[GYDP_STATS_BUCKETS];  /* operations by time */
+} GydpStats;
+
+gboolean gydp_stats_enabled = FALSE;
+
+static const gchar *gydp_stats_names[GYDP_STATS_COUNT] = {
+	"dict load",
+	"dict find",
+	"dict text",
+	"convert parse",
+	"convert commit",
+	"words update",
+};
+
+static GydpStats gydp_stats[GYDP_STATS_COUNT];
+static GStaticMutex gydp_stats_mutex = G_STATIC_MUTEX_INIT;
+static GTimer *gydp_stats_timer = NULL;
+static volatile sig_atomic_t gydp_stats_pending = 0;
+
+/* private functions */
+static void     gydp_stats_signal (int number);
+static gboolean gydp_stats_poll   (gpointer data);
+static void     gydp_stats_format (gchar *buffer, gsize size, gdouble time);
+static gdouble  gydp_stats_quantile(const GydpStats *stats, gdouble quantile);
+
+/** gydp_stats_init
+ * statistics are disabled unless environment variable is set, measured
+ * operations only test gydp_stats_enabled then
+ */
+void gydp_stats_init() {
+	const gchar *env = g_getenv(GYDP_STATS_ENV);
+
+	if( gydp_stats_enabled || env == NULL || *env == '\0' || !strcmp(env, "0") )
+		return;
+
+	gydp_stats_timer = g_timer_new();
+	gydp_stats_enabled = TRUE;
+
+	/* dump at exit and on request */
+	atexit(gydp_stats_dump);
+	signal(SIGUSR1, gydp_stats_signal);
+	g_timeout_add_seconds(1, gydp_stats_poll, NULL);
+}
+
+gdouble gydp_stats_time() {
+	return g_timer_elapsed(gydp_stats_timer, NULL);
+}
+
+void gydp_stats_add(GydpStatsId id, gdouble time) {
+	GydpStats *stats = gydp_stats + id;
+	guint64 ns = time > 0.0? time * 1e9: 0;
+	guint bucket = 0;
+
+	/* find histogram bucket */
+	while( ns > 1 && bucket < GYDP_STATS_BUCKETS - 1 ) {
+		ns >>= 1;
+		++bucket;
+	}
+
+	g_static_mutex_lock(&gydp_stats_mutex);
+	stats->calls += 1;
+	stats->total += time;
+	stats->max = MAX(stats->max, time);
+	stats->histogram[bucket] += 1;
+	g_static_mutex_unlock(&gydp_stats_mutex);
+
+	/* dump requested by signal */
+	if( G_UNLIKELY(gydp_stats_pending) ) {
+		gydp_stats_pending = 0;
+		gydp_stats_dump();
+	}
+}
+
+void gydp_stats_dump() {
+	GydpStats stats[GYDP_STATS_COUNT];
+	gchar total[16], mean[16], p50[16], p90[16], p99[16], max[16];
+
+	if( !gydp_stats_enabled )
+		return;
+
+	/* copy counters, they are printed without lock */
+	g_static_mutex_lock(&gydp_stats_mutex);
+	memcpy(stats, gydp_stats, sizeof(stats));
+	g_static_mutex_unlock(&gydp_stats_mutex);
+
+	GString *out = g_string_sized_new(4096);
+	g_string_append_printf(out, "gydpdict statistics after %.1f s\n", gydp_stats_time());
+	g_string_append_printf(out, "%-16s %10s %10s %10s %10s %10s %10s %10s\n",
+			"operation", "calls", "total", "mean", "p50", "p90", "p99", "max");
+
+	/* summary of every operation (quantiles are upper bounds of buckets) */
+	for(guint i = 0; i < GYDP_STATS_COUNT; ++i) {
+		if( stats[i].calls == 0 )
+			continue;
+
+		gydp_stats_format(total, sizeof(total), stats[i].total);
+		gydp_stats_format(mean, sizeof(mean), stats[i].total / stats[i].calls);
+		gydp_stats_format(p50, sizeof(p50), gydp_stats_quantile(stats + i, 0.50));
+		gydp_stats_format(p90, sizeof(p90), gydp_stats_quantile(stats + i, 0.90));
+		gydp_stats_format(p99, sizeof(p99), gydp_stats_quantile(stats + i, 0.99));
+		gydp_stats_format(max, sizeof(max), stats[i].max);
+
+		g_string_append_printf(out, "%-16s %10" G_GUINT64_FORMAT " %10s %10s %10s %10s %10s %10s\n",
+				gydp_stats_names[i], stats[i].calls, total, mean, p50, p90, p99, max);
+	}
+
+	/* latency histograms */
+	for(guint i = 0; i < GYDP_STATS_COUNT; ++i) {
+		guint64 peak = 0;
+
+		if( stats[i].calls == 0 )
+			continue;
+
+		for(guint b = 0; b < GYDP_STATS_BUCKETS; ++b)
+			peak = MAX(peak, stats[i].histogram[b]);
+
+		g_string_append_printf(out, "\n%s\n", gydp_stats_names[i]);
+		for(guint b = 0; b < GYDP_STATS_BUCKETS; ++b) {
+			gchar low[16], high[16];
+
+			if( stats[i].histogram[b] == 0 )
+				continue;
+
+			gydp_stats_format(low, sizeof(low), b? (G_GUINT64_CONSTANT(1) << b) * 1e-9: 0.0);
+			gydp_stats_format(high, sizeof(high), (G_GUINT64_CONSTANT(1) << (b + 1)) * 1e-9);
+			g_string_append_printf(out, "  %10s .. %-10s %10" G_GUINT64_FORMAT " ",
+					low, high, stats[i].histogram[b]);
+
+			/* at least single mark for non empty bucket */
+			for(guint64 x = 0; x < MAX(1, stats[i].histogram[b] * GYDP_STATS_BAR / peak); ++x)
+				g_string_append_c(out, '#');
+			g_string_append_c(out, '\n');
+		}
+	}
+
+	g_printerr("%s", out->str);
+	g_string_free(out, TRUE);
+}
+
+static void gydp_stats_signal(int number G_GNUC_UNUSED) {
+	/* dump is done outside of handler */
+	gydp_stats_pending = 1;
+}
+
+static gboolean gydp_stats_poll(gpointer data G_GNUC_UNUSED) {
+	if( gydp_stats_pending ) {
+		gydp_stats_pending = 0;
+		gydp_stats_dump();
+	}
+
+	return TRUE;
+}
+
+static void gydp_stats_format(gchar *buffer, gsize size, gdouble time) {
+	if( time < 1e-6 )
+		g_snprintf(buffer, size, "%.0f ns", time * 1e9);
+	else if( time < 1e-3 )
+		g_snprintf(buffer, size, "%.1f us", time * 1e6);
+	else if( time < 1.0 )
+		g_snprintf(buffer, size, "%.1f ms", time * 1e3);
+	else
+		g_snprintf(buffer, size, "%.2f s", time);
+}
+
+/** gydp_stats_quantile
+ * upper bound of bucket holding quantile, limited by longest operation
+ */
+static gdouble gydp_stats_quantile(const GydpStats *stats, gdouble quantile) {
+	const guint64 rank = quantile * stats->calls;
+	guint64 count = 0;
+
+	for(guint b = 0; b < GYDP_STATS_BUCKETS; ++b)
+		if( (count += stats->histogram[b]) > rank )
+			return MIN((G_GUINT64_CONSTANT(1) << (b + 1)) * 1e-9, stats->max);
+
+	return stats->max;
+}
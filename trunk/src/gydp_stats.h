@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2008 Michał Kurgan <michal.kurgan@moloh.net>
+ *
+ * This file is part of gydpdict.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gydpdict.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GYDP_STATS_H__
+#define __GYDP_STATS_H__
+
+#include "gydp_global.h"
+
+G_BEGIN_DECLS
+
+/* environment variable enabling statistics (any value except "0") */
+#define GYDP_STATS_ENV "GYDP_STATS"
+
+/* measured operations */
+typedef enum {
+	GYDP_STATS_DICT_LOAD,      /* gydp_dict_load (engine load) */
+	GYDP_STATS_DICT_FIND,      /* gydp_dict_find */
+	GYDP_STATS_DICT_TEXT,      /* gydp_dict_text */
+	GYDP_STATS_CONVERT_PARSE,  /* conversion of definition */
+	GYDP_STATS_CONVERT_COMMIT, /* styled run committed by converter */
+	GYDP_STATS_WORDS_UPDATE,   /* word list refill */
+	GYDP_STATS_COUNT,
+} GydpStatsId;
+
+/* set once at startup, operations are measured only if set */
+extern gboolean gydp_stats_enabled;
+
+/* read environment, dump is done at exit and on SIGUSR1 */
+void     gydp_stats_init();
+
+/* print latency summary of all operations (stderr) */
+void     gydp_stats_dump();
+
+/* record operation time (any thread) */
+gdouble  gydp_stats_time();
+void     gydp_stats_add (GydpStatsId id, gdouble time);
+
+/* start of measured operation */
+static inline gdouble gydp_stats_begin() {
+	return G_UNLIKELY(gydp_stats_enabled)? gydp_stats_time(): 0.0;
+}
+
+/* end of measured operation started by gydp_stats_begin */
+static inline void gydp_stats_end(GydpStatsId id, gdouble start) {
+	if( G_UNLIKELY(gydp_stats_enabled) )
+		gydp_stats_add(id, gydp_stats_time() - start);
+}
+
+G_END_DECLS
+
+#endif /* __GYDP_STATS_H__ */
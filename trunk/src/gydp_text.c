@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2008 Michał Kurgan <michal.kurgan@moloh.net>
+ *
+ * This file is part of gydpdict.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gydpdict.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gydp_text.h"
+
+GydpText *gydp_text_new() {
+	GydpText *self = g_slice_new(GydpText);
+
+	self->text = g_string_sized_new(256);
+	self->spans = g_array_new(FALSE, FALSE, sizeof(GydpTextSpan));
+
+	return self;
+}
+
+void gydp_text_free(GydpText *self) {
+	if( self != NULL ) {
+		g_string_free(self->text, TRUE);
+		g_array_free(self->spans, TRUE);
+
+		g_slice_free(GydpText, self);
+	}
+}
+
+void gydp_text_clear(GydpText *self) {
+	g_string_truncate(self->text, 0);
+	g_array_set_size(self->spans, 0);
+}
+
+void gydp_text_copy(GydpText *self, GydpText *source) {
+	g_string_truncate(self->text, 0);
+	g_string_append_len(self->text, source->text->str, source->text->len);
+
+	g_array_set_size(self->spans, 0);
+	g_array_append_vals(self->spans, source->spans->data, source->spans->len);
+}
+
+void gydp_text_append(GydpText *self, const gchar *text, gssize len, GydpStyle style) {
+	const gsize start = self->text->len;
+
+	g_string_append_len(self->text, text, len);
+	gydp_text_style(self, start, style);
+}
+
+void gydp_text_concat(GydpText *self, GydpText *source) {
+	const gsize start = self->text->len;
+
+	g_string_append_len(self->text, source->text->str, source->text->len);
+
+	for(guint i = 0; i < source->spans->len; ++i) {
+		GydpTextSpan span = g_array_index(source->spans, GydpTextSpan, i);
+		span.start += start;
+		span.end += start;
+		g_array_append_val(self->spans, span);
+	}
+}
+
+void gydp_text_style(GydpText *self, gsize start, GydpStyle style) {
+	const gsize end = self->text->len;
+
+	/* unstyled and empty text has no span */
+	if( style == GYDP_STYLE_NONE || start >= end )
+		return;
+
+	/* extend previous span if it ends where this one starts */
+	if( self->spans->len ) {
+		GydpTextSpan *last = &g_array_index(self->spans, GydpTextSpan, self->spans->len - 1);
+
+		g_return_if_fail(last->end <= start);
+		if( last->end == start && last->style == (guint32)style ) {
+			last->end = end;
+			return;
+		}
+	}
+
+	GydpTextSpan span = { start, end, style };
+	g_array_append_val(self->spans, span);
+}
+
+gsize gydp_text_size(GydpText *self) {
+	return sizeof(GydpText) + self->text->allocated_len +
+		self->spans->len * sizeof(GydpTextSpan);
+}
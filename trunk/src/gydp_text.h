@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2008 Michał Kurgan <michal.kurgan@moloh.net>
+ *
+ * This file is part of gydpdict.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gydpdict.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GYDP_TEXT_H__
+#define __GYDP_TEXT_H__
+
+#include "gydp_global.h"
+
+G_BEGIN_DECLS
+
+typedef struct _GydpText     GydpText;
+typedef struct _GydpTextSpan GydpTextSpan;
+
+/* text style (applied by sink as tags) */
+typedef enum {
+	GYDP_STYLE_NONE          = 0,
+	GYDP_STYLE_BOLD          = 1 << 0,
+	GYDP_STYLE_ITALIC        = 1 << 1,
+	GYDP_STYLE_SCRIPT_NORMAL = 1 << 2,
+	GYDP_STYLE_SCRIPT_SUPER  = 1 << 3,
+	GYDP_STYLE_SCRIPT_SUB    = 1 << 4,
+	GYDP_STYLE_ALIGN_LEFT    = 1 << 5,
+	GYDP_STYLE_ALIGN_CENTER  = 1 << 6,
+	GYDP_STYLE_COLOR_RED     = 1 << 7,
+	GYDP_STYLE_COLOR_GREEN   = 1 << 8,
+	GYDP_STYLE_COLOR_BLUE    = 1 << 9,
+} GydpStyle;
+
+/* styled range of text (byte offsets) */
+struct _GydpTextSpan {
+	guint32 start;
+	guint32 end;
+	guint32 style;
+};
+
+/* rendered definition, plain text with ordered styled spans */
+struct _GydpText {
+	GString *text;   /* text (utf8) */
+	GArray *spans;   /* GydpTextSpan array, ordered and disjoint */
+};
+
+GydpText *gydp_text_new  ();
+void      gydp_text_free (GydpText *self);
+void      gydp_text_clear(GydpText *self);
+void      gydp_text_copy (GydpText *self, GydpText *source);
+
+/* append text with given style */
+void      gydp_text_append(GydpText *self, const gchar *text, gssize len, GydpStyle style);
+
+/* append other rendered text (spans are moved past current end) */
+void      gydp_text_concat(GydpText *self, GydpText *source);
+
+/* set style of text from start offset to current end */
+void      gydp_text_style (GydpText *self, gsize start, GydpStyle style);
+
+/* memory held by rendered text */
+gsize     gydp_text_size  (GydpText *self);
+
+G_END_DECLS
+
+#endif /* __GYDP_TEXT_H__ */
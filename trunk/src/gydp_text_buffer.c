@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2008 Michał Kurgan <michal.kurgan@moloh.net>
+ *
+ * This file is part of gydpdict.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gydpdict.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gydp_text_buffer.h"
+
+/* style to tag name mapping */
+static const struct { GydpStyle style; const gchar *tag; } gydp_text_buffer_tags[] = {
+	{ GYDP_STYLE_BOLD,          GYDP_TAG_BOLD },
+	{ GYDP_STYLE_ITALIC,        GYDP_TAG_ITALIC },
+	{ GYDP_STYLE_SCRIPT_NORMAL, GYDP_TAG_SCRIPT_NORMAL },
+	{ GYDP_STYLE_SCRIPT_SUPER,  GYDP_TAG_SCRIPT_SUPER },
+	{ GYDP_STYLE_SCRIPT_SUB,    GYDP_TAG_SCRIPT_SUB },
+	{ GYDP_STYLE_ALIGN_LEFT,    GYDP_TAG_ALIGN_LEFT },
+	{ GYDP_STYLE_ALIGN_CENTER,  GYDP_TAG_ALIGN_CENTER },
+	{ GYDP_STYLE_COLOR_RED,     GYDP_TAG_COLOR_RED },
+	{ GYDP_STYLE_COLOR_GREEN,   GYDP_TAG_COLOR_GREEN },
+	{ GYDP_STYLE_COLOR_BLUE,    GYDP_TAG_COLOR_BLUE },
+};
+
+void gydp_text_buffer_set(GtkTextBuffer *buffer, GydpText *text) {
+	GtkTextTagTable *table = gtk_text_buffer_get_tag_table(buffer);
+	GtkTextTag *tags[G_N_ELEMENTS(gydp_text_buffer_tags)];
+	GtkTextIter begin, end;
+	const gchar *str = text->text->str;
+	const gchar *valid;
+	gsize len = text->text->len;
+
+	/* invalid text is cut like in direct insert */
+	if( !g_utf8_validate(str, len, &valid) )
+		len = valid - str;
+
+	/* replace contents at once */
+	gtk_text_buffer_set_text(buffer, str, len);
+
+	/* lookup tags once */
+	for(gsize i = 0; i < G_N_ELEMENTS(gydp_text_buffer_tags); ++i)
+		tags[i] = gtk_text_tag_table_lookup(table, gydp_text_buffer_tags[i].tag);
+
+	/* apply styles, span byte offsets are converted to characters on the way */
+	glong offset = 0;
+	gsize pos = 0;
+
+	for(guint n = 0; n < text->spans->len; ++n) {
+		const GydpTextSpan *span = &g_array_index(text->spans, GydpTextSpan, n);
+
+		/* spans past valid text are dropped */
+		if( span->start >= len )
+			break;
+
+		offset += g_utf8_strlen(str + pos, span->start - pos);
+		pos = span->start;
+		gtk_text_buffer_get_iter_at_offset(buffer, &begin, offset);
+
+		offset += g_utf8_strlen(str + pos, MIN(span->end, len) - pos);
+		pos = MIN(span->end, len);
+		gtk_text_buffer_get_iter_at_offset(buffer, &end, offset);
+
+		for(gsize i = 0; i < G_N_ELEMENTS(gydp_text_buffer_tags); ++i)
+			if( (span->style & gydp_text_buffer_tags[i].style) && tags[i] != NULL )
+				gtk_text_buffer_apply_tag(buffer, tags[i], &begin, &end);
+	}
+}
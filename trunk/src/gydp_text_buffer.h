@@ -0,0 +1,34 @@
+/*
+ * Copyright (C) 2008 Michał Kurgan <michal.kurgan@moloh.net>
+ *
+ * This file is part of gydpdict.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gydpdict.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GYDP_TEXT_BUFFER_H__
+#define __GYDP_TEXT_BUFFER_H__
+
+#include "gydp_global.h"
+#include "gydp_text.h"
+#include <gtk/gtktextbuffer.h>
+
+G_BEGIN_DECLS
+
+/* replace buffer contents with rendered text (styles applied as tags) */
+void gydp_text_buffer_set(GtkTextBuffer *buffer, GydpText *text);
+
+G_END_DECLS
+
+#endif /* __GYDP_TEXT_BUFFER_H__ */
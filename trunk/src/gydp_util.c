@@ -22,6 +22,7 @@
 #include "gydp_app.h"
 #include "gydp_dict_ydp.h"
 #include "gydp_dict_sap.h"
+#include "gydp_dict_merge.h"
 
 static gchar gydp_license[] =
  " This program is free software: you can redistribute it and/or modify\n"
@@ -52,9 +53,10 @@ GObject *gydp_engine_new(GydpEngine engine) {
 
 	/* create dictionary */
 	switch( engine ) {
-	case GYDP_ENGINE_YDP: return gydp_dict_ydp_new();
-	case GYDP_ENGINE_SAP: return gydp_dict_sap_new();
-	default:              g_return_val_if_reached(NULL);
+	case GYDP_ENGINE_YDP:   return gydp_dict_ydp_new();
+	case GYDP_ENGINE_SAP:   return gydp_dict_sap_new();
+	case GYDP_ENGINE_MERGE: return gydp_dict_merge_new();
+	default:                g_return_val_if_reached(NULL);
 	}
 }
 
@@ -81,14 +83,38 @@ GInputStream *gydp_file_open(const gchar *dirname, const gchar *filename) {
 	return G_INPUT_STREAM(stream);
 }
 
+GMappedFile *gydp_file_map(const gchar *dirname, const gchar *filename) {
+	GMappedFile *file;
+	gchar *path;
+
+	/* create file path and map file */
+	path = g_build_filename(dirname, filename, NULL);
+	file = g_mapped_file_new(path, FALSE, NULL);
+
+	/* free temporary objects */
+	g_free(path);
+
+	return file;
+}
+
 gchar *gydp_config_file() {
 	/* get configuration file name */
 	const gchar *local = g_get_user_config_dir();
 	return g_build_filename(local, GYDP_FILE_RC, NULL);
 }
 
+gchar *gydp_cache_dir() {
+	/* get index cache directory */
+	const gchar *local = g_get_user_cache_dir();
+	return g_build_filename(local, GYDP_FILE_DIR, NULL);
+}
+
 gchar **gydp_data_dirs(GydpEngine engine) {
 
+	/* merged engines use their own data dirs */
+	if( engine == GYDP_ENGINE_MERGE )
+		return NULL;
+
 	/* extract global path */
 	const gchar *const *global = g_get_system_data_dirs();
 	const guint size = g_strv_length((gchar **)global);
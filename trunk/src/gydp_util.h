@@ -37,9 +37,24 @@ const gchar   *gydp_license_text();
 /* open file input stream */
 GInputStream  *gydp_file_open   (const gchar *dirname, const gchar *filename);
 
+/* map file into memory (read only) */
+GMappedFile   *gydp_file_map    (const gchar *dirname, const gchar *filename);
+
 /* provide data system dictories */
 gchar         *gydp_config_file ();
-gchar        **gydp_data_dirs   (GydpEngine engine);
+gchar         *gydp_cache_dir   ();
+gchar        **gydp_data_dirs   (GydpEngine engine);  /* NULL for merged engines */
+
+/* read little endian values from (possibly unaligned) memory */
+static inline guint16 gydp_read_uint16(const gchar *data) {
+	const guchar *byte = (const guchar *)data;
+	return byte[0] | (byte[1] << 8);
+}
+
+static inline guint32 gydp_read_uint32(const gchar *data) {
+	const guchar *byte = (const guchar *)data;
+	return byte[0] | (byte[1] << 8) | (byte[2] << 16) | ((guint32)byte[3] << 24);
+}
 
 G_END_DECLS
 
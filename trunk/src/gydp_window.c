@@ -20,18 +20,25 @@
 #include "gydp_window.h"
 #include "gydp_util.h"
 #include "gydp_dict.h"
+#include "gydp_registry.h"
+#include "gydp_list_data.h"
+#include "gydp_list_model.h"
+#include "gydp_text_buffer.h"
 #include "gydp_conf.h"
 #include "gydp_app.h"
+#include "gydp_stats.h"
 
 #include <gdk/gdkkeysyms.h>
 #include <string.h>
 
-/* list model columns */
-enum {
-	COLUMN_WORD,
-	COLUMN_ID,
-	COLUMNS
-};
+/* full-text search is started with this character in word entry */
+#define GYDP_WINDOW_TEXT_SEARCH '?'
+
+/* full-text search results kept for browsing */
+#define GYDP_WINDOW_TEXT_HITS 256
+
+/* similar words offered when no word starts with entry text */
+#define GYDP_WINDOW_FUZZY_HITS 16
 
 struct _GydpWindowClass {
 	GtkWindowClass __parent__;
@@ -63,6 +70,7 @@ struct _GydpWindow {
 
 	/* output widgets */
 	GtkWidget *definition;        /* translation text */
+	GydpText *definition_text;    /* rendered translation */
 
 	/* input widgets */
 	GtkWidget *word;              /* single word entry */
@@ -73,8 +81,14 @@ struct _GydpWindow {
 	GtkWidget *words_scroll;      /* word list scroll */
 
 	/* additional data */
+	GydpEngine engine;            /* engine of dictionary menu */
 	gint words_height;            /* current words widget height */
+	gint words_cell_height;       /* single row height (0 if not measured) */
 	gint words_selected;          /* currently selected item in words widget */
+	gboolean words_pending;       /* search is repeated while dictionary loads */
+	GCancellable *search;         /* search in progress */
+	GArray *hits;                 /* full-text or approximate search results */
+	guint hits_pos;               /* currently shown result */
 };
 
 /* parent class holder */
@@ -89,12 +103,16 @@ static void     gydp_window_finalize                  (GObject *object);
 /* callbacks */
 static void     gydp_window_hide                      (GtkWidget *widget, gpointer data);
 static void     gydp_window_dict_toggled              (GtkCheckMenuItem *item, gpointer data);
+static void     gydp_window_dict_changed              (GydpListData *list_data, gpointer data);
+static void     gydp_window_dict_loaded               (GydpDict *dict, gboolean result, gpointer data);
 static void     gydp_window_word_changed              (GtkEntry *entry, gpointer data);
+static void     gydp_window_word_found                (GydpDict *dict, guint n, gpointer data);
 static gboolean gydp_window_word_event_key_press      (GtkWidget *widget, GdkEventKey *event, gpointer data);
 static gboolean gydp_window_words_event_button_press  (GtkWidget *widget, GdkEventButton *event, gpointer data);
 static gboolean gydp_window_words_event_scroll        (GtkWidget *widget, GdkEventScroll *event, gpointer data);
 static void     gydp_window_words_selection_changed   (GtkTreeSelection *selection, gpointer data);
 static void     gydp_window_words_size_allocate       (GtkWidget *widget, GtkAllocation *allocation, gpointer data);
+static void     gydp_window_words_style_set           (GtkWidget *widget, GtkStyle *previous, gpointer data);
 static void     gydp_window_words_scroll_value_changed(GtkRange *range, gpointer data);
 
 static void     gydp_window_action_quit               (GtkAction *action, GydpWindow *window);
@@ -104,8 +122,14 @@ static void     gydp_window_action_preferences        (GtkAction *action, GydpWi
 static void     gydp_window_action_about              (GtkAction *action, GydpWindow *window);
 
 /* private functions */
-static void     gydp_window_dict_update               (GydpWindow *self, GydpLang lang);
+static void     gydp_window_dict_update               (GydpWindow *self, GydpEngine engine, GydpLang lang);
+static void     gydp_window_dict_attach               (GydpWindow *self, GydpDict *dict);
 static void     gydp_window_word_sync                 (GydpWindow *self);
+static void     gydp_window_word_search_stop          (GydpWindow *self);
+static void     gydp_window_word_search_text          (GydpWindow *self, GydpDict *dict, const gchar *query);
+static gboolean gydp_window_word_search_fuzzy         (GydpWindow *self, GydpDict *dict, guint n);
+static void     gydp_window_word_hits_clear           (GydpWindow *self);
+static void     gydp_window_definition_notice         (GydpWindow *self, const gchar *notice);
 static void     gydp_window_words_select              (GydpWindow *self, gint value, gint offset);
 static void     gydp_window_words_update              (GydpWindow *self);
 static void     gydp_window_words_update_select       (GydpWindow *self);
@@ -174,6 +198,9 @@ static void gydp_window_init(GydpWindow *self) {
 	/* set window title */
 	gtk_window_set_title(GTK_WINDOW(self), "Dictionary");
 
+	/* rendered definition storage */
+	self->definition_text = gydp_text_new();
+
 	/*
 	 * input widgets
 	 */
@@ -184,6 +211,7 @@ static void gydp_window_init(GydpWindow *self) {
 	/* word list */
 	self->words = gtk_tree_view_new();
 	self->words_height = self->words->allocation.height;
+	self->words_cell_height = 0;
 	gtk_tree_view_set_headers_visible(GTK_TREE_VIEW(self->words), FALSE);
 
 	{ /* specify selection */
@@ -192,14 +220,15 @@ static void gydp_window_init(GydpWindow *self) {
 	}
 
 	{ /* create list and view model */
-		GtkListStore *list = gtk_list_store_new(COLUMNS, G_TYPE_STRING, G_TYPE_INT);
+		GydpListModel *list = gydp_list_model_new(NULL);
 		GtkCellRenderer *renderer = gtk_cell_renderer_text_new();
 
 		GtkTreeViewColumn *column = gtk_tree_view_column_new_with_attributes(
-				"Word", renderer, "text", COLUMN_WORD, NULL);
+				"Word", renderer, "text", GYDP_LIST_MODEL_COLUMN_WORD, NULL);
 		gtk_tree_view_column_set_sizing(column, GTK_TREE_VIEW_COLUMN_FIXED);
 		gtk_tree_view_append_column(GTK_TREE_VIEW(self->words), column);
 		gtk_tree_view_set_model(GTK_TREE_VIEW(self->words), GTK_TREE_MODEL(list));
+		g_object_unref(list);
 	}
 
 	gtk_tree_view_set_fixed_height_mode(GTK_TREE_VIEW(self->words), TRUE);
@@ -328,6 +357,8 @@ static void gydp_window_init(GydpWindow *self) {
 			G_CALLBACK(gydp_window_words_selection_changed), self);
 	g_signal_connect(G_OBJECT(self->words), "size-allocate",
 			G_CALLBACK(gydp_window_words_size_allocate), self);
+	g_signal_connect(G_OBJECT(self->words), "style-set",
+			G_CALLBACK(gydp_window_words_style_set), self);
 	g_signal_connect(G_OBJECT(self->words), "button-press-event",
 			G_CALLBACK(gydp_window_words_event_button_press), self);
 	g_signal_connect(G_OBJECT(self->words), "scroll-event",
@@ -347,12 +378,13 @@ static void gydp_window_init(GydpWindow *self) {
 	}
 
 	/* update current default dictionary (initialize view) */
-	GydpDict *dict = g_object_get_data(G_OBJECT(gydp_app()), GYDP_APP_DICT);
-	const gchar *nick = gydp_engine_value_to_nick(dict->engine);
-	gchar *lang = gydp_conf_get_string(config, nick, "lang");
-	gydp_window_dict_update(self, gydp_lang_name_to_value(lang));
+	gchar *engine = gydp_conf_get_string(config, "general", "engine");
+	const GydpEngine engine_value = gydp_engine_name_to_value(engine);
+	gchar *lang = gydp_conf_get_string(config, gydp_engine_value_to_nick(engine_value), "lang");
+	gydp_window_dict_update(self, engine_value, gydp_lang_name_to_value(lang));
 
-	/* free temporary string */
+	/* free temporary strings */
+	g_free(engine);
 	g_free(lang);
 
 	/* set initial focus on the words */
@@ -380,6 +412,10 @@ static GObject *gydp_window_constructor(GType type, guint n, GObjectConstructPar
 static void gydp_window_finalize(GObject *object) {
 	GydpWindow *window = GYDP_WINDOW(object);
 	g_slist_free(window->menu.dicts);
+	gydp_text_free(window->definition_text);
+	gydp_window_word_search_stop(window);
+	if( window->hits != NULL )
+		g_array_free(window->hits, TRUE);
 
 	/* chain to parent finalize */
 	gydp_window_parent_klass->finalize(object);
@@ -407,15 +443,38 @@ static void gydp_window_hide(GtkWidget *widget, gpointer data G_GNUC_UNUSED) {
 	gydp_conf_set_integer(config, "window", "split", split);
 }
 
+/** gydp_window_dict_toggled
+ * switch to dictionary of selected language, resident one is shown at once
+ * (with its cached definitions), other one is loaded in background
+ */
 static void gydp_window_dict_toggled(GtkCheckMenuItem *item, gpointer data) {
-	GydpDict *dict = g_object_get_data(gydp_app(), GYDP_APP_DICT);
+	GydpRegistry *registry = g_object_get_data(gydp_app(), GYDP_APP_REGISTRY);
 	GydpConf *config = g_object_get_data(gydp_app(), GYDP_APP_CONF);
 	GydpWindow *window = GYDP_WINDOW(data);
+	gboolean resident;
 
 	/* check if menu item is active */
 	if( !gtk_check_menu_item_get_active(item) )
 		return;
 
+	/* get dictionary language */
+	const gchar *label = gtk_label_get_text(
+			GTK_LABEL(gtk_bin_get_child(GTK_BIN(item))));
+	GydpLang lang = gydp_lang_nick_to_value(label);
+
+	/* switch current dictionary (kept loaded by registry) */
+	GydpDict *dict = gydp_registry_get(registry, window->engine, lang, &resident);
+	g_return_if_fail(dict != NULL);
+
+	g_object_set_data_full(gydp_app(), GYDP_APP_DICT,
+			g_object_ref(dict), (GDestroyNotify)g_object_unref);
+	gydp_window_dict_attach(window, dict);
+
+	/* search in previous dictionary is dropped */
+	gydp_window_word_search_stop(window);
+	gydp_window_word_hits_clear(window);
+	window->words_pending = FALSE;
+
 	{ /* clear definition */
 		GtkTextView *view = GTK_TEXT_VIEW(window->definition);
 		GtkTextBuffer *buffer = gtk_text_view_get_buffer(view);
@@ -432,42 +491,71 @@ static void gydp_window_dict_toggled(GtkCheckMenuItem *item, gpointer data) {
 	/* clear word */
 	gtk_editable_delete_text(GTK_EDITABLE(window->word), 0, -1);
 
-	/* get dictionary language */
-	const gchar *label = gtk_label_get_text(
-			GTK_LABEL(gtk_bin_get_child(GTK_BIN(item))));
-	GydpLang lang = gydp_lang_nick_to_value(label);
-
-	/* get data dirs */
-	gchar **paths = gydp_data_dirs(dict->engine);
-
-	/* try to load dictionary */
-	if( !gydp_dict_load(dict, paths, lang) ) {
-		GtkTextView *view = GTK_TEXT_VIEW(window->definition);
-		GtkTextBuffer *buffer = gtk_text_view_get_buffer(view);
-		GtkTextIter it;
+	/* save current language (loaders get settings in gydp_dict_configure) */
+	const gchar *nick = gydp_engine_value_to_nick(window->engine);
+	gydp_conf_set_string(config, nick, "lang", gydp_lang_value_to_name(lang));
 
-		gtk_text_view_set_pixels_above_lines(view, GTK_WIDGET(view)->allocation.height/2);
-		gtk_text_buffer_get_start_iter(buffer, &it);
-		gtk_text_buffer_insert_with_tags_by_name(buffer, &it,
-			"Failed to load dictionary", -1,
-			GYDP_TAG_UNDERLINE, GYDP_TAG_ALIGN_CENTER, NULL);
+	{ /* initialize scrollbar (range grows while loading) */
+		GtkObject *adjustment = gtk_adjustment_new(0, 0, gydp_dict_size(dict), 1, 1, 1);
+		gtk_range_set_adjustment(GTK_RANGE(window->words_scroll), GTK_ADJUSTMENT(adjustment));
 	}
 
-	/* free temporary data */
-	g_strfreev(paths);
+	if( !resident ) {
+		/* get data dirs */
+		gchar **paths = gydp_data_dirs(window->engine);
 
-	{ /* initialize scrollbar */
-		GtkObject *adjustment = gtk_adjustment_new(0, 0, gydp_dict_size(dict), 1, 1, 1);
-		gtk_range_set_adjustment(GTK_RANGE(window->words_scroll), GTK_ADJUSTMENT(adjustment));
+		/* load dictionary in background (other resident ones keep loading) */
+		gydp_dict_load_async(dict, paths, lang, gydp_window_dict_loaded, window);
+
+		/* free temporary data */
+		g_strfreev(paths);
 	}
 
 	/* update current dictionary language view and specify invalid item to select */
 	gydp_window_words_update(window);
 	gydp_window_words_select(window, 0, -1);
+}
 
-	/* save current language */
-	const gchar *nick = gydp_engine_value_to_nick(dict->engine);
-	gydp_conf_set_string(config, nick, "lang", gydp_lang_value_to_name(lang));
+/** gydp_window_dict_changed
+ * dictionary words changed (also emitted for every chunk of loaded words),
+ * update scroll range and visible words and repeat pending search
+ */
+static void gydp_window_dict_changed(GydpListData *list_data, gpointer data) {
+	GydpWindow *window = GYDP_WINDOW(data);
+	GtkAdjustment *adjustment = gtk_range_get_adjustment(GTK_RANGE(window->words_scroll));
+
+	/* update scroll range */
+	g_object_set(G_OBJECT(adjustment),
+			"upper", (gdouble)gydp_list_data_get_items(list_data), NULL);
+
+	/* refresh visible words */
+	gydp_window_words_update(window);
+	gydp_window_words_update_select(window);
+
+	/* search again in newly loaded words */
+	if( window->words_pending )
+		gydp_window_word_changed(GTK_ENTRY(window->word), window);
+}
+
+static void gydp_window_dict_loaded(GydpDict *dict, gboolean result, gpointer data) {
+	GydpRegistry *registry = g_object_get_data(gydp_app(), GYDP_APP_REGISTRY);
+	const gboolean current = dict == g_object_get_data(gydp_app(), GYDP_APP_DICT);
+	GydpWindow *window = GYDP_WINDOW(data);
+
+	/* failed dictionary is loaded again when selected, loaded one counts
+	 * to registry memory limit (dictionary may be released here) */
+	if( !result )
+		gydp_registry_remove(registry, dict);
+	else
+		gydp_registry_trim(registry);
+
+	/* inform about failure */
+	if( !result && current ) {
+		GtkTextView *view = GTK_TEXT_VIEW(window->definition);
+
+		gtk_text_view_set_pixels_above_lines(view, GTK_WIDGET(view)->allocation.height/2);
+		gydp_window_definition_notice(window, "Failed to load dictionary");
+	}
 }
 
 static void gydp_window_word_changed(GtkEntry *entry, gpointer data) {
@@ -475,15 +563,40 @@ static void gydp_window_word_changed(GtkEntry *entry, gpointer data) {
 	const gchar *text = gtk_entry_get_text(entry);
 	GydpWindow *window = GYDP_WINDOW(data);
 
+	/* previous search is superseded */
+	gydp_window_word_search_stop(window);
+	gydp_window_word_hits_clear(window);
+	window->words_pending = FALSE;
+
+	/* search in definitions */
+	if( text[0] == GYDP_WINDOW_TEXT_SEARCH ) {
+		gydp_window_word_search_text(window, dict, text + 1);
+		return;
+	}
+
 	/* check if entry is non empty */
 	if( strlen(text) ) {
-		/* find best compatible item */
-		guint index = gydp_dict_find(dict, text);
-		/* move scroll to specified item */
-		gydp_window_words_select(window, index, 0);
+		/* find best compatible item after pending keystrokes */
+		window->search = g_cancellable_new();
+		gydp_dict_find_async(dict, text, window->search, gydp_window_word_found, window);
 	}
 }
 
+static void gydp_window_word_found(GydpDict *dict, guint n, gpointer data) {
+	GydpWindow *window = GYDP_WINDOW(data);
+
+	/* search completed */
+	g_object_unref(window->search);
+	window->search = NULL;
+
+	/* move scroll to specified item (or closest similar word) */
+	if( !gydp_window_word_search_fuzzy(window, dict, n) )
+		gydp_window_words_select(window, n, 0);
+
+	/* better item may be loaded later */
+	window->words_pending = gydp_dict_loading(dict);
+}
+
 static gboolean gydp_window_word_event_key_press(GtkWidget *widget G_GNUC_UNUSED, GdkEventKey *event, gpointer data) {
 	GydpWindow *window = GYDP_WINDOW(data);
 
@@ -516,6 +629,14 @@ static gboolean gydp_window_word_event_key_press(GtkWidget *widget G_GNUC_UNUSED
 		gydp_window_words_select(window, id < upper - size? id: upper - size, size - 1);
 		gydp_window_word_sync(window);
 		return TRUE;
+	case GDK_Return:
+	case GDK_KP_Enter:
+		/* show next full-text or approximate search result */
+		if( window->hits == NULL || window->hits->len == 0 )
+			break;
+		window->hits_pos = (window->hits_pos + 1) % window->hits->len;
+		gydp_window_words_select(window, g_array_index(window->hits, guint, window->hits_pos), 0);
+		return TRUE;
 	case GDK_Up:
 		if( id < (gint)value || id >= (gint)(value + size) )
 			return TRUE;
@@ -599,13 +720,25 @@ static void gydp_window_words_selection_changed(GtkTreeSelection *selection, gpo
 
 	/* check if any item is actually selected */
 	if( gtk_tree_selection_get_selected(selection, &model, &it) ) {
-		gtk_tree_model_get(model, &it, COLUMN_WORD, &word, COLUMN_ID, &id, -1);
+		gtk_tree_model_get(model, &it, GYDP_LIST_MODEL_COLUMN_WORD, &word, GYDP_LIST_MODEL_COLUMN_ID, &id, -1);
 
 		/* check if selected new item */
 		if( window->words_selected != id ) {
-			/* extract translation text */
-			gydp_dict_text(g_object_get_data(gydp_app(), GYDP_APP_DICT),
-					id, gtk_text_view_get_buffer(GTK_TEXT_VIEW(window->definition)));
+			GydpDict *dict = g_object_get_data(gydp_app(), GYDP_APP_DICT);
+			GydpConf *config = g_object_get_data(G_OBJECT(gydp_app()), GYDP_APP_CONF);
+
+			/* extract translation text and show it */
+			gydp_dict_text(dict, id, window->definition_text);
+			gydp_text_buffer_set(gtk_text_view_get_buffer(GTK_TEXT_VIEW(window->definition)),
+					window->definition_text);
+
+			/* render entries reachable with Up/Down and Page Up/Down while idle */
+			GtkAdjustment *adjustment = gtk_range_get_adjustment(GTK_RANGE(window->words_scroll));
+			const gint count = gydp_conf_get_integer(config, "general", "prefetch");
+			gdouble size;
+
+			g_object_get(G_OBJECT(adjustment), "page-size", &size, NULL);
+			gydp_dict_prefetch(dict, id, MAX(count, 0), MAX(size, 1) - 1);
 
 			/* update internal selected item */
 			window->words_selected = id;
@@ -618,7 +751,7 @@ static void gydp_window_words_selection_changed(GtkTreeSelection *selection, gpo
 
 /** gydp_window_words_size_allocate
  * update words list in GtkTreeView only when there is *actual* size change
- * Size allocate is emited after chenges in the GtkTreeView GtkListStore, we
+ * Size allocate is emited after chenges in the GtkTreeView GydpListModel, we
  * have to discard these signals, but process real widget resize
  */
 static void gydp_window_words_size_allocate(GtkWidget *widget, GtkAllocation *allocation, gpointer data) {
@@ -628,11 +761,23 @@ static void gydp_window_words_size_allocate(GtkWidget *widget, GtkAllocation *al
 	if( window->words_height != widget->allocation.height ||
 			window->words_height != allocation->height ) {
 		window->words_height = allocation->height;
+		window->words_cell_height = 0;
 		gydp_window_words_update(window);
 		gydp_window_words_update_select(window);
 	}
 }
 
+/** gydp_window_words_style_set
+ * font or theme change alters row height, measure it again
+ */
+static void gydp_window_words_style_set(GtkWidget *widget G_GNUC_UNUSED, GtkStyle *previous G_GNUC_UNUSED, gpointer data) {
+	GydpWindow *window = GYDP_WINDOW(data);
+
+	window->words_cell_height = 0;
+	gydp_window_words_update(window);
+	gydp_window_words_update_select(window);
+}
+
 /** gydp_window_words_scroll_value_changed
  * process custom scrolling, refresh current view at GtkTreeView and update
  * selection
@@ -649,24 +794,21 @@ static void gydp_window_action_quit(GtkAction *action G_GNUC_UNUSED, GydpWindow
 
 static void gydp_window_action_toggle_engine(GtkAction *action G_GNUC_UNUSED, GydpWindow *window) {
 	GydpConf *config = g_object_get_data(G_OBJECT(gydp_app()), GYDP_APP_CONF);
-	GydpDict *dict = GYDP_DICT(g_object_get_data(gydp_app(), GYDP_APP_DICT));
 	GydpEngine engine;
 
-	switch( dict->engine ) {
-	case GYDP_ENGINE_SAP: engine = GYDP_ENGINE_YDP; break;
-	case GYDP_ENGINE_YDP: engine = GYDP_ENGINE_SAP; break;
+	/* merged engines follow single ones */
+	switch( window->engine ) {
+	case GYDP_ENGINE_SAP:   engine = GYDP_ENGINE_YDP; break;
+	case GYDP_ENGINE_YDP:   engine = GYDP_ENGINE_MERGE; break;
+	case GYDP_ENGINE_MERGE: engine = GYDP_ENGINE_SAP; break;
 	default: g_return_if_reached();
 	}
 
-	/* toggle engine */
-	g_object_set_data_full(gydp_app(), GYDP_APP_DICT,
-			gydp_engine_new(engine),
-			(GDestroyNotify)g_object_unref);
-
-	/* update language */
+	/* toggle engine and update language (dictionary is taken from registry) */
 	const gchar *nick = gydp_engine_value_to_nick(engine);
-	const gchar *lang = gydp_conf_get_string(config, nick, "lang");
-	gydp_window_dict_update(window, gydp_lang_name_to_value(lang));
+	gchar *lang = gydp_conf_get_string(config, nick, "lang");
+	gydp_window_dict_update(window, engine, gydp_lang_name_to_value(lang));
+	g_free(lang);
 }
 
 /** gydp_window_action_toggle
@@ -708,8 +850,11 @@ static void gydp_window_action_about(GtkAction *action G_GNUC_UNUSED, GydpWindow
 	gtk_widget_destroy(dialog);
 }
 
-static void gydp_window_dict_update(GydpWindow *self, GydpLang lang) {
-	GydpDict *dict = GYDP_DICT(g_object_get_data(gydp_app(), GYDP_APP_DICT));
+static void gydp_window_dict_update(GydpWindow *self, GydpEngine engine, GydpLang lang) {
+	GydpRegistry *registry = g_object_get_data(gydp_app(), GYDP_APP_REGISTRY);
+
+	/* languages of engine are listed */
+	self->engine = engine;
 
 	/* remove current dictionary entries */
 	gtk_container_foreach(GTK_CONTAINER(self->menu.dict),
@@ -728,7 +873,7 @@ static void gydp_window_dict_update(GydpWindow *self, GydpLang lang) {
 		GtkWidget *child;
 
 		/* add language if supported */
-		if( gydp_dict_lang(dict, enum_value->value) ) {
+		if( gydp_registry_lang(registry, engine, enum_value->value) ) {
 			/* create radion menu item and update group */
 			child = gtk_radio_menu_item_new_with_label(group, enum_value->value_nick);
 			group = gtk_radio_menu_item_get_group(GTK_RADIO_MENU_ITEM(child));
@@ -773,6 +918,31 @@ static void gydp_window_dict_update(GydpWindow *self, GydpLang lang) {
 		gtk_check_menu_item_set_active(GTK_CHECK_MENU_ITEM(toggle), TRUE);
 }
 
+/** gydp_window_dict_attach
+ * show words of dictionary and follow its changes instead of previous one
+ * (previous one stays loaded in registry, its idle work is stopped)
+ */
+static void gydp_window_dict_attach(GydpWindow *self, GydpDict *dict) {
+	GydpListModel *model = GYDP_LIST_MODEL(gtk_tree_view_get_model(GTK_TREE_VIEW(self->words)));
+	GydpListData *previous = gydp_list_model_get_data(model);
+
+	if( previous == GYDP_LIST_DATA(dict) )
+		return;
+
+	if( previous != NULL ) {
+		g_signal_handlers_disconnect_by_func(G_OBJECT(previous),
+				G_CALLBACK(gydp_window_dict_changed), self);
+		gydp_dict_prefetch_stop(GYDP_DICT(previous));
+	}
+
+	/* show words of current dictionary */
+	gydp_list_model_set_data(model, GYDP_LIST_DATA(dict));
+
+	/* follow dictionary changes (disconnected with window) */
+	g_signal_connect_object(G_OBJECT(dict), "changed",
+			G_CALLBACK(gydp_window_dict_changed), self, 0);
+}
+
 static void gydp_window_words_select(GydpWindow *self, gint value, gint offset) {
 	GtkTreeSelection *selection = gtk_tree_view_get_selection(GTK_TREE_VIEW(self->words));
 	GtkTreeModel *model = gtk_tree_view_get_model(GTK_TREE_VIEW(self->words));
@@ -818,13 +988,17 @@ static void gydp_window_word_sync(GydpWindow *self) {
 	guint length, offset;
 	gchar *word;
 
+	/* user selected item, stop repeating search */
+	gydp_window_word_search_stop(self);
+	self->words_pending = FALSE;
+
 	if( gtk_tree_selection_get_selected(selection, &model, &it) ) {
 		/* extract current position in edit */
 		entry = gtk_entry_get_text(GTK_ENTRY(self->word));
 		offset = gtk_editable_get_position(GTK_EDITABLE(self->word));
 		length = g_utf8_strlen(entry, -1);
 
-		gtk_tree_model_get(model, &it, COLUMN_WORD, &word, -1);
+		gtk_tree_model_get(model, &it, GYDP_LIST_MODEL_COLUMN_WORD, &word, -1);
 
 		/* block signals */
 		g_signal_handlers_block_by_func(G_OBJECT(self->word),
@@ -841,12 +1015,98 @@ static void gydp_window_word_sync(GydpWindow *self) {
 	}
 }
 
+/** gydp_window_word_search_text
+ * search definitions (index is built with first search), best result is
+ * selected and next ones are shown with Enter
+ */
+static void gydp_window_word_search_text(GydpWindow *self, GydpDict *dict, const gchar *query) {
+	gydp_window_word_hits_clear(self);
+
+	/* search again when dictionary is loaded or indexed */
+	if( (self->hits = gydp_dict_search(dict, query, GYDP_WINDOW_TEXT_HITS)) == NULL ) {
+		self->words_pending = TRUE;
+
+		/* clear selection, so that found entry is shown even if it was selected */
+		if( gydp_dict_indexing(dict) ) {
+			gydp_window_words_select(self, -1, -1);
+			gydp_window_definition_notice(self, "Indexing definitions...");
+		}
+		return;
+	}
+
+	if( self->hits->len )
+		gydp_window_words_select(self, g_array_index(self->hits, guint, 0), 0);
+}
+
+/** gydp_window_word_search_fuzzy
+ * entry text is probably misspelled when found word does not start with
+ * it, closest words are offered instead (next ones are shown with Enter),
+ * only dictionaries with search keys offer them (search runs in main loop)
+ */
+static gboolean gydp_window_word_search_fuzzy(GydpWindow *self, GydpDict *dict, guint n) {
+	const gchar *word = gydp_dict_word(dict, n);
+	gboolean result = FALSE;
+
+	/* all words would be compared on every change of entry */
+	if( word == NULL || !gydp_dict_fuzzy_quick(dict) )
+		return FALSE;
+
+	gchar *text = gydp_str_process(gtk_entry_get_text(GTK_ENTRY(self->word)));
+	gchar *key = gydp_str_process(word);
+
+	if( !g_str_has_prefix(key, text) ) {
+		GArray *hits = gydp_dict_fuzzy(dict, text, GYDP_DICT_FUZZY_DISTANCE, GYDP_WINDOW_FUZZY_HITS);
+
+		if( hits != NULL && hits->len ) {
+			gydp_window_word_hits_clear(self);
+			self->hits = hits;
+			gydp_window_words_select(self, g_array_index(hits, guint, 0), 0);
+			result = TRUE;
+		} else if( hits != NULL )
+			g_array_free(hits, TRUE);
+	}
+
+	g_free(key);
+	g_free(text);
+
+	return result;
+}
+
+/** gydp_window_definition_notice
+ * replace definition with centered notice (dictionary state)
+ */
+static void gydp_window_definition_notice(GydpWindow *self, const gchar *notice) {
+	GtkTextBuffer *buffer = gtk_text_view_get_buffer(GTK_TEXT_VIEW(self->definition));
+	GtkTextIter start, end;
+
+	gtk_text_buffer_get_start_iter(buffer, &start);
+	gtk_text_buffer_get_end_iter(buffer, &end);
+	gtk_text_buffer_delete(buffer, &start, &end);
+
+	gtk_text_buffer_get_start_iter(buffer, &start);
+	gtk_text_buffer_insert_with_tags_by_name(buffer, &start, notice, -1,
+		GYDP_TAG_UNDERLINE, GYDP_TAG_ALIGN_CENTER, NULL);
+}
+
+static void gydp_window_word_hits_clear(GydpWindow *self) {
+	if( self->hits != NULL )
+		g_array_free(self->hits, TRUE);
+	self->hits = NULL;
+	self->hits_pos = 0;
+}
+
+static void gydp_window_word_search_stop(GydpWindow *self) {
+	if( self->search != NULL ) {
+		g_cancellable_cancel(self->search);
+		g_object_unref(self->search);
+		self->search = NULL;
+	}
+}
+
 static void gydp_window_words_update(GydpWindow *self) {
-	GydpDict *dict = GYDP_DICT(g_object_get_data(gydp_app(), GYDP_APP_DICT));
-	GtkTreeModel *store = gtk_tree_view_get_model(GTK_TREE_VIEW(self->words));
-	GtkTreeIter it;
+	const gdouble begin = gydp_stats_begin();
+	GydpListModel *model = GYDP_LIST_MODEL(gtk_tree_view_get_model(GTK_TREE_VIEW(self->words)));
 	gdouble position;
-	gint cell_height, separator;
 
 	/* get scroll for word list */
 	GtkAdjustment *adjustment = gtk_range_get_adjustment(GTK_RANGE(self->words_scroll));
@@ -854,32 +1114,21 @@ static void gydp_window_words_update(GydpWindow *self) {
 	/* top items on word list */
 	g_object_get(G_OBJECT(adjustment), "value", &position, NULL);
 
-	/* get single cell size */
-	GtkTreeViewColumn *column = gtk_tree_view_get_column(GTK_TREE_VIEW(self->words), 0);
-	gtk_tree_view_column_cell_get_size(column, NULL, NULL, NULL, NULL, &cell_height);
-	gtk_widget_style_get(self->words, "vertical-separator", &separator, NULL);
-	cell_height += separator;
-
-	/* clear store */
-	gtk_list_store_clear(GTK_LIST_STORE(store));
-
-	/* NOTICE:
-	 * setting store explicitely sends selection-changed signal */
-
-	const gint size = self->words->allocation.height / cell_height;
-	for(gint i = 0; i < size; ++i) {
-		gint id = i + (gint)position;
-		const char *word = gydp_dict_word(dict, id);
-
-		/* add only available words */
-		if( word != NULL ) {
-			gtk_list_store_append(GTK_LIST_STORE(store), &it);
-			gtk_list_store_set(GTK_LIST_STORE(store), &it,
-					COLUMN_WORD, word,
-					COLUMN_ID, id, -1);
-		}
+	/* get single cell size (measured again after resize or style change) */
+	if( self->words_cell_height <= 0 ) {
+		GtkTreeViewColumn *column = gtk_tree_view_get_column(GTK_TREE_VIEW(self->words), 0);
+		gint cell_height, separator;
+
+		gtk_tree_view_column_cell_get_size(column, NULL, NULL, NULL, NULL, &cell_height);
+		gtk_widget_style_get(self->words, "vertical-separator", &separator, NULL);
+		self->words_cell_height = MAX(cell_height + separator, 1);
 	}
 
+	/* expose visible words only, rows still visible are kept with selection
+	 * (rows are read from dictionary when drawn) */
+	const gint size = self->words->allocation.height / self->words_cell_height;
+	gydp_list_model_set_range(model, (guint)position, (guint)size);
+
 	/* adjust scroll (very important rounding) */
 	g_object_set(G_OBJECT(adjustment),
 			"page-size", (gdouble)(gint)size,
@@ -887,6 +1136,8 @@ static void gydp_window_words_update(GydpWindow *self) {
 
 	/* set small as possible (permit full user resize) */
 	gtk_widget_set_size_request(self->words, -1, 0);
+
+	gydp_stats_end(GYDP_STATS_WORDS_UPDATE, begin);
 }
 
 /** gydp_window_words_update_select
@@ -0,0 +1,308 @@
+/*
+ * Copyright (C) 2008 Michał Kurgan <michal.kurgan@moloh.net>
+ *
+ * This file is part of gydpdict.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gydpdict.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "gydp_words.h"
+#include <string.h>
+
+/* longest prefix shared with previous string (stored in one byte) */
+#define GYDP_WORDS_PREFIX_MAX 255
+
+typedef struct GydpWordsSlot {
+	guint block;                     /* decoded block (G_MAXUINT if none) */
+	GString *text;                   /* decoded strings (terminated) */
+	gsize start[GYDP_WORDS_BLOCK];   /* string offsets in text */
+} GydpWordsSlot;
+
+struct _GydpWords {
+	const gchar *data;       /* front coded blocks */
+	gsize length;            /* size of data */
+	const guint32 *block;    /* offset of every block in data */
+	guint size;              /* number of strings */
+	gboolean mapped;         /* data is owned by index cache */
+
+	/* appended data (data and block point here) */
+	GString *build;
+	GArray *blocks;
+	GString *last;           /* previously appended string */
+
+	/* decoded blocks (slot is selected by block number) */
+	GydpWordsSlot slot[GYDP_WORDS_SLOTS];
+};
+
+/* private functions */
+static GydpWords     *gydp_words_alloc (gboolean mapped);
+static GydpWordsSlot *gydp_words_decode(GydpWords *self, guint block);
+static guint          gydp_words_search(GydpWords *self, const gchar *word, gssize length);
+static gboolean       gydp_words_before(const gchar *str, const gchar *word, gssize length);
+
+GydpWords *gydp_words_new() {
+	GydpWords *self = gydp_words_alloc(FALSE);
+
+	self->build = g_string_new(NULL);
+	self->blocks = g_array_new(FALSE, FALSE, sizeof(guint32));
+	self->last = g_string_new(NULL);
+
+	return self;
+}
+
+void gydp_words_free(GydpWords *self) {
+	if( self != NULL ) {
+		if( !self->mapped ) {
+			g_string_free(self->build, TRUE);
+			g_array_free(self->blocks, TRUE);
+			g_string_free(self->last, TRUE);
+		}
+
+		for(guint i = 0; i < GYDP_WORDS_SLOTS; ++i)
+			g_string_free(self->slot[i].text, TRUE);
+
+		g_slice_free(GydpWords, self);
+	}
+}
+
+/** gydp_words_append
+ * first string of block is stored whole (block heads are compared
+ * directly by lookups), next ones as length of prefix shared with
+ * previous string followed by remaining suffix
+ */
+void gydp_words_append(GydpWords *self, const gchar *str) {
+	const gsize length = strlen(str);
+	const guint block = self->size / GYDP_WORDS_BLOCK;
+
+	g_return_if_fail(!self->mapped);
+
+	if( self->size % GYDP_WORDS_BLOCK == 0 ) {
+		const guint32 offset = self->build->len;
+		g_array_append_val(self->blocks, offset);
+		g_string_append_len(self->build, str, length + 1);
+	} else {
+		gsize prefix = 0;
+
+		/* shared prefix */
+		while( prefix < GYDP_WORDS_PREFIX_MAX && str[prefix] && str[prefix] == self->last->str[prefix] )
+			++prefix;
+
+		g_string_append_c(self->build, (gchar)prefix);
+		g_string_append_len(self->build, str + prefix, length - prefix + 1);
+	}
+	g_string_assign(self->last, str);
+	++self->size;
+
+	/* data may be moved, decoded block may be incomplete */
+	self->data = self->build->str;
+	self->length = self->build->len;
+	self->block = (const guint32 *)self->blocks->data;
+	if( self->slot[block % GYDP_WORDS_SLOTS].block == block )
+		self->slot[block % GYDP_WORDS_SLOTS].block = G_MAXUINT;
+}
+
+const gchar *gydp_words_get(GydpWords *self, guint n) {
+	g_return_val_if_fail(n < self->size, NULL);
+
+	GydpWordsSlot *slot = gydp_words_decode(self, n / GYDP_WORDS_BLOCK);
+	return slot->text->str + slot->start[n % GYDP_WORDS_BLOCK];
+}
+
+/** gydp_words_copy
+ * decode strings of block up to n-th one into buffer, decoded blocks are
+ * not touched (broken data gives shorter string like in decode)
+ */
+const gchar *gydp_words_copy(GydpWords *self, guint n, GString *buffer) {
+	g_return_val_if_fail(n < self->size, NULL);
+
+	const guint block = n / GYDP_WORDS_BLOCK;
+	const gchar *pos = self->data + self->block[block];
+	const gchar *end = (block + 1) * GYDP_WORDS_BLOCK < self->size?
+		self->data + self->block[block + 1]: self->data + self->length;
+
+	g_string_truncate(buffer, 0);
+	for(guint i = 0; i <= n % GYDP_WORDS_BLOCK; ++i) {
+		gsize prefix = 0;
+
+		/* length of prefix shared with previous string */
+		if( i > 0 && pos < end ) {
+			prefix = MIN((guchar)*pos, buffer->len);
+			++pos;
+		}
+
+		const gchar *stop = memchr(pos, '\0', end - pos);
+		if( stop == NULL )
+			stop = end;
+
+		g_string_truncate(buffer, prefix);
+		g_string_append_len(buffer, pos, stop - pos);
+		pos = stop < end? stop + 1: end;
+	}
+
+	return buffer->str;
+}
+
+guint gydp_words_size(GydpWords *self) {
+	return self->size;
+}
+
+gsize gydp_words_memory(GydpWords *self) {
+	const guint blocks = (self->size + GYDP_WORDS_BLOCK - 1) / GYDP_WORDS_BLOCK;
+	return self->length + blocks * sizeof(guint32);
+}
+
+guint gydp_words_lower(GydpWords *self, const gchar *word) {
+	return gydp_words_search(self, word, -1);
+}
+
+guint gydp_words_upper(GydpWords *self, const gchar *word, gsize length) {
+	return gydp_words_search(self, word, length);
+}
+
+void gydp_words_store(GydpWords *self, GydpCache *cache, GydpCacheSection data, GydpCacheSection blocks) {
+	const guint count = (self->size + GYDP_WORDS_BLOCK - 1) / GYDP_WORDS_BLOCK;
+
+	gydp_cache_set(cache, data, self->data, self->length);
+	gydp_cache_set(cache, blocks, self->block, count * sizeof(guint32));
+}
+
+/** gydp_words_restore
+ * use front coded data directly from loaded index cache, block offsets
+ * are validated and decoding never reads past data
+ */
+GydpWords *gydp_words_restore(GydpCache *cache, GydpCacheSection data, GydpCacheSection blocks, guint size) {
+	const guint count = (size + GYDP_WORDS_BLOCK - 1) / GYDP_WORDS_BLOCK;
+	gsize length, block_size;
+	const gchar *str = gydp_cache_get(cache, data, &length);
+	const guint32 *block = gydp_cache_get(cache, blocks, &block_size);
+
+	/* validate sections (block heads are terminated by last byte at worst) */
+	if( block_size != count * sizeof(guint32) ||
+			(size > 0 && (length == 0 || str[length - 1] != '\0' || block[0] != 0)) )
+		return NULL;
+
+	for(guint i = 1; i < count; ++i)
+		if( block[i] <= block[i - 1] || block[i] >= length )
+			return NULL;
+
+	/* data is used in place */
+	GydpWords *self = gydp_words_alloc(TRUE);
+	self->data = str;
+	self->length = length;
+	self->block = block;
+	self->size = size;
+
+	return self;
+}
+
+static GydpWords *gydp_words_alloc(gboolean mapped) {
+	GydpWords *self = g_slice_new0(GydpWords);
+
+	self->mapped = mapped;
+	for(guint i = 0; i < GYDP_WORDS_SLOTS; ++i) {
+		self->slot[i].block = G_MAXUINT;
+		self->slot[i].text = g_string_new(NULL);
+	}
+
+	return self;
+}
+
+/** gydp_words_decode
+ * decode all strings of block into its slot, broken data gives
+ * shorter strings instead of reads past block
+ */
+static GydpWordsSlot *gydp_words_decode(GydpWords *self, guint block) {
+	GydpWordsSlot *slot = &self->slot[block % GYDP_WORDS_SLOTS];
+	const guint first = block * GYDP_WORDS_BLOCK;
+	const guint count = MIN(GYDP_WORDS_BLOCK, self->size - first);
+
+	/* block already decoded */
+	if( slot->block == block )
+		return slot;
+
+	const gchar *pos = self->data + self->block[block];
+	const gchar *end = first + count < self->size?
+		self->data + self->block[block + 1]: self->data + self->length;
+	gsize prev = 0, prev_length = 0;
+
+	g_string_truncate(slot->text, 0);
+	for(guint i = 0; i < count; ++i) {
+		const gsize start = slot->text->len;
+		gsize prefix = 0;
+
+		/* length of prefix shared with previous string */
+		if( i > 0 && pos < end ) {
+			prefix = MIN((guchar)*pos, prev_length);
+			++pos;
+		}
+
+		const gchar *stop = memchr(pos, '\0', end - pos);
+		if( stop == NULL )
+			stop = end;
+
+		/* previous string and suffix do not overlap new string */
+		g_string_set_size(slot->text, start + prefix + (stop - pos) + 1);
+		memcpy(slot->text->str + start, slot->text->str + prev, prefix);
+		memcpy(slot->text->str + start + prefix, pos, stop - pos);
+		slot->text->str[slot->text->len - 1] = '\0';
+
+		slot->start[i] = start;
+		prev = start;
+		prev_length = prefix + (stop - pos);
+		pos = stop < end? stop + 1: end;
+	}
+	slot->block = block;
+
+	return slot;
+}
+
+/** gydp_words_search
+ * first string not before word (see gydp_words_before), block heads
+ * select block, only one block is decoded
+ */
+static guint gydp_words_search(GydpWords *self, const gchar *word, gssize length) {
+	guint lower = 0, upper = (self->size + GYDP_WORDS_BLOCK - 1) / GYDP_WORDS_BLOCK;
+
+	/* first block with head not before word */
+	while( lower < upper ) {
+		const guint middle = lower + (upper - lower) / 2;
+		if( gydp_words_before(self->data + self->block[middle], word, length) )
+			lower = middle + 1;
+		else
+			upper = middle;
+	}
+
+	/* result is head of this block or in previous block */
+	if( lower == 0 )
+		return 0;
+
+	const guint first = (lower - 1) * GYDP_WORDS_BLOCK;
+	const guint count = MIN(GYDP_WORDS_BLOCK, self->size - first);
+	GydpWordsSlot *slot = gydp_words_decode(self, lower - 1);
+
+	for(guint i = 1; i < count; ++i)
+		if( !gydp_words_before(slot->text->str + slot->start[i], word, length) )
+			return first + i;
+
+	return first + count;
+}
+
+/** gydp_words_before
+ * string is less than word, with length only first length bytes of
+ * string are compared (strings starting with word are before it too)
+ */
+static gboolean gydp_words_before(const gchar *str, const gchar *word, gssize length) {
+	if( length < 0 )
+		return strcmp(str, word) < 0;
+	return strncmp(str, word, length) <= 0;
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2008 Michał Kurgan <michal.kurgan@moloh.net>
+ *
+ * This file is part of gydpdict.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gydpdict.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef __GYDP_WORDS_H__
+#define __GYDP_WORDS_H__
+
+#include "gydp_global.h"
+#include "gydp_cache.h"
+
+G_BEGIN_DECLS
+
+/* strings in one front coded block (first one is stored whole) */
+#define GYDP_WORDS_BLOCK 16
+
+/* decoded blocks kept at once */
+#define GYDP_WORDS_SLOTS 8
+
+/* lists are not thread safe, lookups and gydp_words_get decode blocks
+ * into slots shared by all callers */
+typedef struct _GydpWords GydpWords;
+
+GydpWords   *gydp_words_new   ();
+void         gydp_words_free  (GydpWords *self);
+
+/* strings are appended in list order (sorted order for lookups) */
+void         gydp_words_append(GydpWords *self, const gchar *str);
+
+/* string is valid until GYDP_WORDS_SLOTS other blocks are decoded, copy
+ * decodes string into buffer of caller (slots are not used) */
+const gchar *gydp_words_get   (GydpWords *self, guint n);
+const gchar *gydp_words_copy  (GydpWords *self, guint n, GString *buffer);
+guint        gydp_words_size  (GydpWords *self);
+gsize        gydp_words_memory(GydpWords *self);
+
+/* sorted lists only: first string not less than word and first string
+ * past strings whose first length bytes are not greater than word */
+guint        gydp_words_lower (GydpWords *self, const gchar *word);
+guint        gydp_words_upper (GydpWords *self, const gchar *word, gsize length);
+
+/* front coded data in index cache (restored list points into cache) */
+void         gydp_words_store  (GydpWords *self, GydpCache *cache,
+                                GydpCacheSection data, GydpCacheSection blocks);
+GydpWords   *gydp_words_restore(GydpCache *cache, GydpCacheSection data,
+                                GydpCacheSection blocks, guint size);
+
+G_END_DECLS
+
+#endif /* __GYDP_WORDS_H__ */
@@ -23,20 +23,76 @@
 #include "gydp_conf.h"
 #include "gydp_dict.h"
 #include "gydp_app.h"
+#include "gydp_lookup.h"
+#include "gydp_serve.h"
+#include "gydp_registry.h"
 #include <stdlib.h>
 
+/* command line options */
+static gboolean gydp_option_lookup = FALSE;
+static gboolean gydp_option_serve = FALSE;
+static gchar *gydp_option_listen = NULL;
+static gchar *gydp_option_engine = NULL;
+static gchar *gydp_option_lang = NULL;
+
+static GOptionEntry gydp_options[] = {
+	{ "lookup", 0, 0, G_OPTION_ARG_NONE, &gydp_option_lookup,
+		"Print definitions of words (or lines of standard input) and exit", NULL },
+	{ "serve", 0, 0, G_OPTION_ARG_NONE, &gydp_option_serve,
+		"Answer DICT protocol (RFC 2229) clients until interrupted", NULL },
+	{ "listen", 0, 0, G_OPTION_ARG_STRING, &gydp_option_listen,
+		"Unix socket path or loopback port used by server (2628)", "ADDRESS" },
+	{ "engine", 'e', 0, G_OPTION_ARG_STRING, &gydp_option_engine,
+		"Dictionary engine used by lookup or server (sap, ydp, merge)", "ENGINE" },
+	{ "lang", 'l', 0, G_OPTION_ARG_STRING, &gydp_option_lang,
+		"Dictionary language used by lookup (\"English to Polish\", \"Polish to English\")", "LANG" },
+	{ NULL, 0, 0, 0, NULL, NULL, NULL }
+};
+
 int main(int argc, char *argv[]) {
-	GObject *app = gydp_app_new(&argc, &argv);
+	GOptionContext *context = g_option_context_new("[WORD...]");
+	GError *error = NULL;
+
+	/* parse own options, remaining ones are left for GTK */
+	g_option_context_add_main_entries(context, gydp_options, NULL);
+	g_option_context_set_ignore_unknown_options(context, TRUE);
+
+	if( !g_option_context_parse(context, &argc, &argv, &error) ) {
+		g_printerr("%s\n", error->message);
+		g_error_free(error);
+		g_option_context_free(context);
+		return EXIT_FAILURE;
+	}
+	g_option_context_free(context);
+
+	/* lookup and server modes do not initialize GUI */
+	GObject *app = gydp_option_lookup || gydp_option_serve?
+		gydp_app_new(NULL, NULL): gydp_app_new(&argc, &argv);
 
 	/* add configuration to app object */
 	g_object_set_data_full(app, GYDP_APP_CONF,
 			gydp_conf_new(),
 			(GDestroyNotify)gydp_conf_free);
 
-	/* add dictionary to app object */
-	g_object_set_data_full(app, GYDP_APP_DICT,
-			gydp_engine_new(GYDP_ENGINE_DEFAULT),
-			(GDestroyNotify)g_object_unref);
+	/* print definitions of remaining arguments */
+	if( gydp_option_lookup ) {
+		const gboolean result = gydp_lookup_run(gydp_option_engine, gydp_option_lang, argv + 1);
+		g_object_unref(app);
+		return result? EXIT_SUCCESS: EXIT_FAILURE;
+	}
+
+	/* answer clients with every language loaded */
+	if( gydp_option_serve ) {
+		const gboolean result = gydp_serve_run(gydp_option_engine, gydp_option_listen);
+		g_object_unref(app);
+		return result? EXIT_SUCCESS: EXIT_FAILURE;
+	}
+
+	/* add loaded dictionaries to app object (window selects current one) */
+	const gint resident = gydp_conf_get_integer(g_object_get_data(app, GYDP_APP_CONF), "general", "resident");
+	g_object_set_data_full(app, GYDP_APP_REGISTRY,
+			gydp_registry_new(MAX(resident, 0) * (gsize)1024),
+			(GDestroyNotify)gydp_registry_free);
 
 	/* create main widget */
 	gydp_app_set_widget(app, gydp_window_new());